@@ -0,0 +1,48 @@
+/*
+Programmer: Connor Fricke (cd.fricke23@gmail.com)
+File: Bounds.h
+Latest Revision: 18-Oct-2026
+Synopsis: Build-mode policy for index and dimension checks in the Matrix and Vector classes
+*/
+
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+    #include <cassert>
+    #include <stdexcept>
+
+    /*
+    BOUNDS_POLICY selects what a failed index or dimension check does (CMake: -DCPPLIB_BOUNDS_POLICY=...):
+        BOUNDS_UNCHECKED    no check at all, at()/set() compile to a plain load/store
+        BOUNDS_ASSERT       assert(): aborts with the message in debug builds, nothing under NDEBUG (default)
+        BOUNDS_THROW        throws std::out_of_range (indices) or std::invalid_argument (dimensions)
+    Define it the same way in every translation unit of a program.
+    BOUNDS_CHECK(condition, message) guards element access, DIMENSION_CHECK(condition, message) guards
+    operand shapes; message must be a string literal. With checks off, violating them is undefined.
+    operator() and operator[] are always unchecked.
+    */
+    #define BOUNDS_UNCHECKED 0
+    #define BOUNDS_ASSERT 1
+    #define BOUNDS_THROW 2
+
+    #ifndef BOUNDS_POLICY
+        #define BOUNDS_POLICY BOUNDS_ASSERT
+    #endif
+
+    #if BOUNDS_POLICY == BOUNDS_THROW
+        #define BOUNDS_CHECK(condition, message) \
+            do { if (!(condition)) throw std::out_of_range(message); } while (0)
+        #define DIMENSION_CHECK(condition, message) \
+            do { if (!(condition)) throw std::invalid_argument(message); } while (0)
+    #elif BOUNDS_POLICY == BOUNDS_ASSERT && !defined(NDEBUG)
+        #define BOUNDS_CHECK(condition, message) assert((condition) && message)
+        #define DIMENSION_CHECK(condition, message) assert((condition) && message)
+    #elif BOUNDS_POLICY == BOUNDS_ASSERT || BOUNDS_POLICY == BOUNDS_UNCHECKED
+        // unevaluated operand: no code is generated, but variables used only in checks still count as used
+        #define BOUNDS_CHECK(condition, message) ((void)sizeof((condition) ? 1 : 0))
+        #define DIMENSION_CHECK(condition, message) ((void)sizeof((condition) ? 1 : 0))
+    #else
+        #error "BOUNDS_POLICY must be BOUNDS_UNCHECKED, BOUNDS_ASSERT or BOUNDS_THROW"
+    #endif
+
+#endif
@@ -1,7 +1,7 @@
 /*
 Programmer: Connor Fricke (cd.fricke23@gmail.com)
 File: DSP.h
-Latest Revision: 19-Feb-2024
+Latest Revision: 18-Oct-2026
 Synopsis: Header and implementation file for DSP functions
 */
 
@@ -12,6 +12,25 @@ Synopsis: Header and implementation file for DSP functions
     #include <complex>
     #include <vector>
     #include <cmath>
+    #include <numeric>
+    #include <algorithm>
+    #include <memory>
+    #include <new>
+    #include <cstdint>
+    #include <type_traits>
+    #include "Instrument.h"
+    #include "Matrix.h"
+    #include "Random.h"
+    #include "ThreadPool.h"
+    #include <iostream>
+
+    // float32 kernels have AVX2/FMA versions selected at run time on x86 GCC/Clang builds
+    #if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+        #define DSP_X86_DISPATCH 1
+        #include <immintrin.h>
+    #else
+        #define DSP_X86_DISPATCH 0
+    #endif
 
     // DECLARATIONS
     namespace dsp {
@@ -25,10 +44,88 @@ Synopsis: Header and implementation file for DSP functions
 
         typedef std::complex<double> dcomp;
 
+        /*
+        q15:
+            16-bit signed fixed-point sample with 15 fractional bits, covering [-1, 1 - 2^-15]. This is the
+            native format of 16-bit ADCs. Conversion from double rounds and saturates; the Q15 kernels
+            accumulate in 32/64-bit integers and saturate on the way back to 16 bits.
+        */
+        struct q15
+        {
+            int16_t value = 0;
+
+            q15() {}
+            explicit q15(const double x);
+            static q15 raw(const int64_t bits);     // saturating construction from raw Q15 bits
+            double toDouble() const;
+        };
+
+        // complex Q15 sample, the output format of the fixed-point FFT
+        struct cq15
+        {
+            q15 re, im;
+        };
+
+        /*
+        SampleTraits<T>:
+            Types used by the sample-type-generic kernels for a sample type T.
+                coeff_type: filter coefficient type (float taps for float data, Q15 taps for Q15 data)
+                real_type: real arithmetic type (double for Q15, whose intermediate results are reported in full-scale units)
+                complex_type: result type of Goertzel/DFT style kernels
+            Specialized for double, float, q15, std::complex<double> and std::complex<float>.
+        */
+        template <typename T>
+        struct SampleTraits;
+
+        template <>
+        struct SampleTraits<double>
+        {
+            typedef double coeff_type; typedef double real_type; typedef dcomp complex_type;
+            static double fromDouble(const double x) { return x; }
+            static coeff_type coeffFromDouble(const double x) { return x; }
+        };
+
+        template <>
+        struct SampleTraits<float>
+        {
+            typedef float coeff_type; typedef float real_type; typedef std::complex<float> complex_type;
+            static float fromDouble(const double x) { return float(x); }
+            static coeff_type coeffFromDouble(const double x) { return float(x); }
+        };
+
+        template <>
+        struct SampleTraits<q15>
+        {
+            typedef q15 coeff_type; typedef double real_type; typedef dcomp complex_type;
+            static q15 fromDouble(const double x) { return q15(x); }
+            static coeff_type coeffFromDouble(const double x) { return q15(x); }
+        };
+
+        template <typename R>
+        struct SampleTraits<std::complex<R>>
+        {
+            typedef R coeff_type; typedef R real_type; typedef std::complex<R> complex_type;
+            static std::complex<R> fromDouble(const double x) { return std::complex<R>(R(x), R(0)); }
+            static coeff_type coeffFromDouble(const double x) { return R(x); }
+        };
+
+        /*
+        CPUFeatures / cpuFeatures():
+            Instruction set extensions detected once at run time, used to dispatch the float32 and Q15 kernels.
+        */
+        struct CPUFeatures
+        {
+            bool avx2 = false;
+            bool fma = false;
+        };
+        const CPUFeatures &cpuFeatures();
+
         /*
         getRandomFloat(const double, const double):
-            Simply returns a single random number generated with the Mersenne Twister (mt19937)
-            over a uniform distribution between the upper and lower bounds parameters.
+            Returns a single random number drawn uniformly between the lower and upper bound parameters,
+            from the calling thread's rng::threadEngine() (xoshiro256++). Cheap enough to call per sample
+            and safe to call from many threads. After rng::seedThreadEngines() every thread's sequence is
+            reproducible (streams are keyed to the thread, see rng::threadEngine()).
             @@ parameters:
                 const double lower: lower bound to uniform distribution
                 const double upper: upper bound to uniform distribution
@@ -61,10 +158,11 @@ Synopsis: Header and implementation file for DSP functions
         std::vector<double> generateTiming(const double SAMPLING_RATE, const int N);
 
         /*
-        vector<double> decimateSignal(const vector<double> signal, const int DECIMATION_FACTOR)
-            takes every n-th element of the input vector and adds it to the returned vector of resulting floor(len(signal)/n)
+        vector<double> decimateSignal(const vector<double>& signal, const int DECIMATION_FACTOR)
+            takes every n-th element of the input vector and adds it to the returned vector of resulting ceil(len(signal)/n).
+            No anti-aliasing filter is applied; use PolyphaseResampler or MultistageDecimator for band-limited decimation.
         */
-        std::vector<double> decimateSignal(const std::vector<double> signal, const int DECIMATION_FACTOR);
+        std::vector<double> decimateSignal(const std::vector<double> &signal, const int DECIMATION_FACTOR);
 
         /*
         double aliasesTo(const double SIGNAL_FREQ, const double SAMPLING_RATE)
@@ -84,31 +182,37 @@ Synopsis: Header and implementation file for DSP functions
         std::vector<dcomp> DFT(const std::vector<double> &x, const std::vector<int> &k_range);
 
         /*
-        lowpassFIR(const vector<double>&, vector<double>&, const double):
+        lowpassFIR(const vector<T>&, const double):
             Takes in an input vector and output vector as parameters. Applies an FIR Filter
             to the input vector characterized by the difference equation:
                 y[n] = a*x[n] + (1-a)*x[n-1]
+            T may be double, float, q15 or a std::complex type; float uses an AVX2/FMA kernel when available.
             @@ parameters:
-                const vector<double>& input: represents an unfiltered signal
+                const vector<T>& input: represents an unfiltered signal
                 const double alpha: defines both taps (coefficients) of the FIR filter via {a, 1-a}.
             @@ return:
-                vector<double> output: resulting filtered signal
+                vector<T> output: resulting filtered signal
         */
-        std::vector<double> lowpassFIR(const std::vector<double> &input, const double alpha);
+        template <typename T>
+        std::vector<T> lowpassFIR(const std::vector<T> &input, const double alpha);
+        std::vector<double> lowpassFIR(const std::vector<double> &input, const double alpha);     // also takes {...} lists
 
         /*
-        movingAvgIIR(const vector<double>&, vector<double>&, const double) :
+        movingAvgIIR(const vector<T>&, const double) :
             Takes in an input vector and output vector as parameters. Applies an IIR Filter
             to the input vector characterized by the difference equation:
                 y[n] = a*x[n] + (1-a)*y[n-1]
             This filter corresponds to a lowpass filter with two taps defined by the third parameter value.
-            It is well known as an exponential averaging filter.
+            It is well known as an exponential averaging filter. T may be double, float, q15 or a std::complex type.
+            The float AVX2/FMA kernel resolves the recursion 8 samples at a time with a log-step scan.
             @@ parameters:
-                const vector<double>& input: represents an unfiltered signal
+                const vector<T>& input: represents an unfiltered signal
                 const double alpha: defines both taps (coefficients) of the IIR filter via {a, 1-a}
             @@ return:
-                vector<double>& output: resulting filtered signal
+                vector<T>& output: resulting filtered signal
         */
+        template <typename T>
+        std::vector<T> movingAvgIIR(const std::vector<T>& input, const double alpha);
         std::vector<double> movingAvgIIR(const std::vector<double>& input, const double alpha);
 
         /* 
@@ -119,13 +223,442 @@ Synopsis: Header and implementation file for DSP functions
             The result of this IIR filter is passed to the FIR portion in this function, and the result
             (a complex number whose magnitude is the discrete DFT value for the particular k) is returned.
             This implementation is most similar to a hardware (FPGA) implementation of the Goertzel filter.
+            T may be double, float, q15 or a std::complex type. The Q15 version runs the resonator in 64-bit
+            integers with a Q14 coefficient and returns the result in full-scale units. The resonator is a serial
+            recursion, so float evaluates the same bin as the equivalent correlation sum_n x[n] exp(-2 PI i k n / N)
+            with exactly reduced phases and a double accumulator, in 8 AVX2/FMA lanes where available and in a
+            scalar loop otherwise, so every CPU runs the same formulation.
             @@ parameters:
-                const vector<double>& input: input signal to be passed through the filter
+                const vector<T>& input: input signal to be passed through the filter
                 const int k: used in the difference equation
             @@ return:
-                complex<double> out: result of Goertzel filtering on input signal
+                SampleTraits<T>::complex_type out: result of Goertzel filtering on input signal
         */
+        template <typename T>
+        typename SampleTraits<T>::complex_type goertzelIIR(const std::vector<T> &input, const int k);
         dcomp goertzelIIR(const std::vector<double> &input, const int k);
+
+        /*
+        dotProduct(const C*, const T*, const size_t):
+            Inner product of a coefficient array and a sample array, the inner loop of every FIR kernel.
+            Uses several independent accumulators so the loop is not serialized on a single add and can be
+            vectorized. float uses an AVX2/FMA kernel when the CPU has one; Q15 accumulates exact Q30
+            products in 64 bits (AVX2 pmaddwd when available) and rounds and saturates the result.
+        */
+        double dotProduct(const double *a, const double *b, const size_t n);
+        float dotProduct(const float *a, const float *b, const size_t n);
+        q15 dotProduct(const q15 *a, const q15 *b, const size_t n);
+        template <typename R>
+        std::complex<R> dotProduct(const R *a, const std::complex<R> *b, const size_t n);
+
+        /*
+        besselI0(const double x):
+            Zeroth-order modified Bessel function of the first kind, evaluated from its power series.
+            Needed for the Kaiser window.
+        */
+        double besselI0(const double x);
+
+        /*
+        designLowpass(const int numTaps, const double cutoff, const double beta):
+            Designs a linear-phase lowpass FIR filter by the windowed-sinc method using a Kaiser window.
+            @@ parameters:
+                const int numTaps: number of filter coefficients
+                const double cutoff: cutoff frequency as a fraction of the sampling rate, 0 < cutoff <= 0.5
+                const double beta: Kaiser window shape, larger values give more stopband attenuation and a wider transition band
+            @@ return:
+                vector<double> taps: filter coefficients normalized to unity gain at DC
+        */
+        std::vector<double> designLowpass(const int numTaps, const double cutoff, const double beta = 8.0);
+
+        /*
+        PolyphaseResampler:
+            Rational L/M sample rate converter. Conceptually the input is upsampled by L (zero-stuffing), lowpass
+            filtered, and downsampled by M. The filter is split into L polyphase branches so that only the kept
+            output samples are ever computed, costing K = numTaps/L multiply-adds per output sample.
+            Filter history is carried between calls to process(), so a long signal can be fed in blocks of
+            any size and the concatenated output equals resampling the whole signal at once.
+            @@ constructor parameters:
+                const int L: interpolation factor
+                const int M: decimation factor (L and M are reduced by their gcd)
+                const int halfLength: zero crossings of the sinc kept on each side of the prototype filter
+                const double beta: Kaiser window shape of the prototype filter
+            The alternate constructor accepts a user designed prototype filter (designed at L times the input rate).
+            BasicPolyphaseResampler<T> works on any sample type T, storing its taps as SampleTraits<T>::coeff_type;
+            PolyphaseResampler is the double precision instance.
+        */
+        template <typename T>
+        class BasicPolyphaseResampler
+        {
+            typedef typename SampleTraits<T>::coeff_type coeff_type;
+
+            int L, M;                           // reduced interpolation and decimation factors
+            int K;                              // taps per polyphase branch
+            std::vector<coeff_type> branches;   // L branches of K taps each, stored time-reversed
+            std::vector<T> history;             // the last K-1 input samples
+            std::vector<T> edge;                // history followed by the first K-1 samples of the current block
+            long long t;                        // next output position on the upsampled time axis, relative to the current block
+            size_t numTaps;                     // length of the prototype filter
+
+            void build(const std::vector<double> &taps);
+
+        public:
+            BasicPolyphaseResampler(const int L, const int M, const int halfLength = 16, const double beta = 8.0);
+            BasicPolyphaseResampler(const int L, const int M, const std::vector<double> &taps);
+
+            // appends the outputs produced by n new input samples to output, returns the number appended
+            size_t process(const T *input, const size_t n, std::vector<T> &output);
+            std::vector<T> process(const std::vector<T> &input);
+            // clears the filter history
+            void reset();
+
+            int up() const;
+            int down() const;
+            // group delay of the prototype filter, in output samples
+            double delay() const;
+        };
+
+        typedef BasicPolyphaseResampler<double> PolyphaseResampler;
+
+        /*
+        MultistageDecimator:
+            Decimates by a large integer factor as a cascade of PolyphaseResampler stages with small factors
+            (each at most 8 unless the factor has a larger prime divisor). Each stage only needs a filter
+            sized for its own factor and later stages run at already reduced rates, so the total work is far
+            smaller than a single stage filter designed for the full factor. State is kept between calls.
+        */
+        class MultistageDecimator
+        {
+            std::vector<PolyphaseResampler> stages;
+            std::vector<int> stageFactors;
+            std::vector<double> scratchA, scratchB;
+
+        public:
+            MultistageDecimator(const int factor, const int halfLength = 16, const double beta = 8.0);
+
+            size_t process(const double *input, const size_t n, std::vector<double> &output);
+            std::vector<double> process(const std::vector<double> &input);
+            void reset();
+
+            const std::vector<int> &factors() const;
+        };
+
+        /*
+        resample(const vector<T>&, const int L, const int M):
+            One-shot convenience wrapper around BasicPolyphaseResampler<T>. Returns ceil(len(signal)*L/M) samples,
+            delayed by the filter group delay (see PolyphaseResampler::delay()).
+        */
+        template <typename T>
+        std::vector<T> resample(const std::vector<T> &signal, const int L, const int M);
+
+        /*
+        firFilter(const vector<T>&, const vector<double>&):
+            General FIR filter y[n] = sum_k h[k] x[n-k] with zero initial state, for any sample type T.
+            The taps are converted to SampleTraits<T>::coeff_type once and the inner loop is dotProduct().
+        */
+        template <typename T>
+        std::vector<T> firFilter(const std::vector<T> &input, const std::vector<double> &taps);
+
+        /*
+        FFTPlan:
+            Precomputed fast Fourier transform of a fixed length N. Powers of two use an iterative radix-2
+            transform over a precomputed twiddle table; any other length is handled with Bluestein's chirp-z
+            algorithm on top of a padded power-of-two plan, so every length runs in O(N log N).
+            A plan is immutable after construction and may be shared between threads; each thread passes its
+            own scratch vector (only used by non power-of-two lengths, and resized as needed).
+            forward() computes X[k] = sum_n x[n] exp(-2 PI i k n / N) in place, inverse() its inverse including the 1/N factor.
+            BasicFFTPlan<R> transforms std::complex<R> data (R = float or double, twiddles are computed in double);
+            FFTPlan is the double precision instance. Float plans run the radix-2 stages of length 8 and up with an
+            AVX2/FMA kernel (4 butterflies per instruction) when the CPU has one.
+        */
+        template <typename R>
+        class BasicFFTPlan
+        {
+            typedef std::complex<R> complex_type;
+
+            size_t N;
+            bool radix2;
+            std::vector<complex_type> twiddles;             // exp(-2 PI i k / N) for k < N/2
+            std::vector<size_t> reversal;                   // bit-reversal permutation
+            std::vector<complex_type> stageTwiddles;        // float AVX2 path: each stage's twiddles stored contiguously
+            std::vector<complex_type> chirp;                // Bluestein: exp(-PI i n^2 / N)
+            std::vector<complex_type> kernel;               // Bluestein: transformed conjugate chirp
+            std::shared_ptr<const BasicFFTPlan<R>> padded;  // Bluestein: power-of-two plan for the convolution
+
+            void butterflies(complex_type *data, const bool inverse) const;
+            void bluestein(complex_type *data, std::vector<complex_type> &scratch) const;
+
+        public:
+            BasicFFTPlan(const size_t N = 1);
+            size_t size() const;
+            void forward(complex_type *data, std::vector<complex_type> &scratch) const;
+            void inverse(complex_type *data, std::vector<complex_type> &scratch) const;
+        };
+
+        typedef BasicFFTPlan<double> FFTPlan;
+
+        /*
+        FFT(const vector<R>&) / FFT(const vector<complex<R>>&) / IFFT(const vector<complex<R>>&):
+            Convenience wrappers building a one-off plan (R = float or double). Same result as DFT() over
+            k = 0..N-1 in O(N log N).
+        FFT(const vector<q15>&):
+            Fixed-point radix-2 FFT (N must be a power of two). Every butterfly stage is scaled by 1/2 so the
+            result never overflows: the returned values are X[k]/N in Q15.
+        */
+        template <typename R>
+        typename std::enable_if<std::is_floating_point<R>::value, std::vector<std::complex<R>>>::type
+        FFT(const std::vector<R> &x);
+        template <typename R>
+        std::vector<std::complex<R>> FFT(const std::vector<std::complex<R>> &x);
+        template <typename R>
+        std::vector<std::complex<R>> IFFT(const std::vector<std::complex<R>> &X);
+        std::vector<cq15> FFT(const std::vector<q15> &x);
+
+        enum WindowType { RECTANGULAR, HANN, HAMMING, BLACKMAN, KAISER };
+
+        /*
+        makeWindow(const WindowType, const size_t, const double, const bool):
+            Returns the requested window function of the given length.
+            @@ parameters:
+                const WindowType type: RECTANGULAR, HANN, HAMMING, BLACKMAN or KAISER
+                const size_t length: number of window samples
+                const double beta: Kaiser shape parameter (ignored by the other windows)
+                const bool periodic: periodic windows (the default) are the right choice for spectral analysis and
+                    overlap-add, symmetric windows (false) for FIR filter design
+        */
+        std::vector<double> makeWindow(const WindowType type, const size_t length, const double beta = 8.6, const bool periodic = true);
+
+        /*
+        STFTConfig:
+            Parameters of a short-time Fourier transform.
+                window, beta: analysis/synthesis window (beta only used by KAISER)
+                windowLength: samples per frame
+                hop: samples between the starts of consecutive frames
+                fftSize: transform length, 0 selects windowLength; larger values zero-pad every frame
+                center: pad windowLength/2 zeros on both ends of the signal so that frame f is centered on sample f*hop
+        */
+        struct STFTConfig
+        {
+            WindowType window = HANN;
+            size_t windowLength = 1024;
+            size_t hop = 256;
+            size_t fftSize = 0;
+            double beta = 8.6;
+            bool center = true;
+        };
+
+        /*
+        STFT:
+            Short-time Fourier transform engine. Frames are distributed over a ThreadPool, each worker using its
+            own FFT scratch, and written straight into a preallocated frames x bins Matrix (one contiguous row
+            per frame, bins = fftSize/2 + 1 for the one-sided spectrum of a real signal). Two real frames are
+            packed into each complex FFT, halving the transform work.
+            inverse() resynthesizes a signal by weighted overlap-add, normalizing by the summed squared window,
+            so inverse(forward(x), len(x)) reproduces x to rounding error whenever hop <= windowLength/2
+            (any hop for which the squared windows overlap everywhere).
+        */
+        class STFT
+        {
+            STFTConfig config;
+            std::vector<double> window;
+            FFTPlan plan;
+            ThreadPool *pool;
+
+            size_t padding() const;
+            void loadFrames(const double *x, const size_t n, const size_t f, const size_t count, dcomp *buf) const;
+            template <typename Writer>
+            void analyze(const double *x, const size_t n, Writer &&write) const;
+
+        public:
+            STFT(const STFTConfig &config, ThreadPool &pool = ThreadPool::global());
+
+            // number of frames produced for a signal of n samples
+            size_t frames(const size_t n) const;
+            // number of frequency bins per frame; bin k is at k * SAMPLING_RATE / fftSize Hz
+            size_t bins() const;
+            const STFTConfig &settings() const;
+
+            void forward(const double *x, const size_t n, Matrix<dcomp> &out) const;
+            Matrix<dcomp> forward(const std::vector<double> &x) const;
+            // power spectrogram |X|^2
+            void spectrogram(const double *x, const size_t n, Matrix<double> &out) const;
+            Matrix<double> spectrogram(const std::vector<double> &x) const;
+            // overlap-add resynthesis of n samples from a one-sided frames x bins STFT
+            std::vector<double> inverse(const Matrix<dcomp> &S, const size_t n) const;
+        };
+
+        enum Averaging { MEAN_AVERAGE, MEDIAN_AVERAGE, EXPONENTIAL_AVERAGE };
+
+        /*
+        WelchConfig:
+            Parameters of a Welch power spectral density estimate.
+                window, beta: segment window (beta only used by KAISER)
+                segmentLength, overlap: samples per segment and samples shared by consecutive segments
+                fftSize: transform length, 0 selects segmentLength; larger values zero-pad every segment
+                averaging: MEAN_AVERAGE, MEDIAN_AVERAGE (robust to bursts) or EXPONENTIAL_AVERAGE (newest segment
+                    weighted by `smoothing`, older ones decay by 1 - smoothing)
+                medianSegments: median averaging runs over the most recent medianSegments periodograms (a sliding
+                    window, medianSegments x fftSize doubles of memory however long the stream); shorter streams
+                    get the exact median over all segments
+                onesided: fold negative frequencies onto positive ones (fftSize/2+1 bins) or return all fftSize bins in FFT order
+                samplingRate: sampling rate in Hz, sets the density units (signal units^2 / Hz) and the frequency axis
+                batchSegments: segments buffered before a batch is transformed in parallel
+        */
+        struct WelchConfig
+        {
+            WindowType window = HANN;
+            size_t segmentLength = 1024;
+            size_t overlap = 512;
+            size_t fftSize = 0;
+            double beta = 8.6;
+            Averaging averaging = MEAN_AVERAGE;
+            double smoothing = 0.1;
+            bool onesided = true;
+            double samplingRate = 1.0;
+            size_t batchSegments = 64;
+            size_t medianSegments = 1024;
+        };
+
+        /*
+        WelchEstimator:
+            Streaming Welch/averaged periodogram estimator. Samples are pushed in blocks of any size; only the
+            tail of the stream that the next segments still need is buffered, so inputs far larger than memory
+            can be processed. Batches of complete segments are windowed and transformed in parallel and then
+            folded into the running average in segment order, so the estimate does not depend on the thread count.
+            merge() combines an estimator fed with a later portion (or another shard) of the data: sums for mean
+            averaging, the pooled median window (keeping the newest medianSegments), and decayed weights for exponential
+            averaging (the argument's segments are treated as newer). Merging is exact and deterministic for a fixed merge order.
+            Segments never straddle the boundary between two merged estimators.
+        */
+        class WelchEstimator
+        {
+            WelchConfig config;
+            std::vector<double> window;
+            double windowPower;                 // sum of squared window samples
+            FFTPlan plan;
+            ThreadPool *pool;
+            std::vector<double> pending;        // samples from the start of the next unprocessed segment onwards
+            std::vector<double> batch;          // periodograms of the current batch, batchSegments x fftSize
+            std::vector<std::vector<dcomp>> buffers, scratch;   // per-worker transform and FFT scratch space
+            std::vector<double> accumulated;    // mean: sum, exponential: decayed sum
+            std::vector<double> history;        // median: ring of the newest periodograms, medianSegments x fftSize
+            size_t historyStart, historyCount;  // median: slot of the oldest periodogram, periodograms held
+            double weight;                      // exponential: decayed sum of weights
+            size_t count;
+
+            size_t step() const;
+            void transform(const size_t numSegments);
+            void fold(const double *P);
+            void remember(const double *P);
+
+        public:
+            WelchEstimator(const WelchConfig &config, ThreadPool &pool = ThreadPool::global());
+
+            void push(const double *x, const size_t n);
+            void push(const std::vector<double> &x);
+            void merge(const WelchEstimator &other);
+            void reset();
+
+            // power spectral density of the complete segments pushed so far: their mean, their exponentially
+            // weighted average, or the median over the newest medianSegments of them
+            std::vector<double> psd() const;
+            // frequency of each psd() bin in Hz (negative frequencies in the upper half of two-sided output)
+            std::vector<double> frequencies() const;
+            size_t segments() const;
+            const WelchConfig &settings() const;
+        };
+
+        /*
+        welch(const vector<double>&, const WelchConfig&):
+            One-shot Welch estimate of the power spectral density of a whole signal.
+        */
+        std::vector<double> welch(const std::vector<double> &x, const WelchConfig &config = WelchConfig());
+
+        enum ChannelLayout { PLANAR, INTERLEAVED };
+
+        /*
+        ChannelView<T>:
+            Non-owning strided view of the samples of one channel of a MultiChannelBuffer. Sample i lives at
+            ptr[i * stride]; planar channels have stride 1, interleaved channels have stride equal to the channel count.
+        */
+        template <typename T>
+        struct ChannelView
+        {
+            T *ptr;
+            size_t length;
+            size_t stride;
+
+            T &operator[](const size_t i) const { return ptr[i * stride]; }
+            size_t size() const { return length; }
+            bool contiguous() const { return stride == 1; }
+        };
+
+        /*
+        MultiChannelBuffer:
+            Owning buffer of `channels` signals of `samples` samples each, in one of two layouts:
+                PLANAR (structure of arrays): each channel is contiguous, and every channel starts on a 64 byte
+                    boundary (the channel pitch is padded to a multiple of 8 doubles)
+                INTERLEAVED (array of structures): the samples of all channels at one instant are contiguous,
+                    which is the usual format of multichannel ADC and audio streams
+            channel() returns zero-copy views. The DSP kernels below accept either layout: planar buffers are
+            processed one channel per task across the global ThreadPool, interleaved buffers are processed
+            time-outer/channel-inner so the per-channel filter states update as one vectorizable loop across
+            channels, with channel ranges split across threads.
+        */
+        class MultiChannelBuffer
+        {
+            double *data;
+            size_t C, N;
+            size_t pitch;           // distance between channels (planar) or between instants (interleaved)
+            ChannelLayout order;
+
+            static double *allocate(const size_t count);
+            static void deallocate(double *del);
+            size_t storage() const;
+
+        public:
+        // CONSTRUCTORS
+            MultiChannelBuffer();
+            MultiChannelBuffer(const size_t channels, const size_t samples, const ChannelLayout layout = PLANAR);
+            MultiChannelBuffer(const MultiChannelBuffer &B);
+            MultiChannelBuffer(MultiChannelBuffer &&B);
+            ~MultiChannelBuffer();
+        // ACCESSORS
+            size_t channels() const;
+            size_t samples() const;
+            ChannelLayout layout() const;
+            size_t stride() const;                  // pitch between channels (planar) or instants (interleaved)
+            double *rawData();
+            const double *rawData() const;
+            ChannelView<double> channel(const size_t c);
+            ChannelView<const double> channel(const size_t c) const;
+            double &operator()(const size_t c, const size_t i);        // unchecked
+            const double &operator()(const size_t c, const size_t i) const;
+            std::vector<double> getChannel(const size_t c) const;
+        // MUTATORS
+            void setChannel(const size_t c, const std::vector<double> &samples);
+            MultiChannelBuffer toLayout(const ChannelLayout layout) const;
+        // OPERATORS
+            MultiChannelBuffer &operator=(const MultiChannelBuffer &B);
+            MultiChannelBuffer &operator=(MultiChannelBuffer &&B);
+        };
+
+        /*
+        Multichannel overloads of the DSP kernels. Each channel is processed exactly as the single channel
+        version would process it; outputs keep the layout of the input buffer.
+            lowpassFIR, movingAvgIIR: per-channel filtering
+            goertzelIIR: one Goertzel result per channel
+            decimateSignal: keeps every DECIMATION_FACTOR-th sample of every channel
+            resample: polyphase L/M resampling of every channel
+            DFT: channels x len(k_range) matrix of DFT values
+            welch: channels x bins matrix of power spectral densities
+        */
+        MultiChannelBuffer lowpassFIR(const MultiChannelBuffer &input, const double alpha);
+        MultiChannelBuffer movingAvgIIR(const MultiChannelBuffer &input, const double alpha);
+        std::vector<dcomp> goertzelIIR(const MultiChannelBuffer &input, const int k);
+        MultiChannelBuffer decimateSignal(const MultiChannelBuffer &signal, const int DECIMATION_FACTOR);
+        MultiChannelBuffer resample(const MultiChannelBuffer &signal, const int L, const int M);
+        Matrix<dcomp> DFT(const MultiChannelBuffer &x, const std::vector<int> &k_range);
+        Matrix<double> welch(const MultiChannelBuffer &x, const WelchConfig &config = WelchConfig());
     }
 
     // DEFINITIONS
@@ -135,11 +668,7 @@ Synopsis: Header and implementation file for DSP functions
 
         double getRandomFloat(const double lower, const double upper)
         {
-            std::random_device rd;
-            std::mt19937 generator(rd());
-            std::uniform_real_distribution<double> distribution(lower, upper);
-
-            return distribution(generator);
+            return lower + (upper - lower) * rng::threadEngine().uniform();
         }
 
         std::vector<double> generateSignal(const std::vector<double> &t_values, const std::vector<SignalComponent> &components)
@@ -184,10 +713,11 @@ Synopsis: Header and implementation file for DSP functions
             return sampleTimes;
         }
 
-        std::vector<double> decimateSignal(const std::vector<double> signal, const int DECIMATION_FACTOR)
+        std::vector<double> decimateSignal(const std::vector<double> &signal, const int DECIMATION_FACTOR)
         {
             std::vector<double> decimated;
-            for (int i = 0; i < signal.size(); i += DECIMATION_FACTOR)
+            decimated.reserve(signal.size() / DECIMATION_FACTOR + 1);
+            for (size_t i = 0; i < signal.size(); i += DECIMATION_FACTOR)
             {
                 decimated.push_back(signal[i]);
             }
@@ -207,6 +737,8 @@ Synopsis: Header and implementation file for DSP functions
 
         std::vector<dcomp> DFT(const std::vector<double> &x, const std::vector<int> &k_range)
         {
+            INSTRUMENT_SCOPE("dsp::DFT");
+            INSTRUMENT_WORK("dsp::DFT", x.size() * sizeof(double), 8 * x.size() * k_range.size());
             std::vector<dcomp> output;
             dcomp I = -1;
             I = sqrt(I);
@@ -226,61 +758,1930 @@ Synopsis: Header and implementation file for DSP functions
             return output;
         }
 
-        std::vector<double> lowpassFIR(const std::vector<double> &input, const double alpha)
+        // SAMPLE TYPES
+        inline q15::q15(const double x)
         {
-            std::vector<double> output;
-            double delay0 = 0;
-            for (double in : input)
+            *this = raw((long long)std::llround(x * 32768.0));
+        }
+
+        inline q15 q15::raw(const int64_t bits)
+        {
+            q15 q;
+            q.value = int16_t(bits > 32767 ? 32767 : (bits < -32768 ? -32768 : bits));
+            return q;
+        }
+
+        inline double q15::toDouble() const
+        {
+            return double(value) / 32768.0;
+        }
+
+        inline const CPUFeatures &cpuFeatures()
+        {
+            static const CPUFeatures features = []() {
+                CPUFeatures f;
+            #if DSP_X86_DISPATCH
+                __builtin_cpu_init();
+                f.avx2 = __builtin_cpu_supports("avx2");
+                f.fma = __builtin_cpu_supports("fma");
+            #endif
+                return f;
+            }();
+            return features;
+        }
+
+    #if DSP_X86_DISPATCH
+        // float32 filter kernels, 8 samples per step; the scalar loops in the templates are the reference
+
+        // y[i] = a*x[i] + b*x[i-1] for i >= 1, y[0] is left to the caller
+        __attribute__((target("avx2,fma"))) inline size_t lowpassFIRAVX2(const float *x, float *y, const size_t n, const float a, const float b)
+        {
+            const __m256 va = _mm256_set1_ps(a), vb = _mm256_set1_ps(b);
+            size_t i = 1;
+            for (; i + 8 <= n; i += 8)
+            {
+                _mm256_storeu_ps(y + i, _mm256_fmadd_ps(va, _mm256_loadu_ps(x + i), _mm256_mul_ps(vb, _mm256_loadu_ps(x + i - 1))));
+            }
+            return i;
+        }
+
+        // y[i] = a*x[i] + b*y[i-1] as a log-step scan inside each block of 8: after the three shifted
+        // updates lane j holds sum_{m<=j} b^(j-m) a x[m], and the previous output enters as b^(j+1) y[-1]
+        __attribute__((target("avx2,fma"))) inline size_t movingAvgIIRAVX2(const float *x, float *y, const size_t n, const float a, const float b, float &previous)
+        {
+            const __m256 va = _mm256_set1_ps(a), zero = _mm256_setzero_ps();
+            const __m256 b1 = _mm256_set1_ps(b), b2 = _mm256_set1_ps(b * b), b4 = _mm256_set1_ps(b * b * b * b);
+            alignas(32) float powers[8];
+            float p = b;
+            for (size_t k = 0; k < 8; k++)
+            {
+                powers[k] = p;
+                p *= b;
+            }
+            const __m256 carry = _mm256_load_ps(powers);
+            const __m256i shift1 = _mm256_setr_epi32(0, 0, 1, 2, 3, 4, 5, 6);
+            const __m256i shift2 = _mm256_setr_epi32(0, 0, 0, 1, 2, 3, 4, 5);
+            const __m256i shift4 = _mm256_setr_epi32(0, 0, 0, 0, 0, 1, 2, 3);
+            const __m256i last = _mm256_set1_epi32(7);
+            __m256 state = _mm256_set1_ps(previous);
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                __m256 z = _mm256_mul_ps(va, _mm256_loadu_ps(x + i));
+                z = _mm256_fmadd_ps(b1, _mm256_blend_ps(_mm256_permutevar8x32_ps(z, shift1), zero, 0x01), z);
+                z = _mm256_fmadd_ps(b2, _mm256_blend_ps(_mm256_permutevar8x32_ps(z, shift2), zero, 0x03), z);
+                z = _mm256_fmadd_ps(b4, _mm256_blend_ps(_mm256_permutevar8x32_ps(z, shift4), zero, 0x0F), z);
+                const __m256 out = _mm256_fmadd_ps(carry, state, z);
+                _mm256_storeu_ps(y + i, out);
+                state = _mm256_permutevar8x32_ps(out, last);
+            }
+            previous = _mm256_cvtss_f32(state);
+            return i;
+        }
+
+        // Goertzel bin k of x[0, n) as the equivalent correlation sum_n x[n] (cos, sin)(2 PI k n / N):
+        // 8 lanes carry consecutive phasors that are rotated by 8 samples per step and re-seeded exactly
+        // (phase reduced in integers) every 512 samples, accumulated in double per re-seed interval
+        __attribute__((target("avx2,fma"))) inline void goertzelAVX2(const float *x, const size_t n, const int k, const size_t N, double &re, double &im, size_t &done)
+        {
+            const size_t INTERVAL = 512;
+            const long long kk = ((long long)k % (long long)N + (long long)N) % (long long)N;
+            const double rotation = 2.0 * PI * double((8 * kk) % (long long)N) / double(N);
+            const __m256 rc = _mm256_set1_ps(float(cos(rotation))), rs = _mm256_set1_ps(float(sin(rotation)));
+            alignas(32) float c0[8], s0[8], partial[8];
+            size_t i = 0;
+            re = 0.0;
+            im = 0.0;
+            while (i + 8 <= n)
+            {
+                for (size_t j = 0; j < 8; j++)
+                {
+                    const double phase = 2.0 * PI * double((kk * (long long)(i + j)) % (long long)N) / double(N);
+                    c0[j] = float(cos(phase));
+                    s0[j] = float(sin(phase));
+                }
+                __m256 c = _mm256_load_ps(c0), s = _mm256_load_ps(s0);
+                __m256 accRe = _mm256_setzero_ps(), accIm = _mm256_setzero_ps();
+                const size_t end = std::min(n, i + INTERVAL);
+                for (; i + 8 <= end; i += 8)
+                {
+                    const __m256 v = _mm256_loadu_ps(x + i);
+                    accRe = _mm256_fmadd_ps(v, c, accRe);
+                    accIm = _mm256_fmadd_ps(v, s, accIm);
+                    const __m256 cNext = _mm256_fmsub_ps(c, rc, _mm256_mul_ps(s, rs));
+                    s = _mm256_fmadd_ps(s, rc, _mm256_mul_ps(c, rs));
+                    c = cNext;
+                }
+                _mm256_store_ps(partial, accRe);
+                for (size_t j = 0; j < 8; j++)
+                    re += partial[j];
+                _mm256_store_ps(partial, accIm);
+                for (size_t j = 0; j < 8; j++)
+                    im += partial[j];
+            }
+            done = i;
+        }
+    #endif
+
+        template <typename T>
+        std::vector<T> lowpassFIR(const std::vector<T> &input, const double alpha)
+        {
+            std::vector<T> output;
+            output.reserve(input.size());
+            if constexpr (std::is_same<T, q15>::value)
             {
-                double out = (alpha * in) + ((1.0 - alpha) * delay0);
-                output.push_back(out);
-                delay0 = in;
+                // taps in Q15 (kept in 32 bits so alpha = 1 is exact), Q30 products rounded back to Q15
+                const int64_t a = std::llround(alpha * 32768.0);
+                const int64_t b = 32768 - a;
+                int64_t delay0 = 0;
+                for (const q15 &in : input)
+                {
+                    int64_t acc = (a * in.value) + (b * delay0);
+                    output.push_back(q15::raw((acc + (1 << 14)) >> 15));
+                    delay0 = in.value;
+                }
+            }
+            else
+            {
+                typedef typename SampleTraits<T>::real_type real_type;
+                const real_type a = real_type(alpha), b = real_type(1.0 - alpha);
+            #if DSP_X86_DISPATCH
+                if constexpr (std::is_same<T, float>::value)
+                {
+                    if (cpuFeatures().avx2 && cpuFeatures().fma && !input.empty())
+                    {
+                        const size_t n = input.size();
+                        output.resize(n);
+                        output[0] = a * input[0];
+                        size_t i = lowpassFIRAVX2(input.data(), output.data(), n, a, b);
+                        for (; i < n; i++)
+                            output[i] = (a * input[i]) + (b * input[i - 1]);
+                        return output;
+                    }
+                }
+            #endif
+                T delay0 = T();
+                for (const T &in : input)
+                {
+                    T out = (a * in) + (b * delay0);
+                    output.push_back(out);
+                    delay0 = in;
+                }
             }
             return output;
         }
 
-        std::vector<double> movingAvgIIR(const std::vector<double> &input, const double alpha)
+        inline std::vector<double> lowpassFIR(const std::vector<double> &input, const double alpha)
         {
-            std::vector<double> output;
-            double delay0 = 0;
-            for (double in : input)
+            return lowpassFIR<double>(input, alpha);
+        }
+
+        template <typename T>
+        std::vector<T> movingAvgIIR(const std::vector<T> &input, const double alpha)
+        {
+            std::vector<T> output;
+            output.reserve(input.size());
+            if constexpr (std::is_same<T, q15>::value)
+            {
+                const int64_t a = std::llround(alpha * 32768.0);
+                const int64_t b = 32768 - a;
+                int64_t delay0 = 0;
+                for (const q15 &in : input)
+                {
+                    // y[n] = a*x[n] + (1-a)*y[n-1], saturated so the feedback can never wrap
+                    q15 out = q15::raw(((a * in.value) + (b * delay0) + (1 << 14)) >> 15);
+                    delay0 = out.value;
+                    output.push_back(out);
+                }
+            }
+            else
             {
-                // DIFFERENCE EQUATION:
-                // y[n] = a*x[n] + (1-a)*y[n-1]
-                double out = (alpha * in) + ((1.0 - alpha) * delay0);
-                delay0 = out;
-                output.push_back(out);
+                typedef typename SampleTraits<T>::real_type real_type;
+                const real_type a = real_type(alpha), b = real_type(1.0 - alpha);
+            #if DSP_X86_DISPATCH
+                if constexpr (std::is_same<T, float>::value)
+                {
+                    if (cpuFeatures().avx2 && cpuFeatures().fma)
+                    {
+                        const size_t n = input.size();
+                        output.resize(n);
+                        float previous = 0.0f;
+                        size_t i = movingAvgIIRAVX2(input.data(), output.data(), n, a, b, previous);
+                        for (; i < n; i++)
+                        {
+                            output[i] = (a * input[i]) + (b * previous);
+                            previous = output[i];
+                        }
+                        return output;
+                    }
+                }
+            #endif
+                T delay0 = T();
+                for (const T &in : input)
+                {
+                    // DIFFERENCE EQUATION:
+                    // y[n] = a*x[n] + (1-a)*y[n-1]
+                    T out = (a * in) + (b * delay0);
+                    delay0 = out;
+                    output.push_back(out);
+                }
             }
             return output;
         }
 
-        dcomp goertzelIIR(const std::vector<double> &x, const int k)
+        inline std::vector<double> movingAvgIIR(const std::vector<double> &input, const double alpha)
+        {
+            return movingAvgIIR<double>(input, alpha);
+        }
+
+        template <typename T>
+        typename SampleTraits<T>::complex_type goertzelIIR(const std::vector<T> &x, const int k)
+        {
+            typedef typename SampleTraits<T>::complex_type complex_type;
+            const int N = x.size();
+
+            if constexpr (std::is_same<T, float>::value)
+            {
+                // y[N] = sum_n x[n] exp(-2 PI i k n / N), evaluated as a correlation (vectorized when possible)
+                double re = 0.0, im = 0.0;
+                size_t done = 0;
+            #if DSP_X86_DISPATCH
+                if (cpuFeatures().avx2 && cpuFeatures().fma && N >= 8)
+                    goertzelAVX2(x.data(), size_t(N), k, size_t(N), re, im, done);
+            #endif
+                const long long kk = (N > 0) ? ((long long)k % N + N) % N : 0;
+                for (size_t n = done; n < size_t(N); n++)
+                {
+                    const double phase = 2.0 * PI * double((kk * (long long)n) % N) / double(N);
+                    re += double(x[n]) * cos(phase);
+                    im += double(x[n]) * sin(phase);
+                }
+                return complex_type(float(re), float(-im));
+            }
+            else if constexpr (std::is_same<T, q15>::value)
+            {
+                // 2cos() in Q14, resonator state in Q15 units held in 64 bits (it grows like N * amplitude)
+                const double COS = cos(2 * PI * double(k) / double(N));
+                const double SIN = sin(2 * PI * double(k) / double(N));
+                const int64_t coeff = std::llround(2.0 * COS * 16384.0);
+                int64_t drs1 = 0, drs2 = 0;
+                for (int n = 0; n < N; n++)
+                {
+                    int64_t drs0 = x[n].value + ((coeff * drs1 + (1 << 13)) >> 14) - drs2;
+                    drs2 = drs1;
+                    drs1 = drs0;
+                }
+                const double s1 = double(drs1) / 32768.0, s2 = double(drs2) / 32768.0;
+                const double s_N = 2 * COS * s1 - s2;
+                return dcomp(s_N - (COS * s1), SIN * s1);
+            }
+            else
+            {
+                typedef typename SampleTraits<T>::real_type real_type;
+                const real_type COS = real_type(cos(2 * PI * double(k) / double(N)));
+                const real_type SIN = real_type(sin(2 * PI * double(k) / double(N)));
+
+                T drs1 = T(); // s[n-1]
+                T drs2 = T(); // s[n-2]
+
+                // run IIR filter up through x[N-1] term
+                for (int n = 0; n < N; n++)
+                {
+                    T drs0 = x[n] + (real_type(2) * COS * drs1) - drs2;
+                    drs2 = drs1;
+                    drs1 = drs0;
+                }
+
+                // s[N] = 2cos()s[N-1] - s[N-2] assuming x[N] = 0
+                T s_N = real_type(2) * COS * drs1 - drs2;
+
+                // y[N] = s[N] - cos()s[N-1] + isin()s[N-1]
+                return complex_type(s_N - (COS * drs1)) + complex_type(0, SIN) * complex_type(drs1);
+            }
+        }
+
+        inline dcomp goertzelIIR(const std::vector<double> &input, const int k)
+        {
+            return goertzelIIR<double>(input, k);
+        }
+
+        inline double dotProduct(const double *a, const double *b, const size_t n)
+        {
+            double acc0 = 0.0, acc1 = 0.0, acc2 = 0.0, acc3 = 0.0;
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                acc0 += a[i] * b[i];
+                acc1 += a[i + 1] * b[i + 1];
+                acc2 += a[i + 2] * b[i + 2];
+                acc3 += a[i + 3] * b[i + 3];
+            }
+            for (; i < n; i++)
+            {
+                acc0 += a[i] * b[i];
+            }
+            return (acc0 + acc1) + (acc2 + acc3);
+        }
+
+    #if DSP_X86_DISPATCH
+        __attribute__((target("avx2,fma"))) inline float dotProductAVX2(const float *a, const float *b, const size_t n)
+        {
+            __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+            __m256 acc2 = _mm256_setzero_ps(), acc3 = _mm256_setzero_ps();
+            size_t i = 0;
+            for (; i + 32 <= n; i += 32)
+            {
+                acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+                acc1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), acc1);
+                acc2 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 16), _mm256_loadu_ps(b + i + 16), acc2);
+                acc3 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 24), _mm256_loadu_ps(b + i + 24), acc3);
+            }
+            for (; i + 8 <= n; i += 8)
+            {
+                acc0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), acc0);
+            }
+            __m256 sum = _mm256_add_ps(_mm256_add_ps(acc0, acc1), _mm256_add_ps(acc2, acc3));
+            __m128 half = _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+            half = _mm_hadd_ps(half, half);
+            half = _mm_hadd_ps(half, half);
+            float result = _mm_cvtss_f32(half);
+            for (; i < n; i++)
+            {
+                result += a[i] * b[i];
+            }
+            return result;
+        }
+
+        __attribute__((target("avx2"))) inline int64_t dotProductAVX2(const int16_t *a, const int16_t *b, const size_t n)
         {
-            std::vector<double> s;
-            int N = x.size();
-            double COS = cos(2 * PI * double(k) / double(N));
-            double SIN = sin(2 * PI * double(k) / double(N));
+            // widen to 32 bits before multiplying (pmaddwd would overflow on -32768 * -32768 pairs),
+            // then accumulate the exact Q30 products in 64-bit lanes
+            __m256i acc = _mm256_setzero_si256();
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                __m256i va = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i)));
+                __m256i vb = _mm256_cvtepi16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i)));
+                __m256i prod = _mm256_mullo_epi32(va, vb);
+                acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(prod)));
+                acc = _mm256_add_epi64(acc, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(prod, 1)));
+            }
+            alignas(32) int64_t lanes[4];
+            _mm256_store_si256(reinterpret_cast<__m256i *>(lanes), acc);
+            int64_t result = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+            for (; i < n; i++)
+            {
+                result += int64_t(a[i]) * b[i];
+            }
+            return result;
+        }
+    #endif
 
-            double drs0 = 0; // s[n]
-            double drs1 = 0; // s[n-1]
-            double drs2 = 0; // s[n-2]
+        inline float dotProduct(const float *a, const float *b, const size_t n)
+        {
+        #if DSP_X86_DISPATCH
+            if (cpuFeatures().avx2 && cpuFeatures().fma)
+                return dotProductAVX2(a, b, n);
+        #endif
+            float acc0 = 0.0f, acc1 = 0.0f, acc2 = 0.0f, acc3 = 0.0f;
+            size_t i = 0;
+            for (; i + 4 <= n; i += 4)
+            {
+                acc0 += a[i] * b[i];
+                acc1 += a[i + 1] * b[i + 1];
+                acc2 += a[i + 2] * b[i + 2];
+                acc3 += a[i + 3] * b[i + 3];
+            }
+            for (; i < n; i++)
+            {
+                acc0 += a[i] * b[i];
+            }
+            return (acc0 + acc1) + (acc2 + acc3);
+        }
 
-            // run IIR filter up through x[N-1] term
-            for (int n = 0; n < N; n++)
+        inline q15 dotProduct(const q15 *a, const q15 *b, const size_t n)
+        {
+            static_assert(sizeof(q15) == sizeof(int16_t), "q15 must be a bare int16_t");
+            const int16_t *x = reinterpret_cast<const int16_t *>(a);
+            const int16_t *y = reinterpret_cast<const int16_t *>(b);
+            int64_t acc = 0;
+        #if DSP_X86_DISPATCH
+            if (cpuFeatures().avx2)
+                acc = dotProductAVX2(x, y, n);
+            else
+        #endif
             {
-                drs0 = x[n] + (2 * COS * drs1) - drs2;
-                s.push_back(drs0); // s[n] = drs0
-                drs2 = drs1;
-                drs1 = drs0;
+                int64_t acc0 = 0, acc1 = 0;
+                size_t i = 0;
+                for (; i + 2 <= n; i += 2)
+                {
+                    acc0 += int64_t(x[i]) * y[i];
+                    acc1 += int64_t(x[i + 1]) * y[i + 1];
+                }
+                for (; i < n; i++)
+                {
+                    acc0 += int64_t(x[i]) * y[i];
+                }
+                acc = acc0 + acc1;
             }
+            // Q30 -> Q15 with rounding and saturation
+            return q15::raw((acc + (1 << 14)) >> 15);
+        }
 
-            // s[N] = 2cos()s[N-1] - s[N-2] assuming x[N] = 0
-            double s_N = 2 * COS * s[N - 1] - s[N - 2];
+        template <typename R>
+        std::complex<R> dotProduct(const R *a, const std::complex<R> *b, const size_t n)
+        {
+            R re0 = 0, im0 = 0, re1 = 0, im1 = 0;
+            size_t i = 0;
+            for (; i + 2 <= n; i += 2)
+            {
+                re0 += a[i] * b[i].real();
+                im0 += a[i] * b[i].imag();
+                re1 += a[i + 1] * b[i + 1].real();
+                im1 += a[i + 1] * b[i + 1].imag();
+            }
+            for (; i < n; i++)
+            {
+                re0 += a[i] * b[i].real();
+                im0 += a[i] * b[i].imag();
+            }
+            return std::complex<R>(re0 + re1, im0 + im1);
+        }
 
-            // y[N] = s[N] - cos()s[N-1] + isin()s[N-1]
-            double real = s_N - (COS * s[N - 1]);
-            double imag = SIN * s[N - 1];
-            return dcomp(real, imag);
+        inline double besselI0(const double x)
+        {
+            // I0(x) = sum_{k=0}^{inf} ((x/2)^k / k!)^2
+            double sum = 1.0;
+            double term = 1.0;
+            const double halfx = x / 2.0;
+            for (int k = 1; k < 64; k++)
+            {
+                term *= halfx / double(k);
+                sum += term * term;
+                if (term * term < sum * 1e-17)
+                    break;
+            }
+            return sum;
+        }
+
+        inline std::vector<double> designLowpass(const int numTaps, const double cutoff, const double beta)
+        {
+            std::vector<double> taps(numTaps, 0.0);
+            if (numTaps < 1 || cutoff <= 0.0 || cutoff > 0.5)
+            {
+                std::cerr << "ERROR: Invalid filter specification! [designLowpass()]\n";
+                return taps;
+            }
+
+            const double center = double(numTaps - 1) / 2.0;
+            const double norm = besselI0(beta);
+            double gain = 0.0;
+            for (int n = 0; n < numTaps; n++)
+            {
+                // ideal lowpass impulse response: 2fc * sinc(2fc(n - center))
+                double m = double(n) - center;
+                double ideal = (m == 0.0) ? 2.0 * cutoff : sin(2.0 * PI * cutoff * m) / (PI * m);
+                // Kaiser window
+                double r = (center > 0.0) ? m / center : 0.0;
+                double window = besselI0(beta * sqrt(std::max(0.0, 1.0 - r * r))) / norm;
+                taps[n] = ideal * window;
+                gain += taps[n];
+            }
+            for (double &h : taps)
+            {
+                h /= gain;
+            }
+            return taps;
+        }
+
+        // POLYPHASE RESAMPLER
+        template <typename T>
+        BasicPolyphaseResampler<T>::BasicPolyphaseResampler(const int L, const int M, const int halfLength, const double beta)
+        {
+            if (L < 1 || M < 1 || halfLength < 1)
+            {
+                std::cerr << "ERROR: Resampling factors must be positive! [PolyphaseResampler()]\n";
+            }
+            int up = std::max(L, 1), down = std::max(M, 1);
+            int g = std::gcd(up, down);
+            up /= g;
+            down /= g;
+
+            // prototype runs at the upsampled rate, cutoff at the lower of the two Nyquist rates
+            const int rate = std::max(up, down);
+            const int numTaps = 2 * std::max(halfLength, 1) * rate + 1;
+            this->L = up;
+            this->M = down;
+            build(designLowpass(numTaps, 0.5 / double(rate), beta));
+        }
+
+        template <typename T>
+        BasicPolyphaseResampler<T>::BasicPolyphaseResampler(const int L, const int M, const std::vector<double> &taps)
+        {
+            if (L < 1 || M < 1 || taps.empty())
+            {
+                std::cerr << "ERROR: Invalid resampler specification! [PolyphaseResampler()]\n";
+            }
+            int up = std::max(L, 1), down = std::max(M, 1);
+            int g = std::gcd(up, down);
+            this->L = up / g;
+            this->M = down / g;
+            build(taps.empty() ? std::vector<double>(1, 1.0) : taps);
+        }
+
+        template <typename T>
+        void BasicPolyphaseResampler<T>::build(const std::vector<double> &taps)
+        {
+            this->numTaps = taps.size();
+            this->K = int((taps.size() + L - 1) / L);
+            this->branches.assign(size_t(L) * K, coeff_type());
+
+            // branch p holds h[p], h[p+L], h[p+2L], ... reversed so that the inner loop walks
+            // the input buffer forwards; the factor L restores the power lost to zero-stuffing
+            for (int p = 0; p < L; p++)
+            {
+                for (int j = 0; j < K; j++)
+                {
+                    size_t idx = size_t(p) + size_t(j) * L;
+                    double h = (idx < taps.size()) ? taps[idx] : 0.0;
+                    branches[size_t(p) * K + (K - 1 - j)] = SampleTraits<T>::coeffFromDouble(h * double(L));
+                }
+            }
+            reset();
+        }
+
+        template <typename T>
+        void BasicPolyphaseResampler<T>::reset()
+        {
+            this->history.assign(K - 1, T());
+            this->edge.assign(2 * size_t(K - 1), T());
+            this->t = 0;
+        }
+
+        template <typename T>
+        size_t BasicPolyphaseResampler<T>::process(const T *input, const size_t n, std::vector<T> &output)
+        {
+            // output windows start at idx on the axis of history followed by input: the first K-1 of them
+            // straddle the block boundary and read from edge, all later ones read the input in place
+            const size_t H = size_t(K - 1);
+            const size_t head = std::min(n, H);
+            std::copy(history.begin(), history.end(), edge.begin());
+            std::copy(input, input + head, edge.begin() + H);
+
+            size_t produced = 0;
+            const long long end = (long long)n * L;
+            output.reserve(output.size() + size_t((end - t + M - 1) / M) + 1);
+            for (; t < end; t += M)
+            {
+                const size_t idx = size_t(t / L);
+                const coeff_type *branch = &branches[size_t(t % L) * K];
+                const T *window = (idx < H) ? &edge[idx] : input + (idx - H);
+                output.push_back(dotProduct(branch, window, size_t(K)));
+                produced++;
+            }
+            t -= end;
+
+            // keep the last K-1 samples as history for the next block
+            if (n >= H)
+                std::copy(input + (n - H), input + n, history.begin());
+            else
+                std::copy(edge.begin() + n, edge.begin() + n + H, history.begin());
+            return produced;
+        }
+
+        template <typename T>
+        std::vector<T> BasicPolyphaseResampler<T>::process(const std::vector<T> &input)
+        {
+            std::vector<T> output;
+            process(input.data(), input.size(), output);
+            return output;
+        }
+
+        template <typename T>
+        int BasicPolyphaseResampler<T>::up() const { return this->L; }
+
+        template <typename T>
+        int BasicPolyphaseResampler<T>::down() const { return this->M; }
+
+        template <typename T>
+        double BasicPolyphaseResampler<T>::delay() const
+        {
+            return (double(numTaps) - 1.0) / 2.0 / double(M);
+        }
+
+        // MULTISTAGE DECIMATOR
+        inline MultistageDecimator::MultistageDecimator(const int factor, const int halfLength, const double beta)
+        {
+            if (factor < 1)
+            {
+                std::cerr << "ERROR: Decimation factor must be positive! [MultistageDecimator()]\n";
+            }
+
+            // prime factorization, largest primes first
+            std::vector<int> primes;
+            int remaining = std::max(factor, 1);
+            for (int p = 2; p * p <= remaining; p++)
+            {
+                while (remaining % p == 0)
+                {
+                    primes.push_back(p);
+                    remaining /= p;
+                }
+            }
+            if (remaining > 1)
+                primes.push_back(remaining);
+            std::sort(primes.rbegin(), primes.rend());
+
+            // greedily merge primes into stages of factor <= 8
+            for (int p : primes)
+            {
+                if (!stageFactors.empty() && stageFactors.back() * p <= 8)
+                    stageFactors.back() *= p;
+                else
+                    stageFactors.push_back(p);
+            }
+            if (stageFactors.empty())
+                stageFactors.push_back(1);
+
+            for (int f : stageFactors)
+            {
+                stages.emplace_back(1, f, halfLength, beta);
+            }
+        }
+
+        inline size_t MultistageDecimator::process(const double *input, const size_t n, std::vector<double> &output)
+        {
+            const double *in = input;
+            size_t count = n;
+            for (size_t s = 0; s + 1 < stages.size(); s++)
+            {
+                std::vector<double> &next = (s % 2 == 0) ? scratchA : scratchB;
+                next.clear();
+                count = stages[s].process(in, count, next);
+                in = next.data();
+            }
+            return stages.back().process(in, count, output);
+        }
+
+        inline std::vector<double> MultistageDecimator::process(const std::vector<double> &input)
+        {
+            std::vector<double> output;
+            process(input.data(), input.size(), output);
+            return output;
+        }
+
+        inline void MultistageDecimator::reset()
+        {
+            for (PolyphaseResampler &stage : stages)
+            {
+                stage.reset();
+            }
+        }
+
+        inline const std::vector<int> &MultistageDecimator::factors() const
+        {
+            return this->stageFactors;
+        }
+
+        template <typename T>
+        std::vector<T> resample(const std::vector<T> &signal, const int L, const int M)
+        {
+            BasicPolyphaseResampler<T> resampler(L, M);
+            return resampler.process(signal);
+        }
+
+        template <typename T>
+        std::vector<T> firFilter(const std::vector<T> &input, const std::vector<double> &taps)
+        {
+            INSTRUMENT_SCOPE("dsp::firFilter");
+            INSTRUMENT_WORK("dsp::firFilter", 2 * input.size() * sizeof(T), 2 * input.size() * taps.size());
+            // a 1/1 polyphase resampler is exactly a direct-form FIR filter
+            BasicPolyphaseResampler<T> filter(1, 1, taps);
+            return filter.process(input);
+        }
+
+        // FFT
+    #if DSP_X86_DISPATCH
+        // radix-2 stages of length len >= 8 on interleaved complex<float> data, 4 butterflies per step;
+        // w holds the half = len/2 twiddles of the stage, conjugated on the fly for the inverse
+        __attribute__((target("avx2,fma"))) inline void butterfliesAVX2(float *data, const size_t N, const size_t len, const float *w, const bool inverse)
+        {
+            const size_t half = len / 2;
+            const __m256 conjugate = inverse ? _mm256_setr_ps(0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f, 0.0f, -0.0f) : _mm256_setzero_ps();
+            for (size_t start = 0; start < N; start += len)
+            {
+                float *a = data + 2 * start;
+                float *b = a + 2 * half;
+                for (size_t j = 0; j < half; j += 4)
+                {
+                    const __m256 tw = _mm256_xor_ps(_mm256_loadu_ps(w + 2 * j), conjugate);
+                    const __m256 vb = _mm256_loadu_ps(b + 2 * j);
+                    // (br + i bi)(wr + i wi): fmaddsub gives br wr - bi wi in even lanes, br wi + bi wr in odd lanes
+                    const __m256 cross = _mm256_mul_ps(_mm256_movehdup_ps(vb), _mm256_permute_ps(tw, 0xB1));
+                    const __m256 t = _mm256_fmaddsub_ps(_mm256_moveldup_ps(vb), tw, cross);
+                    const __m256 va = _mm256_loadu_ps(a + 2 * j);
+                    _mm256_storeu_ps(a + 2 * j, _mm256_add_ps(va, t));
+                    _mm256_storeu_ps(b + 2 * j, _mm256_sub_ps(va, t));
+                }
+            }
+        }
+    #endif
+
+        template <typename R>
+        BasicFFTPlan<R>::BasicFFTPlan(const size_t N)
+        {
+            this->N = (N == 0) ? 1 : N;
+            this->radix2 = ((this->N & (this->N - 1)) == 0);
+
+            if (radix2)
+            {
+                twiddles.resize(this->N / 2);
+                for (size_t k = 0; k < this->N / 2; k++)
+                {
+                    double theta = -2.0 * PI * double(k) / double(this->N);
+                    twiddles[k] = complex_type(R(cos(theta)), R(sin(theta)));
+                }
+
+                size_t bits = 0;
+                while ((size_t(1) << bits) < this->N)
+                    bits++;
+                reversal.resize(this->N);
+                for (size_t i = 0; i < this->N; i++)
+                {
+                    size_t r = 0;
+                    for (size_t b = 0; b < bits; b++)
+                    {
+                        r |= ((i >> b) & 1) << (bits - 1 - b);
+                    }
+                    reversal[i] = r;
+                }
+                if constexpr (std::is_same<R, float>::value)
+                {
+                    // stage len uses twiddles[j * N / len], j < len / 2; stored from offset len / 2
+                    stageTwiddles.resize(this->N);
+                    for (size_t len = 8; len <= this->N; len <<= 1)
+                        for (size_t j = 0; j < len / 2; j++)
+                            stageTwiddles[len / 2 + j] = twiddles[j * (this->N / len)];
+                }
+                return;
+            }
+
+            // Bluestein: X[k] = c[k] * sum_n (x[n] c[n]) conj(c[k-n]), c[n] = exp(-PI i n^2 / N),
+            // a linear convolution evaluated with a power-of-two FFT of length M >= 2N - 1
+            size_t M = 1;
+            while (M < 2 * this->N - 1)
+                M <<= 1;
+            padded = std::make_shared<const BasicFFTPlan<R>>(M);
+
+            chirp.resize(this->N);
+            for (size_t n = 0; n < this->N; n++)
+            {
+                // reduce n^2 mod 2N first to keep the phase accurate for large n
+                size_t n2 = (n * n) % (2 * this->N);
+                double theta = -PI * double(n2) / double(this->N);
+                chirp[n] = complex_type(R(cos(theta)), R(sin(theta)));
+            }
+            kernel.assign(M, complex_type(0, 0));
+            kernel[0] = std::conj(chirp[0]);
+            for (size_t n = 1; n < this->N; n++)
+            {
+                kernel[n] = std::conj(chirp[n]);
+                kernel[M - n] = std::conj(chirp[n]);
+            }
+            std::vector<complex_type> unused;
+            padded->forward(kernel.data(), unused);
+        }
+
+        template <typename R>
+        size_t BasicFFTPlan<R>::size() const
+        {
+            return this->N;
+        }
+
+        template <typename R>
+        void BasicFFTPlan<R>::butterflies(complex_type *data, const bool inverse) const
+        {
+            for (size_t i = 0; i < N; i++)
+            {
+                size_t r = reversal[i];
+                if (r > i)
+                    std::swap(data[i], data[r]);
+            }
+
+            // complex products are expanded by hand, std::complex multiplication carries NaN handling
+            // that prevents inlining without -ffast-math
+            const R sign = inverse ? R(-1) : R(1);
+            for (size_t len = 2; len <= N; len <<= 1)
+            {
+            #if DSP_X86_DISPATCH
+                if constexpr (std::is_same<R, float>::value)
+                {
+                    if (len >= 8 && cpuFeatures().avx2 && cpuFeatures().fma)
+                    {
+                        butterfliesAVX2(reinterpret_cast<float *>(data), N, len, reinterpret_cast<const float *>(&stageTwiddles[len / 2]), inverse);
+                        continue;
+                    }
+                }
+            #endif
+                const size_t half = len / 2;
+                const size_t step = N / len;
+                for (size_t start = 0; start < N; start += len)
+                {
+                    for (size_t j = 0; j < half; j++)
+                    {
+                        const complex_type w = twiddles[j * step];
+                        const R wr = w.real(), wi = sign * w.imag();
+                        complex_type &a = data[start + j];
+                        complex_type &b = data[start + j + half];
+                        const R br = b.real() * wr - b.imag() * wi;
+                        const R bi = b.real() * wi + b.imag() * wr;
+                        const R ar = a.real(), ai = a.imag();
+                        a = complex_type(ar + br, ai + bi);
+                        b = complex_type(ar - br, ai - bi);
+                    }
+                }
+            }
+        }
+
+        template <typename R>
+        void BasicFFTPlan<R>::bluestein(complex_type *data, std::vector<complex_type> &scratch) const
+        {
+            const size_t M = padded->size();
+            scratch.assign(M, complex_type(0, 0));
+            for (size_t n = 0; n < N; n++)
+            {
+                scratch[n] = data[n] * chirp[n];
+            }
+            padded->butterflies(scratch.data(), false);
+            for (size_t k = 0; k < M; k++)
+            {
+                scratch[k] *= kernel[k];
+            }
+            padded->butterflies(scratch.data(), true);
+            const R scale = R(1) / R(M);
+            for (size_t k = 0; k < N; k++)
+            {
+                data[k] = scratch[k] * chirp[k] * scale;
+            }
+        }
+
+        template <typename R>
+        void BasicFFTPlan<R>::forward(complex_type *data, std::vector<complex_type> &scratch) const
+        {
+            if (radix2)
+                butterflies(data, false);
+            else
+                bluestein(data, scratch);
+        }
+
+        template <typename R>
+        void BasicFFTPlan<R>::inverse(complex_type *data, std::vector<complex_type> &scratch) const
+        {
+            const R scale = R(1) / R(N);
+            if (radix2)
+            {
+                butterflies(data, true);
+                for (size_t n = 0; n < N; n++)
+                {
+                    data[n] *= scale;
+                }
+                return;
+            }
+            // ifft(X) = conj(fft(conj(X))) / N
+            for (size_t n = 0; n < N; n++)
+            {
+                data[n] = std::conj(data[n]);
+            }
+            bluestein(data, scratch);
+            for (size_t n = 0; n < N; n++)
+            {
+                data[n] = std::conj(data[n]) * scale;
+            }
+        }
+
+        template <typename R>
+        typename std::enable_if<std::is_floating_point<R>::value, std::vector<std::complex<R>>>::type
+        FFT(const std::vector<R> &x)
+        {
+            INSTRUMENT_SCOPE("dsp::FFT");
+            std::vector<std::complex<R>> X(x.begin(), x.end());
+            std::vector<std::complex<R>> scratch;
+            BasicFFTPlan<R>(x.size()).forward(X.data(), scratch);
+            return X;
+        }
+
+        template <typename R>
+        std::vector<std::complex<R>> FFT(const std::vector<std::complex<R>> &x)
+        {
+            std::vector<std::complex<R>> X(x);
+            std::vector<std::complex<R>> scratch;
+            BasicFFTPlan<R>(x.size()).forward(X.data(), scratch);
+            return X;
+        }
+
+        template <typename R>
+        std::vector<std::complex<R>> IFFT(const std::vector<std::complex<R>> &X)
+        {
+            std::vector<std::complex<R>> x(X);
+            std::vector<std::complex<R>> scratch;
+            BasicFFTPlan<R>(X.size()).inverse(x.data(), scratch);
+            return x;
+        }
+
+        inline std::vector<cq15> FFT(const std::vector<q15> &x)
+        {
+            const size_t N = x.size();
+            if (N == 0 || (N & (N - 1)) != 0)
+            {
+                std::cerr << "ERROR: Fixed-point FFT length must be a power of two! [FFT()]\n";
+                return std::vector<cq15>();
+            }
+
+            size_t bits = 0;
+            while ((size_t(1) << bits) < N)
+                bits++;
+            std::vector<int32_t> re(N), im(N, 0);
+            for (size_t i = 0; i < N; i++)
+            {
+                size_t r = 0;
+                for (size_t b = 0; b < bits; b++)
+                {
+                    r |= ((i >> b) & 1) << (bits - 1 - b);
+                }
+                re[r] = x[i].value;
+            }
+
+            // Q15 twiddles, each stage halves its outputs so |values| stay below full scale
+            std::vector<int32_t> wr(N / 2), wi(N / 2);
+            for (size_t k = 0; k < N / 2; k++)
+            {
+                double theta = -2.0 * PI * double(k) / double(N);
+                wr[k] = int32_t(std::lround(cos(theta) * 32767.0));
+                wi[k] = int32_t(std::lround(sin(theta) * 32767.0));
+            }
+            for (size_t len = 2; len <= N; len <<= 1)
+            {
+                const size_t half = len / 2;
+                const size_t step = N / len;
+                for (size_t start = 0; start < N; start += len)
+                {
+                    for (size_t j = 0; j < half; j++)
+                    {
+                        const size_t a = start + j, b = a + half;
+                        const int64_t w_r = wr[j * step], w_i = wi[j * step];
+                        const int32_t tr = int32_t((re[b] * w_r - im[b] * w_i + (1 << 14)) >> 15);
+                        const int32_t ti = int32_t((re[b] * w_i + im[b] * w_r + (1 << 14)) >> 15);
+                        const int32_t ar = re[a], ai = im[a];
+                        re[a] = (ar + tr + 1) >> 1;
+                        im[a] = (ai + ti + 1) >> 1;
+                        re[b] = (ar - tr + 1) >> 1;
+                        im[b] = (ai - ti + 1) >> 1;
+                    }
+                }
+            }
+
+            std::vector<cq15> X(N);
+            for (size_t k = 0; k < N; k++)
+            {
+                X[k].re = q15::raw(re[k]);
+                X[k].im = q15::raw(im[k]);
+            }
+            return X;
+        }
+
+        // WINDOWS
+        inline std::vector<double> makeWindow(const WindowType type, const size_t length, const double beta, const bool periodic)
+        {
+            std::vector<double> w(length, 1.0);
+            if (length < 2)
+                return w;
+
+            // periodic windows are the first `length` points of a symmetric window of length+1
+            const double denom = periodic ? double(length) : double(length - 1);
+            for (size_t n = 0; n < length; n++)
+            {
+                const double x = 2.0 * PI * double(n) / denom;
+                switch (type)
+                {
+                case HANN:
+                    w[n] = 0.5 - 0.5 * cos(x);
+                    break;
+                case HAMMING:
+                    w[n] = 0.54 - 0.46 * cos(x);
+                    break;
+                case BLACKMAN:
+                    w[n] = 0.42 - 0.5 * cos(x) + 0.08 * cos(2.0 * x);
+                    break;
+                case KAISER:
+                {
+                    double r = 2.0 * double(n) / denom - 1.0;
+                    w[n] = besselI0(beta * sqrt(std::max(0.0, 1.0 - r * r))) / besselI0(beta);
+                    break;
+                }
+                case RECTANGULAR:
+                default:
+                    w[n] = 1.0;
+                }
+            }
+            return w;
+        }
+
+        // STFT
+        inline STFT::STFT(const STFTConfig &config, ThreadPool &pool)
+        {
+            this->config = config;
+            if (this->config.windowLength == 0 || this->config.hop == 0)
+            {
+                std::cerr << "ERROR: Window length and hop must be positive! [STFT()]\n";
+                this->config.windowLength = std::max<size_t>(this->config.windowLength, 1);
+                this->config.hop = std::max<size_t>(this->config.hop, 1);
+            }
+            if (this->config.fftSize < this->config.windowLength)
+            {
+                if (this->config.fftSize != 0)
+                    std::cerr << "WARNING: FFT size smaller than window, using window length. [STFT()]\n";
+                this->config.fftSize = this->config.windowLength;
+            }
+            this->window = makeWindow(this->config.window, this->config.windowLength, this->config.beta, true);
+            this->plan = FFTPlan(this->config.fftSize);
+            this->pool = &pool;
+        }
+
+        inline size_t STFT::padding() const
+        {
+            return config.center ? config.windowLength / 2 : 0;
+        }
+
+        inline size_t STFT::frames(const size_t n) const
+        {
+            const size_t total = n + 2 * padding();
+            if (total <= config.windowLength)
+                return 1;
+            return 1 + (total - config.windowLength + config.hop - 1) / config.hop;
+        }
+
+        inline size_t STFT::bins() const
+        {
+            return config.fftSize / 2 + 1;
+        }
+
+        inline const STFTConfig &STFT::settings() const
+        {
+            return this->config;
+        }
+
+        inline void STFT::loadFrames(const double *x, const size_t n, const size_t f, const size_t count, dcomp *buf) const
+        {
+            // frame f goes in the real part and frame f+1 (if count == 2) in the imaginary part
+            const size_t W = config.windowLength;
+            const long long pad = (long long)padding();
+            for (size_t i = 0; i < config.fftSize; i++)
+            {
+                double re = 0.0, im = 0.0;
+                if (i < W)
+                {
+                    long long idx = (long long)(f * config.hop + i) - pad;
+                    if (idx >= 0 && idx < (long long)n)
+                        re = window[i] * x[idx];
+                    idx += (long long)config.hop;
+                    if (count == 2 && idx >= 0 && idx < (long long)n)
+                        im = window[i] * x[idx];
+                }
+                buf[i] = dcomp(re, im);
+            }
+        }
+
+        template <typename Writer>
+        void STFT::analyze(const double *x, const size_t n, Writer &&write) const
+        {
+            const size_t F = frames(n);
+            const size_t N = config.fftSize;
+            const size_t B = bins();
+            const size_t pairs = (F + 1) / 2;
+
+            std::vector<std::vector<dcomp>> buffers(pool->size(), std::vector<dcomp>(N));
+            std::vector<std::vector<dcomp>> scratch(pool->size());
+
+            pool->parallelFor(0, pairs, [&](size_t p, size_t worker) {
+                const size_t f = 2 * p;
+                const size_t count = (f + 1 < F) ? 2 : 1;
+                dcomp *Z = buffers[worker].data();
+                loadFrames(x, n, f, count, Z);
+                plan.forward(Z, scratch[worker]);
+
+                // z = a + i b with a, b real: A[k] = (Z[k] + conj(Z[N-k])) / 2, B[k] = (Z[k] - conj(Z[N-k])) / 2i
+                for (size_t k = 0; k < B; k++)
+                {
+                    const dcomp zk = Z[k];
+                    const dcomp zn = std::conj(Z[(N - k) % N]);
+                    const dcomp a = 0.5 * (zk + zn);
+                    const dcomp d = zk - zn;
+                    const dcomp b(0.5 * d.imag(), -0.5 * d.real());
+                    write(f, k, a);
+                    if (count == 2)
+                        write(f + 1, k, b);
+                }
+            }, 4);
+        }
+
+        inline void STFT::forward(const double *x, const size_t n, Matrix<dcomp> &out) const
+        {
+            if (out.rows() != frames(n) || out.cols() != bins())
+                out.resize(frames(n), bins());
+            analyze(x, n, [&](size_t f, size_t k, const dcomp &X) { out.rowData(f)[k] = X; });
+        }
+
+        inline Matrix<dcomp> STFT::forward(const std::vector<double> &x) const
+        {
+            Matrix<dcomp> out(frames(x.size()), bins());
+            forward(x.data(), x.size(), out);
+            return out;
+        }
+
+        inline void STFT::spectrogram(const double *x, const size_t n, Matrix<double> &out) const
+        {
+            if (out.rows() != frames(n) || out.cols() != bins())
+                out.resize(frames(n), bins());
+            analyze(x, n, [&](size_t f, size_t k, const dcomp &X) { out.rowData(f)[k] = std::norm(X); });
+        }
+
+        inline Matrix<double> STFT::spectrogram(const std::vector<double> &x) const
+        {
+            Matrix<double> out(frames(x.size()), bins());
+            spectrogram(x.data(), x.size(), out);
+            return out;
+        }
+
+        inline std::vector<double> STFT::inverse(const Matrix<dcomp> &S, const size_t n) const
+        {
+            const size_t F = S.rows();
+            const size_t N = config.fftSize;
+            const size_t W = config.windowLength;
+            const size_t B = bins();
+            const long long pad = (long long)padding();
+            std::vector<double> out(n, 0.0), norm(n, 0.0);
+            if (S.cols() != B)
+            {
+                std::cerr << "ERROR: STFT matrix does not match the configured bin count! [STFT::inverse()]\n";
+                return out;
+            }
+
+            // Frames are grouped into blocks spanning at least one window length, so blocks two apart never
+            // write the same output samples: all even blocks are overlap-added in parallel, then all odd ones.
+            const size_t perBlock = std::max<size_t>(2 * ((W + config.hop - 1) / config.hop), 8);
+            const size_t blocks = (F + perBlock - 1) / perBlock;
+            std::vector<std::vector<dcomp>> buffers(pool->size(), std::vector<dcomp>(N));
+            std::vector<std::vector<dcomp>> scratch(pool->size());
+
+            auto synthesize = [&](size_t f, size_t count, size_t worker) {
+                // Z = A + iB over the full Hermitian spectra of both frames, so ifft(Z) = a + ib
+                dcomp *Z = buffers[worker].data();
+                const dcomp *A = S.rowData(f);
+                const dcomp *Bf = (count == 2) ? S.rowData(f + 1) : nullptr;
+                for (size_t k = 0; k < N; k++)
+                {
+                    const bool mirrored = (k >= B);
+                    const size_t src = mirrored ? N - k : k;
+                    dcomp a = mirrored ? std::conj(A[src]) : A[src];
+                    dcomp b = (count == 2) ? (mirrored ? std::conj(Bf[src]) : Bf[src]) : dcomp(0.0, 0.0);
+                    Z[k] = a + dcomp(-b.imag(), b.real());
+                }
+                plan.inverse(Z, scratch[worker]);
+
+                for (size_t c = 0; c < count; c++)
+                {
+                    const long long start = (long long)((f + c) * config.hop) - pad;
+                    for (size_t i = 0; i < W; i++)
+                    {
+                        const long long idx = start + (long long)i;
+                        if (idx < 0 || idx >= (long long)n)
+                            continue;
+                        const double v = (c == 0) ? Z[i].real() : Z[i].imag();
+                        out[idx] += window[i] * v;
+                        norm[idx] += window[i] * window[i];
+                    }
+                }
+            };
+
+            for (size_t parity = 0; parity < 2; parity++)
+            {
+                pool->parallelFor(0, (blocks + 1 - parity) / 2, [&](size_t b, size_t worker) {
+                    const size_t first = (2 * b + parity) * perBlock;
+                    const size_t last = std::min(first + perBlock, F);
+                    for (size_t f = first; f < last; f += 2)
+                    {
+                        synthesize(f, (f + 1 < last) ? 2 : 1, worker);
+                    }
+                });
+            }
+
+            for (size_t i = 0; i < n; i++)
+            {
+                if (norm[i] > 1e-10)
+                    out[i] /= norm[i];
+            }
+            return out;
+        }
+
+        // WELCH
+        inline WelchEstimator::WelchEstimator(const WelchConfig &config, ThreadPool &pool)
+        {
+            this->config = config;
+            if (this->config.segmentLength == 0 || this->config.overlap >= this->config.segmentLength)
+            {
+                std::cerr << "ERROR: Overlap must be smaller than a non-empty segment! [WelchEstimator()]\n";
+                this->config.segmentLength = std::max<size_t>(this->config.segmentLength, 1);
+                this->config.overlap = 0;
+            }
+            if (this->config.fftSize < this->config.segmentLength)
+                this->config.fftSize = this->config.segmentLength;
+            if (this->config.batchSegments == 0)
+                this->config.batchSegments = 1;
+            if (this->config.medianSegments == 0)
+                this->config.medianSegments = 1;
+
+            this->window = makeWindow(this->config.window, this->config.segmentLength, this->config.beta, true);
+            this->windowPower = 0.0;
+            for (double w : window)
+            {
+                windowPower += w * w;
+            }
+            this->plan = FFTPlan(this->config.fftSize);
+            this->pool = &pool;
+            this->batch.reserve(this->config.batchSegments * this->config.fftSize);
+            this->buffers.assign(pool.size(), std::vector<dcomp>(this->config.fftSize));
+            this->scratch.assign(pool.size(), std::vector<dcomp>());
+            reset();
+        }
+
+        inline void WelchEstimator::reset()
+        {
+            pending.clear();
+            history.clear();
+            historyStart = 0;
+            historyCount = 0;
+            accumulated.assign(config.fftSize, 0.0);
+            weight = 0.0;
+            count = 0;
+        }
+
+        inline size_t WelchEstimator::step() const
+        {
+            return config.segmentLength - config.overlap;
+        }
+
+        inline void WelchEstimator::transform(const size_t numSegments)
+        {
+            const size_t N = config.fftSize;
+            const size_t L = config.segmentLength;
+            batch.resize(numSegments * N);
+
+            pool->parallelFor(0, numSegments, [&](size_t s, size_t worker) {
+                dcomp *X = buffers[worker].data();
+                const double *x = &pending[s * step()];
+                for (size_t i = 0; i < N; i++)
+                {
+                    X[i] = (i < L) ? dcomp(window[i] * x[i], 0.0) : dcomp(0.0, 0.0);
+                }
+                plan.forward(X, scratch[worker]);
+                double *P = &batch[s * N];
+                for (size_t k = 0; k < N; k++)
+                {
+                    P[k] = std::norm(X[k]);
+                }
+            });
+
+            // fold in segment order so the result is independent of the thread count
+            for (size_t s = 0; s < numSegments; s++)
+            {
+                fold(&batch[s * N]);
+            }
+            pending.erase(pending.begin(), pending.begin() + numSegments * step());
+        }
+
+        inline void WelchEstimator::fold(const double *P)
+        {
+            const size_t N = config.fftSize;
+            switch (config.averaging)
+            {
+            case MEDIAN_AVERAGE:
+                remember(P);
+                break;
+            case EXPONENTIAL_AVERAGE:
+            {
+                const double decay = 1.0 - config.smoothing;
+                for (size_t k = 0; k < N; k++)
+                {
+                    accumulated[k] = decay * accumulated[k] + config.smoothing * P[k];
+                }
+                weight = decay * weight + config.smoothing;
+                break;
+            }
+            case MEAN_AVERAGE:
+            default:
+                for (size_t k = 0; k < N; k++)
+                {
+                    accumulated[k] += P[k];
+                }
+            }
+            count++;
+        }
+
+        inline void WelchEstimator::remember(const double *P)
+        {
+            // the ring grows up to medianSegments slots, then the newest periodogram replaces the oldest
+            const size_t N = config.fftSize;
+            size_t slot;
+            if (historyCount < config.medianSegments)
+            {
+                slot = historyCount++;
+                history.resize(historyCount * N);
+            }
+            else
+            {
+                slot = historyStart;
+                historyStart = (historyStart + 1) % historyCount;
+            }
+            std::copy(P, P + N, history.begin() + slot * N);
+        }
+
+        inline void WelchEstimator::push(const double *x, const size_t n)
+        {
+            const size_t L = config.segmentLength;
+            const size_t batchSpan = L + (config.batchSegments - 1) * step();
+            size_t consumed = 0;
+            while (consumed < n)
+            {
+                // top the buffer up to one full batch, transform it, repeat
+                size_t take = std::min(n - consumed, (pending.size() < batchSpan) ? batchSpan - pending.size() : 0);
+                pending.insert(pending.end(), x + consumed, x + consumed + take);
+                consumed += take;
+                if (pending.size() >= batchSpan)
+                    transform(config.batchSegments);
+            }
+            // transform whatever complete segments remain so psd() stays up to date
+            if (pending.size() >= L)
+                transform((pending.size() - L) / step() + 1);
+        }
+
+        inline void WelchEstimator::push(const std::vector<double> &x)
+        {
+            push(x.data(), x.size());
+        }
+
+        inline void WelchEstimator::merge(const WelchEstimator &other)
+        {
+            if (other.config.fftSize != config.fftSize || other.config.averaging != config.averaging)
+            {
+                std::cerr << "ERROR: Estimators must share fft size and averaging to merge! [WelchEstimator::merge()]\n";
+                return;
+            }
+            if (&other == this)
+            {
+                // the median window would be read while it grows, merge a copy instead
+                const WelchEstimator copy(other);
+                merge(copy);
+                return;
+            }
+            if (config.averaging == MEDIAN_AVERAGE)
+            {
+                // the other estimator's periodograms are newer, oldest first
+                const size_t N = config.fftSize;
+                for (size_t s = 0; s < other.historyCount; s++)
+                    remember(&other.history[((other.historyStart + s) % other.historyCount) * N]);
+            }
+            else if (config.averaging == EXPONENTIAL_AVERAGE)
+            {
+                // the other estimator's segments are newer: age everything here by its segment count
+                const double decay = std::pow(1.0 - config.smoothing, double(other.count));
+                for (size_t k = 0; k < config.fftSize; k++)
+                {
+                    accumulated[k] = decay * accumulated[k] + other.accumulated[k];
+                }
+                weight = decay * weight + other.weight;
+            }
+            else
+            {
+                for (size_t k = 0; k < config.fftSize; k++)
+                {
+                    accumulated[k] += other.accumulated[k];
+                }
+            }
+            count += other.count;
+        }
+
+        inline std::vector<double> WelchEstimator::psd() const
+        {
+            const size_t N = config.fftSize;
+            std::vector<double> P(N, 0.0);
+            if (count == 0)
+                return P;
+
+            if (config.averaging == MEDIAN_AVERAGE)
+            {
+                // the median of chi-squared(2) periodograms is biased low, divide by the expected median
+                // over the segments in the window (approaches ln 2 for many segments)
+                const size_t held = historyCount;
+                double bias = 1.0;
+                for (size_t k = 1; k <= (held - 1) / 2; k++)
+                {
+                    bias += 1.0 / double(2 * k + 1) - 1.0 / double(2 * k);
+                }
+                std::vector<double> column(held);
+                for (size_t k = 0; k < N; k++)
+                {
+                    for (size_t s = 0; s < held; s++)
+                    {
+                        column[s] = history[s * N + k];
+                    }
+                    std::nth_element(column.begin(), column.begin() + held / 2, column.end());
+                    double median = column[held / 2];
+                    if (held % 2 == 0)
+                        median = 0.5 * (median + *std::max_element(column.begin(), column.begin() + held / 2));
+                    P[k] = median / bias;
+                }
+            }
+            else if (config.averaging == EXPONENTIAL_AVERAGE)
+            {
+                for (size_t k = 0; k < N; k++)
+                {
+                    P[k] = accumulated[k] / weight;
+                }
+            }
+            else
+            {
+                for (size_t k = 0; k < N; k++)
+                {
+                    P[k] = accumulated[k] / double(count);
+                }
+            }
+
+            // density scaling: |X|^2 / (fs * sum(w^2))
+            const double scale = 1.0 / (config.samplingRate * windowPower);
+            for (double &p : P)
+            {
+                p *= scale;
+            }
+            if (!config.onesided)
+                return P;
+
+            // fold the negative frequencies onto the positive ones, DC and Nyquist appear once
+            std::vector<double> folded(N / 2 + 1);
+            for (size_t k = 0; k <= N / 2; k++)
+            {
+                folded[k] = P[k];
+                if (k != 0 && !(N % 2 == 0 && k == N / 2))
+                    folded[k] += P[N - k];
+            }
+            return folded;
+        }
+
+        inline std::vector<double> WelchEstimator::frequencies() const
+        {
+            const size_t N = config.fftSize;
+            const size_t bins = config.onesided ? N / 2 + 1 : N;
+            std::vector<double> f(bins);
+            for (size_t k = 0; k < bins; k++)
+            {
+                double index = (k <= N / 2 || config.onesided) ? double(k) : double(k) - double(N);
+                f[k] = index * config.samplingRate / double(N);
+            }
+            return f;
+        }
+
+        inline size_t WelchEstimator::segments() const
+        {
+            return this->count;
+        }
+
+        inline const WelchConfig &WelchEstimator::settings() const
+        {
+            return this->config;
+        }
+
+        inline std::vector<double> welch(const std::vector<double> &x, const WelchConfig &config)
+        {
+            WelchEstimator estimator(config);
+            estimator.push(x);
+            return estimator.psd();
+        }
+
+        // MULTICHANNEL BUFFER
+        inline double *MultiChannelBuffer::allocate(const size_t count)
+        {
+            if (count == 0)
+                return nullptr;
+            double *newData = static_cast<double *>(::operator new[](count * sizeof(double), std::align_val_t(64)));
+            std::fill(newData, newData + count, 0.0);
+            return newData;
+        }
+
+        inline void MultiChannelBuffer::deallocate(double *del)
+        {
+            if (!del) {return;} // safeguard
+            ::operator delete[](del, std::align_val_t(64));
+        }
+
+        inline size_t MultiChannelBuffer::storage() const
+        {
+            return (order == PLANAR) ? C * pitch : N * pitch;
+        }
+
+        inline MultiChannelBuffer::MultiChannelBuffer()
+        {
+            this->C = 0;
+            this->N = 0;
+            this->pitch = 0;
+            this->order = PLANAR;
+            this->data = nullptr;
+        }
+
+        inline MultiChannelBuffer::MultiChannelBuffer(const size_t channels, const size_t samples, const ChannelLayout layout)
+        {
+            this->C = channels;
+            this->N = samples;
+            this->order = layout;
+            // planar channels start on cache line boundaries, interleaved instants are packed
+            this->pitch = (layout == PLANAR) ? (samples + 7) / 8 * 8 : channels;
+            this->data = allocate(storage());
+        }
+
+        inline MultiChannelBuffer::MultiChannelBuffer(const MultiChannelBuffer &B)
+        {
+            this->C = B.C;
+            this->N = B.N;
+            this->pitch = B.pitch;
+            this->order = B.order;
+            this->data = allocate(storage());
+            if (this->data)
+                std::copy(B.data, B.data + storage(), this->data);
+        }
+
+        inline MultiChannelBuffer::MultiChannelBuffer(MultiChannelBuffer &&B)
+        {
+            // Steal the data
+            this->C = B.C;
+            this->N = B.N;
+            this->pitch = B.pitch;
+            this->order = B.order;
+            this->data = B.data;
+
+            // Disconnect B ownership
+            B.data = nullptr;
+            B.C = 0;
+            B.N = 0;
+        }
+
+        inline MultiChannelBuffer::~MultiChannelBuffer()
+        {
+            deallocate(this->data);
+        }
+
+        inline size_t MultiChannelBuffer::channels() const { return this->C; }
+
+        inline size_t MultiChannelBuffer::samples() const { return this->N; }
+
+        inline ChannelLayout MultiChannelBuffer::layout() const { return this->order; }
+
+        inline size_t MultiChannelBuffer::stride() const { return this->pitch; }
+
+        inline double *MultiChannelBuffer::rawData() { return this->data; }
+
+        inline const double *MultiChannelBuffer::rawData() const { return this->data; }
+
+        inline ChannelView<double> MultiChannelBuffer::channel(const size_t c)
+        {
+            if (order == PLANAR)
+                return ChannelView<double>{data + c * pitch, N, 1};
+            return ChannelView<double>{data + c, N, pitch};
+        }
+
+        inline ChannelView<const double> MultiChannelBuffer::channel(const size_t c) const
+        {
+            if (order == PLANAR)
+                return ChannelView<const double>{data + c * pitch, N, 1};
+            return ChannelView<const double>{data + c, N, pitch};
+        }
+
+        inline double &MultiChannelBuffer::operator()(const size_t c, const size_t i)
+        {
+            return (order == PLANAR) ? data[c * pitch + i] : data[i * pitch + c];
+        }
+
+        inline const double &MultiChannelBuffer::operator()(const size_t c, const size_t i) const
+        {
+            return (order == PLANAR) ? data[c * pitch + i] : data[i * pitch + c];
+        }
+
+        inline std::vector<double> MultiChannelBuffer::getChannel(const size_t c) const
+        {
+            if (c >= C)
+            {
+                std::cerr << "ERROR: Out of range! [getChannel()]\n";
+                return std::vector<double>();
+            }
+            ChannelView<const double> view = channel(c);
+            std::vector<double> out(N);
+            for (size_t i = 0; i < N; i++)
+            {
+                out[i] = view[i];
+            }
+            return out;
+        }
+
+        inline void MultiChannelBuffer::setChannel(const size_t c, const std::vector<double> &samples)
+        {
+            if (c >= C || samples.size() != N)
+            {
+                std::cerr << "ERROR: Out of range! [setChannel()]\n";
+                return;
+            }
+            ChannelView<double> view = channel(c);
+            for (size_t i = 0; i < N; i++)
+            {
+                view[i] = samples[i];
+            }
+        }
+
+        inline MultiChannelBuffer MultiChannelBuffer::toLayout(const ChannelLayout layout) const
+        {
+            if (layout == order)
+                return *this;
+            MultiChannelBuffer out(C, N, layout);
+            // walk the destination contiguously
+            if (layout == PLANAR)
+            {
+                for (size_t c = 0; c < C; c++)
+                    for (size_t i = 0; i < N; i++)
+                        out.data[c * out.pitch + i] = data[i * pitch + c];
+            }
+            else
+            {
+                for (size_t i = 0; i < N; i++)
+                    for (size_t c = 0; c < C; c++)
+                        out.data[i * out.pitch + c] = data[c * pitch + i];
+            }
+            return out;
+        }
+
+        inline MultiChannelBuffer &MultiChannelBuffer::operator=(const MultiChannelBuffer &B)
+        {
+            if (this == &B) {
+                return *this;
+            }
+            deallocate(this->data);
+            this->C = B.C;
+            this->N = B.N;
+            this->pitch = B.pitch;
+            this->order = B.order;
+            this->data = allocate(storage());
+            if (this->data)
+                std::copy(B.data, B.data + storage(), this->data);
+            return *this;
+        }
+
+        inline MultiChannelBuffer &MultiChannelBuffer::operator=(MultiChannelBuffer &&B)
+        {
+            if (this == &B) {
+                return *this;
+            }
+            // clean up
+            deallocate(this->data);
+
+            // steal data from B
+            this->C = B.C;
+            this->N = B.N;
+            this->pitch = B.pitch;
+            this->order = B.order;
+            this->data = B.data;
+
+            // disconnect B from ownership
+            B.data = nullptr;
+            B.C = 0;
+            B.N = 0;
+            return *this;
+        }
+
+        // MULTICHANNEL KERNELS
+        /*
+        forEachChannelBlock(const size_t C, F&&):
+            Splits [0, C) into ranges of at least one cache line of interleaved channels (8 doubles) and runs
+            body(c0, c1) on them across the global ThreadPool.
+        */
+        template <typename F>
+        void forEachChannelBlock(const size_t C, F &&body)
+        {
+            ThreadPool::global().parallelRange(0, C, [&](size_t c0, size_t c1, size_t) { body(c0, c1); }, 8);
+        }
+
+        inline MultiChannelBuffer lowpassFIR(const MultiChannelBuffer &input, const double alpha)
+        {
+            const size_t C = input.channels(), N = input.samples(), P = input.stride();
+            MultiChannelBuffer output(C, N, input.layout());
+            const double *x = input.rawData();
+            double *y = output.rawData();
+
+            if (input.layout() == PLANAR)
+            {
+                ThreadPool::global().parallelFor(0, C, [&](size_t c, size_t) {
+                    const double *in = x + c * P;
+                    double *out = y + c * P;
+                    double delay0 = 0;
+                    for (size_t i = 0; i < N; i++)
+                    {
+                        out[i] = (alpha * in[i]) + ((1.0 - alpha) * delay0);
+                        delay0 = in[i];
+                    }
+                });
+                return output;
+            }
+
+            // y[n] = a*x[n] + (1-a)*x[n-1] has no recurrence, the previous instant is the delay line
+            forEachChannelBlock(C, [&](size_t c0, size_t c1) {
+                for (size_t c = c0; c < c1; c++)
+                    y[c] = alpha * x[c];
+                for (size_t i = 1; i < N; i++)
+                {
+                    const double *in = x + i * P;
+                    const double *prev = in - P;
+                    double *out = y + i * P;
+                    for (size_t c = c0; c < c1; c++)
+                        out[c] = (alpha * in[c]) + ((1.0 - alpha) * prev[c]);
+                }
+            });
+            return output;
+        }
+
+        inline MultiChannelBuffer movingAvgIIR(const MultiChannelBuffer &input, const double alpha)
+        {
+            const size_t C = input.channels(), N = input.samples(), P = input.stride();
+            MultiChannelBuffer output(C, N, input.layout());
+            const double *x = input.rawData();
+            double *y = output.rawData();
+
+            if (input.layout() == PLANAR)
+            {
+                ThreadPool::global().parallelFor(0, C, [&](size_t c, size_t) {
+                    const double *in = x + c * P;
+                    double *out = y + c * P;
+                    double delay0 = 0;
+                    for (size_t i = 0; i < N; i++)
+                    {
+                        delay0 = (alpha * in[i]) + ((1.0 - alpha) * delay0);
+                        out[i] = delay0;
+                    }
+                });
+                return output;
+            }
+
+            // the recurrence runs along time, so vectorize across channels: y[n-1] is the previous output row
+            forEachChannelBlock(C, [&](size_t c0, size_t c1) {
+                for (size_t c = c0; c < c1; c++)
+                    y[c] = alpha * x[c];
+                for (size_t i = 1; i < N; i++)
+                {
+                    const double *in = x + i * P;
+                    const double *prev = y + (i - 1) * P;
+                    double *out = y + i * P;
+                    for (size_t c = c0; c < c1; c++)
+                        out[c] = (alpha * in[c]) + ((1.0 - alpha) * prev[c]);
+                }
+            });
+            return output;
+        }
+
+        inline std::vector<dcomp> goertzelIIR(const MultiChannelBuffer &input, const int k)
+        {
+            const size_t C = input.channels(), N = input.samples(), P = input.stride();
+            std::vector<dcomp> result(C);
+            const double *x = input.rawData();
+            const double COS = cos(2 * PI * double(k) / double(N));
+            const double SIN = sin(2 * PI * double(k) / double(N));
+
+            // s[N-1] and s[N-2] per channel
+            std::vector<double> s1(C, 0.0), s2(C, 0.0);
+            if (input.layout() == PLANAR)
+            {
+                ThreadPool::global().parallelFor(0, C, [&](size_t c, size_t) {
+                    const double *in = x + c * P;
+                    double drs1 = 0, drs2 = 0;
+                    for (size_t n = 0; n < N; n++)
+                    {
+                        double drs0 = in[n] + (2 * COS * drs1) - drs2;
+                        drs2 = drs1;
+                        drs1 = drs0;
+                    }
+                    s1[c] = drs1;
+                    s2[c] = drs2;
+                });
+            }
+            else
+            {
+                forEachChannelBlock(C, [&](size_t c0, size_t c1) {
+                    double *S1 = s1.data(), *S2 = s2.data();
+                    for (size_t n = 0; n < N; n++)
+                    {
+                        const double *in = x + n * P;
+                        for (size_t c = c0; c < c1; c++)
+                        {
+                            double drs0 = in[c] + (2 * COS * S1[c]) - S2[c];
+                            S2[c] = S1[c];
+                            S1[c] = drs0;
+                        }
+                    }
+                });
+            }
+
+            for (size_t c = 0; c < C; c++)
+            {
+                // s[N] = 2cos()s[N-1] - s[N-2], y[N] = s[N] - cos()s[N-1] + isin()s[N-1]
+                double s_N = 2 * COS * s1[c] - s2[c];
+                result[c] = dcomp(s_N - (COS * s1[c]), SIN * s1[c]);
+            }
+            return result;
+        }
+
+        inline MultiChannelBuffer decimateSignal(const MultiChannelBuffer &signal, const int DECIMATION_FACTOR)
+        {
+            const size_t C = signal.channels(), N = signal.samples();
+            const size_t D = size_t(std::max(DECIMATION_FACTOR, 1));
+            MultiChannelBuffer output(C, (N + D - 1) / D, signal.layout());
+            const size_t M = output.samples();
+
+            if (signal.layout() == PLANAR)
+            {
+                ThreadPool::global().parallelFor(0, C, [&](size_t c, size_t) {
+                    ChannelView<const double> in = signal.channel(c);
+                    ChannelView<double> out = output.channel(c);
+                    for (size_t i = 0; i < M; i++)
+                        out[i] = in[i * D];
+                });
+                return output;
+            }
+            // whole instants are copied, one contiguous row at a time
+            for (size_t i = 0; i < M; i++)
+            {
+                std::copy(signal.rawData() + i * D * signal.stride(), signal.rawData() + i * D * signal.stride() + C,
+                          output.rawData() + i * output.stride());
+            }
+            return output;
+        }
+
+        inline MultiChannelBuffer resample(const MultiChannelBuffer &signal, const int L, const int M)
+        {
+            const size_t C = signal.channels(), N = signal.samples();
+            PolyphaseResampler prototype(L, M);
+            const long long up = prototype.up(), down = prototype.down();
+            const size_t outN = size_t(((long long)N * up + down - 1) / down);
+            MultiChannelBuffer output(C, outN, signal.layout());
+
+            std::vector<std::vector<double>> gathered(ThreadPool::global().size()), results(ThreadPool::global().size());
+            ThreadPool::global().parallelFor(0, C, [&](size_t c, size_t worker) {
+                PolyphaseResampler resampler(prototype);
+                resampler.reset();
+                ChannelView<const double> in = signal.channel(c);
+                const double *src = in.ptr;
+                if (!in.contiguous())
+                {
+                    gathered[worker].resize(N);
+                    for (size_t i = 0; i < N; i++)
+                        gathered[worker][i] = in[i];
+                    src = gathered[worker].data();
+                }
+                results[worker].clear();
+                resampler.process(src, N, results[worker]);
+                ChannelView<double> out = output.channel(c);
+                for (size_t i = 0; i < outN && i < results[worker].size(); i++)
+                    out[i] = results[worker][i];
+            });
+            return output;
+        }
+
+        inline Matrix<dcomp> DFT(const MultiChannelBuffer &x, const std::vector<int> &k_range)
+        {
+            const size_t C = x.channels();
+            Matrix<dcomp> output(C, k_range.size());
+            ThreadPool::global().parallelFor(0, C, [&](size_t c, size_t) {
+                std::vector<dcomp> X = DFT(x.getChannel(c), k_range);
+                std::copy(X.begin(), X.end(), output.rowData(c));
+            });
+            return output;
+        }
+
+        inline Matrix<double> welch(const MultiChannelBuffer &x, const WelchConfig &config)
+        {
+            const size_t C = x.channels();
+            WelchEstimator prototype(config);
+            const size_t bins = prototype.frequencies().size();
+            Matrix<double> output(C, bins);
+            ThreadPool::global().parallelFor(0, C, [&](size_t c, size_t) {
+                // the estimator's own batches run serially inside this task
+                WelchEstimator estimator(config);
+                estimator.push(x.getChannel(c));
+                std::vector<double> P = estimator.psd();
+                std::copy(P.begin(), P.end(), output.rowData(c));
+            });
+            return output;
         }
     }
 
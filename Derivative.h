@@ -1,22 +1,1194 @@
 /*
 Programmer: Connor Fricke (cd.fricke23@gmail.com)
 File: Derivative.h
-Latest Revision: 9-Apr-2025
+Latest Revision: 18-Oct-2026
 Synopsis: Header and implementation file for numerical derivative routines
 */
 
 #ifndef DERIVATIVE_H
 #define DERIVATIVE_H
 
+    #include <algorithm>
+    #include <atomic>
+    #include <cmath>
+    #include <cstdlib>
+    #include <iostream>
+    #include <limits>
+    #include <type_traits>
+    #include <utility>
+    #include <vector>
+    #include "Matrix.h"
+    #include "ThreadPool.h"
+
+    // double and float stencil kernels have AVX2/FMA versions selected at run time on x86 GCC/Clang builds
+    #if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+        #define DERIVATIVE_X86_DISPATCH 1
+        #include <immintrin.h>
+    #else
+        #define DERIVATIVE_X86_DISPATCH 0
+    #endif
 
     // DECLARATIONS
     namespace derivative {
-        
+        /*
+        Finite-difference stencils are generated at compile time with Fornberg's algorithm
+        (B. Fornberg, "Generation of finite difference formulas on arbitrarily spaced grids", 1988).
+        FiniteDifference<Order, Accuracy, Type>::stencil holds the integer offsets and the weights w_k of
+            f^(Order)(x) ~ sum_k w_k f(x + offset_k h) / h^Order,   error O(h^Accuracy)
+        CENTRAL stencils need an even Accuracy and use 2*floor((Order+1)/2) - 1 + Accuracy points,
+        FORWARD and BACKWARD stencils use Order + Accuracy points.
+        */
+        enum StencilType { CENTRAL, FORWARD, BACKWARD };
+
+        template <size_t N>
+        struct Stencil
+        {
+            int offsets[N];
+            double weights[N];
+        };
+
+        // FORNBERG()
+        template <size_t N, int Order>
+        constexpr Stencil<N> fornberg(const double (&x)[N], const double z);
+
+        template <int Order, int Accuracy = 2, StencilType Type = CENTRAL>
+        struct FiniteDifference
+        {
+            static_assert(Order >= 1, "derivative order must be at least 1");
+            static_assert(Accuracy >= 1, "order of accuracy must be at least 1");
+            static_assert(Type != CENTRAL || Accuracy % 2 == 0, "central differences have an even order of accuracy");
+
+            static constexpr size_t points = (Type == CENTRAL) ? size_t(2 * ((Order + 1) / 2) - 1 + Accuracy) : size_t(Order + Accuracy);
+            static constexpr int first = (Type == CENTRAL) ? -int(points - 1) / 2 : ((Type == FORWARD) ? 0 : -int(points - 1));
+            static constexpr Stencil<points> stencil = []() constexpr {
+                double x[points] = {};
+                for (size_t k = 0; k < points; k++)
+                    x[k] = double(first + int(k));
+                Stencil<points> s = fornberg<points, Order>(x, 0.0);
+                for (size_t k = 0; k < points; k++)
+                    s.offsets[k] = first + int(k);
+                return s;
+            }();
+        };
+
+        /*
+        differentiate<Order, Accuracy>(const T* f, T* df, const size_t n, const double h):
+            Derivative of order Order of n uniformly spaced samples f (spacing h) into df.
+            Interior points use the CENTRAL stencil. Points closer to an end than its half-width use the FORWARD
+            or BACKWARD stencil of the same accuracy. The interior runs an AVX2/FMA kernel for double and float
+            (a fixed-length loop over the compile-time stencil otherwise), split across the global ThreadPool for
+            long inputs. T is any type closed under + and * that can be constructed from a double.
+        differentiate<Order, Accuracy>(const std::vector<T>&, const double h)
+        differentiate<Order, Accuracy>(const Vector<T>&, const double h):
+            Same, returning a new container.
+        differentiate<Order, Accuracy>(const Matrix<T>&, const double h, const size_t axis):
+            Along axis 0 (down each column, i.e. d/di) or axis 1 (along each row, d/dj).
+        differentiate<Order, Accuracy>(const std::vector<T>&, const std::vector<double>& x):
+            Non-uniform grid x (strictly increasing). Weights are computed per point by Fornberg's algorithm on the
+            window of FiniteDifference<Order, Accuracy>::points nodes nearest the point, clamped at the ends.
+        */
+        template <int Order = 1, int Accuracy = 2, typename T>
+        void differentiate(const T *f, T *df, const size_t n, const double h);
+        template <int Order = 1, int Accuracy = 2, typename T>
+        std::vector<T> differentiate(const std::vector<T> &f, const double h);
+        template <int Order = 1, int Accuracy = 2, typename T>
+        Vector<T> differentiate(const Vector<T> &f, const double h);
+        template <int Order = 1, int Accuracy = 2, typename T>
+        Matrix<T> differentiate(const Matrix<T> &f, const double h, const size_t axis);
+        template <int Order = 1, int Accuracy = 2, typename T>
+        std::vector<T> differentiate(const std::vector<T> &f, const std::vector<double> &x);
+
+        /*
+        Dual<T, N>:
+            Forward-mode automatic differentiation number: a value together with its derivatives along N
+            independent tangent directions, value + sum_k tangent[k] eps_k with eps_j eps_k = 0.
+            Carrying N directions at once gives N columns of a Jacobian from a single evaluation pass. The
+            fixed-length tangent loops vectorize.
+            Dual(v) is a constant and Dual(v, k) is an input variable seeded along direction k. Arithmetic with Dual
+            and with plain T values is supported, as are the usual <cmath> functions found by argument-dependent
+            lookup. Generic code should call them unqualified (using std::sin; sin(x)).
+            Comparisons look at the value only. Dual is default and zero constructible, so it can be the element type
+            of Vector<T> and Matrix<T>, and it can be the value type of integrands passed to integral::trapezoidal and
+            integral::simpsons.
+        */
+        template <typename T, size_t N = 1>
+        class Dual
+        {
+        public:
+            typedef T value_type;
+            static const size_t directions = N;
+
+            T value;
+            T tangent[N];
+
+        // CONSTRUCTORS
+            Dual();                                             // zero
+            Dual(const T &value);                               // constant
+            Dual(const T &value, const size_t direction);       // variable with a unit tangent along direction
+        // ACCESSORS
+            const T &derivative(const size_t direction = 0) const;
+        // OPERATORS
+            Dual &operator+=(const Dual &other);
+            Dual &operator-=(const Dual &other);
+            Dual &operator*=(const Dual &other);
+            Dual &operator/=(const Dual &other);
+            Dual &operator+=(const T &other);
+            Dual &operator-=(const T &other);
+            Dual &operator*=(const T &other);
+            Dual &operator/=(const T &other);
+        };
+
+        /*
+        gradient<N>(F, const std::vector<double>& x):
+            Exact gradient of a scalar function at x by forward-mode differentiation. func is called with a
+            const std::vector<Dual<double, N>>& (write it as a generic lambda) and returns Dual<double, N>.
+            The n inputs are seeded N at a time, so the gradient costs ceil(n / N) evaluation passes.
+        */
+        template <size_t N = 8, typename F>
+        std::vector<double> gradient(F func, const std::vector<double> &x);
+
+        /*
+        SparsityPattern:
+            Positions of the structural nonzeros of an m x n matrix in compressed sparse row form: the column
+            indices of row i are columns[rowStart[i] .. rowStart[i + 1]), sorted ascending.
+            Built from (row, column) pairs, duplicates are merged.
+        SparseMatrix<T>:
+            A SparsityPattern together with one value per nonzero, in the same order.
+        */
+        struct SparsityPattern
+        {
+            size_t rows = 0, cols = 0;
+            std::vector<size_t> rowStart;
+            std::vector<size_t> columns;
+
+            SparsityPattern() = default;
+            SparsityPattern(const size_t rows, const size_t cols, std::vector<std::pair<size_t, size_t>> entries);
+            size_t nonzeros() const;
+        };
+
+        template <typename T>
+        struct SparseMatrix
+        {
+            SparsityPattern pattern;
+            std::vector<T> values;
+
+            T at(const size_t i, const size_t j) const;         // zero outside the pattern
+            Matrix<T> toDense() const;
+        };
+
+        /*
+        colorColumns(const SparsityPattern&, size_t& numColors):
+            Greedy distance-2 column coloring, largest degree first: columns that share a row never share a
+            color, so all columns of one color can be perturbed in a single evaluation. Returns the color of
+            every column and the number of colors used (at least the largest number of nonzeros in a row).
+        */
+        std::vector<size_t> colorColumns(const SparsityPattern &pattern, size_t &numColors);
+
+        /*
+        JacobianOptions:
+            central: central differences (two evaluations per column or color, error O(h^2)) instead of forward
+                differences (one evaluation, error O(h))
+            step: relative step, h_j = step * max(1, |x_j|). 0 selects sqrt(eps) for forward and cbrt(eps) for central
+            parallel: evaluate columns or colors on the global ThreadPool (func must then be safe to call concurrently)
+        */
+        struct JacobianOptions
+        {
+            bool central = true;
+            double step = 0.0;
+            bool parallel = true;
+        };
+
+        /*
+        jacobian(F, const std::vector<double>& x, const JacobianOptions&):
+            Dense m x n finite-difference Jacobian J(i, j) = d f_i / d x_j of func(const std::vector<double>&) -> std::vector<double>.
+        jacobian(F, const std::vector<double>& x, const SparsityPattern&, const JacobianOptions&):
+            Sparse Jacobian on the given pattern. Columns are grouped by colorColumns(), so it costs one (or two)
+            evaluations per color instead of per column.
+        jacobianDual<N>(F, const std::vector<double>& x):
+        jacobianDual<N>(F, const std::vector<double>& x, const SparsityPattern&):
+            Exact Jacobians by forward-mode differentiation. func is called with a const std::vector<Dual<double, N>>&
+            (write it as a generic lambda) and returns a std::vector<Dual<double, N>>. Each pass seeds N columns,
+            or N colors in the sparse case.
+        All variants evaluate their columns, colors or passes in parallel. func must return the same number of
+        outputs (pattern.rows for the sparse variants) at every point; otherwise an error is printed and the
+        Jacobian is returned all zero.
+        */
+        template <typename F>
+        Matrix<double> jacobian(F func, const std::vector<double> &x, const JacobianOptions &options = JacobianOptions());
+        template <typename F>
+        SparseMatrix<double> jacobian(F func, const std::vector<double> &x, const SparsityPattern &pattern, const JacobianOptions &options = JacobianOptions());
+        template <size_t N = 8, typename F>
+        Matrix<double> jacobianDual(F func, const std::vector<double> &x);
+        template <size_t N = 8, typename F>
+        SparseMatrix<double> jacobianDual(F func, const std::vector<double> &x, const SparsityPattern &pattern);
     }
 
     // DEFINITIONS
     namespace derivative {
 
+        // FORNBERG()
+        template <size_t N, int Order>
+        constexpr Stencil<N> fornberg(const double (&x)[N], const double z)
+        {
+            // c[i][m]: weight of node i for the m-th derivative, built up one node at a time
+            double c[N][Order + 1] = {};
+            double c1 = 1.0;
+            double c4 = x[0] - z;
+            c[0][0] = 1.0;
+            for (size_t i = 1; i < N; i++)
+            {
+                const int mn = (int(i) < Order) ? int(i) : Order;
+                double c2 = 1.0;
+                const double c5 = c4;
+                c4 = x[i] - z;
+                for (size_t j = 0; j < i; j++)
+                {
+                    const double c3 = x[i] - x[j];
+                    c2 *= c3;
+                    if (j == i - 1)
+                    {
+                        for (int k = mn; k >= 1; k--)
+                            c[i][k] = c1 * (double(k) * c[i - 1][k - 1] - c5 * c[i - 1][k]) / c2;
+                        c[i][0] = -c1 * c5 * c[i - 1][0] / c2;
+                    }
+                    for (int k = mn; k >= 1; k--)
+                        c[j][k] = (c4 * c[j][k] - double(k) * c[j][k - 1]) / c3;
+                    c[j][0] = c4 * c[j][0] / c3;
+                }
+                c1 = c2;
+            }
+
+            Stencil<N> s = {};
+            for (size_t i = 0; i < N; i++)
+                s.weights[i] = c[i][Order];
+            return s;
+        }
+
+    #if DERIVATIVE_X86_DISPATCH
+        inline bool hasAVX2FMA()
+        {
+            static const bool available = []() {
+                __builtin_cpu_init();
+                return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+            }();
+            return available;
+        }
+
+        // interior kernels: 8 (double) or 16 (float) outputs per iteration, returns the first point not written
+        template <typename S>
+        __attribute__((target("avx2,fma"))) size_t applyStencilAVX2(const double *f, double *df, const size_t lo, const size_t hi, const double scale)
+        {
+            constexpr size_t N = S::points;
+            __m256d w[N];
+            for (size_t k = 0; k < N; k++)
+                w[k] = _mm256_set1_pd(S::stencil.weights[k] * scale);
+            size_t i = lo;
+            for (; i + 8 <= hi; i += 8)
+            {
+                const double *p = f + i;
+                __m256d acc0 = _mm256_mul_pd(w[0], _mm256_loadu_pd(p + S::stencil.offsets[0]));
+                __m256d acc1 = _mm256_mul_pd(w[0], _mm256_loadu_pd(p + S::stencil.offsets[0] + 4));
+                for (size_t k = 1; k < N; k++)
+                {
+                    acc0 = _mm256_fmadd_pd(w[k], _mm256_loadu_pd(p + S::stencil.offsets[k]), acc0);
+                    acc1 = _mm256_fmadd_pd(w[k], _mm256_loadu_pd(p + S::stencil.offsets[k] + 4), acc1);
+                }
+                _mm256_storeu_pd(df + i, acc0);
+                _mm256_storeu_pd(df + i + 4, acc1);
+            }
+            return i;
+        }
+
+        template <typename S>
+        __attribute__((target("avx2,fma"))) size_t applyStencilAVX2(const float *f, float *df, const size_t lo, const size_t hi, const double scale)
+        {
+            constexpr size_t N = S::points;
+            __m256 w[N];
+            for (size_t k = 0; k < N; k++)
+                w[k] = _mm256_set1_ps(float(S::stencil.weights[k] * scale));
+            size_t i = lo;
+            for (; i + 16 <= hi; i += 16)
+            {
+                const float *p = f + i;
+                __m256 acc0 = _mm256_mul_ps(w[0], _mm256_loadu_ps(p + S::stencil.offsets[0]));
+                __m256 acc1 = _mm256_mul_ps(w[0], _mm256_loadu_ps(p + S::stencil.offsets[0] + 8));
+                for (size_t k = 1; k < N; k++)
+                {
+                    acc0 = _mm256_fmadd_ps(w[k], _mm256_loadu_ps(p + S::stencil.offsets[k]), acc0);
+                    acc1 = _mm256_fmadd_ps(w[k], _mm256_loadu_ps(p + S::stencil.offsets[k] + 8), acc1);
+                }
+                _mm256_storeu_ps(df + i, acc0);
+                _mm256_storeu_ps(df + i + 8, acc1);
+            }
+            return i;
+        }
+    #endif
+
+        // applies stencil S to the points [lo, hi) of f, all of which must have the full stencil inside the data
+        template <typename S, typename T>
+        void applyStencil(const T *f, T *df, size_t lo, const size_t hi, const double scale)
+        {
+            constexpr size_t N = S::points;
+        #if DERIVATIVE_X86_DISPATCH
+            if constexpr (std::is_same<T, double>::value || std::is_same<T, float>::value)
+            {
+                if (hasAVX2FMA())
+                    lo = applyStencilAVX2<S>(f, df, lo, hi, scale);
+            }
+        #endif
+            T w[N];
+            for (size_t k = 0; k < N; k++)
+                w[k] = T(S::stencil.weights[k] * scale);
+            for (size_t i = lo; i < hi; i++)
+            {
+                const T *p = f + i;
+                T acc = w[0] * p[S::stencil.offsets[0]];
+                for (size_t k = 1; k < N; k++)
+                    acc += w[k] * p[S::stencil.offsets[k]];
+                df[i] = acc;
+            }
+        }
+
+        // same, for whole rows of a row-major block with row length J: output row i from rows i + offset
+        template <typename S, typename T>
+        void applyStencilRows(const T *f, T *df, const size_t J, const size_t lo, const size_t hi, const double scale)
+        {
+            constexpr size_t N = S::points;
+            T w[N];
+            for (size_t k = 0; k < N; k++)
+                w[k] = T(S::stencil.weights[k] * scale);
+            for (size_t i = lo; i < hi; i++)
+            {
+                T *out = df + i * J;
+                const T *first = f + std::ptrdiff_t(i) * std::ptrdiff_t(J) + S::stencil.offsets[0] * std::ptrdiff_t(J);
+                for (size_t j = 0; j < J; j++)
+                    out[j] = w[0] * first[j];
+                for (size_t k = 1; k < N; k++)
+                {
+                    const T *row = f + std::ptrdiff_t(i) * std::ptrdiff_t(J) + S::stencil.offsets[k] * std::ptrdiff_t(J);
+                    for (size_t j = 0; j < J; j++)
+                        out[j] += w[k] * row[j];
+                }
+            }
+        }
+
+        inline double stencilScale(const double h, const int order)
+        {
+            double scale = 1.0;
+            for (int k = 0; k < order; k++)
+                scale /= h;
+            return scale;
+        }
+
+        // DIFFERENTIATE()
+        template <int Order, int Accuracy, typename T>
+        void differentiate(const T *f, T *df, const size_t n, const double h)
+        {
+            typedef FiniteDifference<Order, Accuracy, CENTRAL> Central;
+            typedef FiniteDifference<Order, Accuracy, FORWARD> Forward;
+            typedef FiniteDifference<Order, Accuracy, BACKWARD> Backward;
+            if (n < std::max(Central::points, Forward::points))
+            {
+                std::cerr << "ERROR: Too few samples for the requested stencil [differentiate()]\n";
+                return;
+            }
+            const double scale = stencilScale(h, Order);
+            const size_t half = (Central::points - 1) / 2;
+
+            applyStencil<Forward>(f, df, 0, half, scale);
+            applyStencil<Backward>(f, df, n - half, n, scale);
+            ThreadPool::global().parallelRange(half, n - half, [&](size_t lo, size_t hi, size_t) {
+                applyStencil<Central>(f, df, lo, hi, scale);
+            }, size_t(1) << 15);
+        }
+
+        template <int Order, int Accuracy, typename T>
+        std::vector<T> differentiate(const std::vector<T> &f, const double h)
+        {
+            std::vector<T> df(f.size());
+            differentiate<Order, Accuracy>(f.data(), df.data(), f.size(), h);
+            return df;
+        }
+
+        template <int Order, int Accuracy, typename T>
+        Vector<T> differentiate(const Vector<T> &f, const double h)
+        {
+            Vector<T> df(f.size(), f.row());
+            differentiate<Order, Accuracy>(f.rawData(), df.rawData(), f.size(), h);
+            return df;
+        }
+
+        template <int Order, int Accuracy, typename T>
+        Matrix<T> differentiate(const Matrix<T> &f, const double h, const size_t axis)
+        {
+            typedef FiniteDifference<Order, Accuracy, CENTRAL> Central;
+            typedef FiniteDifference<Order, Accuracy, FORWARD> Forward;
+            typedef FiniteDifference<Order, Accuracy, BACKWARD> Backward;
+            const size_t I = f.rows(), J = f.cols();
+            Matrix<T> df(I, J);
+            if (axis > 1)
+            {
+                std::cerr << "ERROR: Axis must be 0 or 1 [differentiate()]\n";
+                return df;
+            }
+
+            if (axis == 1)
+            {
+                // each row is an independent contiguous signal
+                ThreadPool::global().parallelFor(0, I, [&](size_t i, size_t) {
+                    differentiate<Order, Accuracy>(f.rowData(i), df.rowData(i), J, h);
+                });
+                return df;
+            }
+
+            // down the columns: combine whole rows so the inner loop stays contiguous
+            if (I < std::max(Central::points, Forward::points))
+            {
+                std::cerr << "ERROR: Too few samples for the requested stencil [differentiate()]\n";
+                return df;
+            }
+            const double scale = stencilScale(h, Order);
+            const size_t half = (Central::points - 1) / 2;
+            const T *in = f.rawData();
+            T *out = df.rawData();
+            applyStencilRows<Forward>(in, out, J, 0, half, scale);
+            applyStencilRows<Backward>(in, out, J, I - half, I, scale);
+            ThreadPool::global().parallelRange(half, I - half, [&](size_t lo, size_t hi, size_t) {
+                applyStencilRows<Central>(in, out, J, lo, hi, scale);
+            });
+            return df;
+        }
+
+        template <int Order, int Accuracy, typename T>
+        std::vector<T> differentiate(const std::vector<T> &f, const std::vector<double> &x)
+        {
+            constexpr size_t N = FiniteDifference<Order, Accuracy, CENTRAL>::points;
+            const size_t n = f.size();
+            std::vector<T> df(n);
+            if (x.size() != n)
+            {
+                std::cerr << "ERROR: Grid and samples differ in length [differentiate()]\n";
+                return df;
+            }
+            if (n < N)
+            {
+                std::cerr << "ERROR: Too few samples for the requested stencil [differentiate()]\n";
+                return df;
+            }
+
+            ThreadPool::global().parallelRange(0, n, [&](size_t lo, size_t hi, size_t) {
+                double nodes[N];
+                for (size_t i = lo; i < hi; i++)
+                {
+                    // window of N nodes around i, shifted inward at the ends
+                    const size_t start = std::min(n - N, (i > (N - 1) / 2) ? i - (N - 1) / 2 : size_t(0));
+                    for (size_t k = 0; k < N; k++)
+                        nodes[k] = x[start + k];
+                    const Stencil<N> s = fornberg<N, Order>(nodes, x[i]);
+                    T acc = T(s.weights[0]) * f[start];
+                    for (size_t k = 1; k < N; k++)
+                        acc += T(s.weights[k]) * f[start + k];
+                    df[i] = acc;
+                }
+            }, 1024);
+            return df;
+        }
+
+        // DUAL
+        template <typename T, size_t N>
+        Dual<T, N>::Dual() : value(0)
+        {
+            for (size_t k = 0; k < N; k++)
+                tangent[k] = T(0);
+        }
+
+        template <typename T, size_t N>
+        Dual<T, N>::Dual(const T &value) : value(value)
+        {
+            for (size_t k = 0; k < N; k++)
+                tangent[k] = T(0);
+        }
+
+        template <typename T, size_t N>
+        Dual<T, N>::Dual(const T &value, const size_t direction) : value(value)
+        {
+            if (direction >= N)
+                std::cerr << "ERROR: Tangent direction out of range [Dual()]\n";
+            for (size_t k = 0; k < N; k++)
+                tangent[k] = T(k == direction ? 1 : 0);
+        }
+
+        template <typename T, size_t N>
+        const T &Dual<T, N>::derivative(const size_t direction) const
+        {
+            if (direction >= N)
+            {
+                std::cerr << "ERROR: Tangent direction out of range [derivative()]\n";
+                return tangent[0];
+            }
+            return tangent[direction];
+        }
+
+        template <typename T, size_t N>
+        Dual<T, N> &Dual<T, N>::operator+=(const Dual &other)
+        {
+            value += other.value;
+            for (size_t k = 0; k < N; k++)
+                tangent[k] += other.tangent[k];
+            return *this;
+        }
+
+        template <typename T, size_t N>
+        Dual<T, N> &Dual<T, N>::operator-=(const Dual &other)
+        {
+            value -= other.value;
+            for (size_t k = 0; k < N; k++)
+                tangent[k] -= other.tangent[k];
+            return *this;
+        }
+
+        template <typename T, size_t N>
+        Dual<T, N> &Dual<T, N>::operator*=(const Dual &other)
+        {
+            // (a + a'e)(b + b'e) = ab + (a'b + ab')e
+            for (size_t k = 0; k < N; k++)
+                tangent[k] = tangent[k] * other.value + value * other.tangent[k];
+            value *= other.value;
+            return *this;
+        }
+
+        template <typename T, size_t N>
+        Dual<T, N> &Dual<T, N>::operator/=(const Dual &other)
+        {
+            // (a/b)' = (a' - (a/b) b') / b
+            const T inverse = T(1) / other.value;
+            value *= inverse;
+            for (size_t k = 0; k < N; k++)
+                tangent[k] = (tangent[k] - value * other.tangent[k]) * inverse;
+            return *this;
+        }
+
+        template <typename T, size_t N>
+        Dual<T, N> &Dual<T, N>::operator+=(const T &other)
+        {
+            value += other;
+            return *this;
+        }
+
+        template <typename T, size_t N>
+        Dual<T, N> &Dual<T, N>::operator-=(const T &other)
+        {
+            value -= other;
+            return *this;
+        }
+
+        template <typename T, size_t N>
+        Dual<T, N> &Dual<T, N>::operator*=(const T &other)
+        {
+            value *= other;
+            for (size_t k = 0; k < N; k++)
+                tangent[k] *= other;
+            return *this;
+        }
+
+        template <typename T, size_t N>
+        Dual<T, N> &Dual<T, N>::operator/=(const T &other)
+        {
+            const T inverse = T(1) / other;
+            value *= inverse;
+            for (size_t k = 0; k < N; k++)
+                tangent[k] *= inverse;
+            return *this;
+        }
+
+        // ARITHMETIC (the scalar argument is not deduced, so dual * 2 or 1.0 / dual work as expected)
+        template <typename T, size_t N>
+        Dual<T, N> operator+(Dual<T, N> a, const Dual<T, N> &b) { return a += b; }
+        template <typename T, size_t N>
+        Dual<T, N> operator+(Dual<T, N> a, const typename Dual<T, N>::value_type &b) { return a += b; }
+        template <typename T, size_t N>
+        Dual<T, N> operator+(const typename Dual<T, N>::value_type &a, Dual<T, N> b) { return b += a; }
+
+        template <typename T, size_t N>
+        Dual<T, N> operator-(Dual<T, N> a, const Dual<T, N> &b) { return a -= b; }
+        template <typename T, size_t N>
+        Dual<T, N> operator-(Dual<T, N> a, const typename Dual<T, N>::value_type &b) { return a -= b; }
+        template <typename T, size_t N>
+        Dual<T, N> operator-(const typename Dual<T, N>::value_type &a, const Dual<T, N> &b) { return Dual<T, N>(a) -= b; }
+
+        template <typename T, size_t N>
+        Dual<T, N> operator*(Dual<T, N> a, const Dual<T, N> &b) { return a *= b; }
+        template <typename T, size_t N>
+        Dual<T, N> operator*(Dual<T, N> a, const typename Dual<T, N>::value_type &b) { return a *= b; }
+        template <typename T, size_t N>
+        Dual<T, N> operator*(const typename Dual<T, N>::value_type &a, Dual<T, N> b) { return b *= a; }
+
+        template <typename T, size_t N>
+        Dual<T, N> operator/(Dual<T, N> a, const Dual<T, N> &b) { return a /= b; }
+        template <typename T, size_t N>
+        Dual<T, N> operator/(Dual<T, N> a, const typename Dual<T, N>::value_type &b) { return a /= b; }
+        template <typename T, size_t N>
+        Dual<T, N> operator/(const typename Dual<T, N>::value_type &a, const Dual<T, N> &b) { return Dual<T, N>(a) /= b; }
+
+        template <typename T, size_t N>
+        Dual<T, N> operator-(Dual<T, N> a)
+        {
+            a.value = -a.value;
+            for (size_t k = 0; k < N; k++)
+                a.tangent[k] = -a.tangent[k];
+            return a;
+        }
+
+        template <typename T, size_t N>
+        Dual<T, N> operator+(const Dual<T, N> &a) { return a; }
+
+        // COMPARISONS (value only)
+        template <typename T, size_t N>
+        bool operator==(const Dual<T, N> &a, const Dual<T, N> &b) { return a.value == b.value; }
+        template <typename T, size_t N>
+        bool operator!=(const Dual<T, N> &a, const Dual<T, N> &b) { return a.value != b.value; }
+        template <typename T, size_t N>
+        bool operator<(const Dual<T, N> &a, const Dual<T, N> &b) { return a.value < b.value; }
+        template <typename T, size_t N>
+        bool operator<=(const Dual<T, N> &a, const Dual<T, N> &b) { return a.value <= b.value; }
+        template <typename T, size_t N>
+        bool operator>(const Dual<T, N> &a, const Dual<T, N> &b) { return a.value > b.value; }
+        template <typename T, size_t N>
+        bool operator>=(const Dual<T, N> &a, const Dual<T, N> &b) { return a.value >= b.value; }
+        template <typename T, size_t N>
+        bool operator==(const Dual<T, N> &a, const typename Dual<T, N>::value_type &b) { return a.value == b; }
+        template <typename T, size_t N>
+        bool operator!=(const Dual<T, N> &a, const typename Dual<T, N>::value_type &b) { return a.value != b; }
+        template <typename T, size_t N>
+        bool operator<(const Dual<T, N> &a, const typename Dual<T, N>::value_type &b) { return a.value < b; }
+        template <typename T, size_t N>
+        bool operator<=(const Dual<T, N> &a, const typename Dual<T, N>::value_type &b) { return a.value <= b; }
+        template <typename T, size_t N>
+        bool operator>(const Dual<T, N> &a, const typename Dual<T, N>::value_type &b) { return a.value > b; }
+        template <typename T, size_t N>
+        bool operator>=(const Dual<T, N> &a, const typename Dual<T, N>::value_type &b) { return a.value >= b; }
+        template <typename T, size_t N>
+        bool operator==(const typename Dual<T, N>::value_type &a, const Dual<T, N> &b) { return a == b.value; }
+        template <typename T, size_t N>
+        bool operator!=(const typename Dual<T, N>::value_type &a, const Dual<T, N> &b) { return a != b.value; }
+        template <typename T, size_t N>
+        bool operator<(const typename Dual<T, N>::value_type &a, const Dual<T, N> &b) { return a < b.value; }
+        template <typename T, size_t N>
+        bool operator<=(const typename Dual<T, N>::value_type &a, const Dual<T, N> &b) { return a <= b.value; }
+        template <typename T, size_t N>
+        bool operator>(const typename Dual<T, N>::value_type &a, const Dual<T, N> &b) { return a > b.value; }
+        template <typename T, size_t N>
+        bool operator>=(const typename Dual<T, N>::value_type &a, const Dual<T, N> &b) { return a >= b.value; }
+
+        template <typename T, size_t N>
+        std::ostream &operator<<(std::ostream &out, const Dual<T, N> &a)
+        {
+            out << a.value << " + [";
+            for (size_t k = 0; k < N; k++)
+                out << a.tangent[k] << ((k + 1 < N) ? ", " : "");
+            out << "]e";
+            return out;
+        }
+
+        // ELEMENTARY FUNCTIONS: f(a + a'e) = f(a) + f'(a) a'e
+        template <typename T, size_t N>
+        Dual<T, N> chain(const Dual<T, N> &a, const T &value, const T &slope)
+        {
+            Dual<T, N> result(value);
+            for (size_t k = 0; k < N; k++)
+                result.tangent[k] = slope * a.tangent[k];
+            return result;
+        }
+
+        template <typename T, size_t N>
+        Dual<T, N> sin(const Dual<T, N> &a) { using std::sin; using std::cos; return chain(a, sin(a.value), cos(a.value)); }
+        template <typename T, size_t N>
+        Dual<T, N> cos(const Dual<T, N> &a) { using std::sin; using std::cos; return chain(a, cos(a.value), -sin(a.value)); }
+        template <typename T, size_t N>
+        Dual<T, N> tan(const Dual<T, N> &a)
+        {
+            using std::tan;
+            const T t = tan(a.value);
+            return chain(a, t, T(1) + t * t);
+        }
+        template <typename T, size_t N>
+        Dual<T, N> asin(const Dual<T, N> &a) { using std::asin; using std::sqrt; return chain(a, asin(a.value), T(1) / sqrt(T(1) - a.value * a.value)); }
+        template <typename T, size_t N>
+        Dual<T, N> acos(const Dual<T, N> &a) { using std::acos; using std::sqrt; return chain(a, acos(a.value), -T(1) / sqrt(T(1) - a.value * a.value)); }
+        template <typename T, size_t N>
+        Dual<T, N> atan(const Dual<T, N> &a) { using std::atan; return chain(a, atan(a.value), T(1) / (T(1) + a.value * a.value)); }
+        template <typename T, size_t N>
+        Dual<T, N> atan2(const Dual<T, N> &y, const Dual<T, N> &x)
+        {
+            using std::atan2;
+            // d atan2(y, x) = (x dy - y dx) / (x^2 + y^2)
+            const T inverse = T(1) / (x.value * x.value + y.value * y.value);
+            Dual<T, N> result(atan2(y.value, x.value));
+            for (size_t k = 0; k < N; k++)
+                result.tangent[k] = (x.value * y.tangent[k] - y.value * x.tangent[k]) * inverse;
+            return result;
+        }
+        template <typename T, size_t N>
+        Dual<T, N> sinh(const Dual<T, N> &a) { using std::sinh; using std::cosh; return chain(a, sinh(a.value), cosh(a.value)); }
+        template <typename T, size_t N>
+        Dual<T, N> cosh(const Dual<T, N> &a) { using std::sinh; using std::cosh; return chain(a, cosh(a.value), sinh(a.value)); }
+        template <typename T, size_t N>
+        Dual<T, N> tanh(const Dual<T, N> &a)
+        {
+            using std::tanh;
+            const T t = tanh(a.value);
+            return chain(a, t, T(1) - t * t);
+        }
+        template <typename T, size_t N>
+        Dual<T, N> exp(const Dual<T, N> &a)
+        {
+            using std::exp;
+            const T e = exp(a.value);
+            return chain(a, e, e);
+        }
+        template <typename T, size_t N>
+        Dual<T, N> log(const Dual<T, N> &a) { using std::log; return chain(a, log(a.value), T(1) / a.value); }
+        template <typename T, size_t N>
+        Dual<T, N> log10(const Dual<T, N> &a) { using std::log; using std::log10; return chain(a, log10(a.value), T(1) / (a.value * log(T(10)))); }
+        template <typename T, size_t N>
+        Dual<T, N> sqrt(const Dual<T, N> &a)
+        {
+            using std::sqrt;
+            const T s = sqrt(a.value);
+            return chain(a, s, T(0.5) / s);
+        }
+        template <typename T, size_t N>
+        Dual<T, N> cbrt(const Dual<T, N> &a)
+        {
+            using std::cbrt;
+            const T c = cbrt(a.value);
+            return chain(a, c, T(1) / (T(3) * c * c));
+        }
+        template <typename T, size_t N>
+        Dual<T, N> abs(const Dual<T, N> &a) { return (a.value < T(0)) ? -a : a; }
+        template <typename T, size_t N>
+        Dual<T, N> fabs(const Dual<T, N> &a) { return abs(a); }
+        template <typename T, size_t N>
+        Dual<T, N> erf(const Dual<T, N> &a)
+        {
+            using std::erf;
+            using std::exp;
+            const T twoOverSqrtPi = T(1.1283791670955125739);
+            return chain(a, erf(a.value), twoOverSqrtPi * exp(-a.value * a.value));
+        }
+        template <typename T, size_t N>
+        Dual<T, N> pow(const Dual<T, N> &a, const typename Dual<T, N>::value_type &p)
+        {
+            using std::pow;
+            return chain(a, pow(a.value, p), p * pow(a.value, p - T(1)));
+        }
+        template <typename T, size_t N>
+        Dual<T, N> pow(const typename Dual<T, N>::value_type &base, const Dual<T, N> &p)
+        {
+            using std::log;
+            using std::pow;
+            const T value = pow(base, p.value);
+            return chain(p, value, value * log(base));
+        }
+        template <typename T, size_t N>
+        Dual<T, N> pow(const Dual<T, N> &a, const Dual<T, N> &p)
+        {
+            // a^p = exp(p log a)
+            return exp(p * log(a));
+        }
+        template <typename T, size_t N>
+        Dual<T, N> hypot(const Dual<T, N> &x, const Dual<T, N> &y)
+        {
+            using std::hypot;
+            const T h = hypot(x.value, y.value);
+            Dual<T, N> result(h);
+            const T inverse = (h > T(0)) ? T(1) / h : T(0);
+            for (size_t k = 0; k < N; k++)
+                result.tangent[k] = (x.value * x.tangent[k] + y.value * y.tangent[k]) * inverse;
+            return result;
+        }
+
+        // GRADIENT()
+        template <size_t N, typename F>
+        std::vector<double> gradient(F func, const std::vector<double> &x)
+        {
+            const size_t n = x.size();
+            std::vector<double> grad(n, 0.0);
+            std::vector<Dual<double, N>> point(n);
+            for (size_t i = 0; i < n; i++)
+                point[i] = Dual<double, N>(x[i]);
+
+            // seed N inputs per pass, one direction each
+            for (size_t start = 0; start < n; start += N)
+            {
+                const size_t count = std::min(N, n - start);
+                for (size_t k = 0; k < count; k++)
+                    point[start + k].tangent[k] = 1.0;
+                const Dual<double, N> result = func(static_cast<const std::vector<Dual<double, N>> &>(point));
+                for (size_t k = 0; k < count; k++)
+                {
+                    grad[start + k] = result.tangent[k];
+                    point[start + k].tangent[k] = 0.0;
+                }
+            }
+            return grad;
+        }
+
+        // SPARSITY
+        inline SparsityPattern::SparsityPattern(const size_t rows, const size_t cols, std::vector<std::pair<size_t, size_t>> entries)
+            : rows(rows), cols(cols)
+        {
+            std::sort(entries.begin(), entries.end());
+            entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+            rowStart.assign(rows + 1, 0);
+            columns.reserve(entries.size());
+            for (const std::pair<size_t, size_t> &e : entries)
+            {
+                if (e.first >= rows || e.second >= cols)
+                {
+                    std::cerr << "ERROR: Entry outside the matrix ignored [SparsityPattern()]\n";
+                    continue;
+                }
+                rowStart[e.first + 1]++;
+                columns.push_back(e.second);
+            }
+            for (size_t i = 0; i < rows; i++)
+                rowStart[i + 1] += rowStart[i];
+        }
+
+        inline size_t SparsityPattern::nonzeros() const
+        {
+            return columns.size();
+        }
+
+        template <typename T>
+        T SparseMatrix<T>::at(const size_t i, const size_t j) const
+        {
+            if (i >= pattern.rows || j >= pattern.cols)
+            {
+                std::cerr << "ERROR: Out of range [at()]\n";
+                return T(0);
+            }
+            const auto first = pattern.columns.begin() + std::ptrdiff_t(pattern.rowStart[i]);
+            const auto last = pattern.columns.begin() + std::ptrdiff_t(pattern.rowStart[i + 1]);
+            const auto found = std::lower_bound(first, last, j);
+            if (found == last || *found != j)
+                return T(0);
+            return values[size_t(found - pattern.columns.begin())];
+        }
+
+        template <typename T>
+        Matrix<T> SparseMatrix<T>::toDense() const
+        {
+            Matrix<T> dense(pattern.rows, pattern.cols);
+            for (size_t i = 0; i < pattern.rows; i++)
+                for (size_t k = pattern.rowStart[i]; k < pattern.rowStart[i + 1]; k++)
+                    dense.rowData(i)[pattern.columns[k]] = values[k];
+            return dense;
+        }
+
+        // column-major view of a pattern: rows of column j are rowIndex[colStart[j] .. colStart[j + 1]),
+        // entry[] gives the position of each of them in the row-major value array
+        struct ColumnIndex
+        {
+            std::vector<size_t> colStart, rowIndex, entry;
+
+            explicit ColumnIndex(const SparsityPattern &pattern)
+            {
+                colStart.assign(pattern.cols + 1, 0);
+                for (size_t c : pattern.columns)
+                    colStart[c + 1]++;
+                for (size_t j = 0; j < pattern.cols; j++)
+                    colStart[j + 1] += colStart[j];
+                rowIndex.resize(pattern.nonzeros());
+                entry.resize(pattern.nonzeros());
+                std::vector<size_t> fill(colStart.begin(), colStart.end() - 1);
+                for (size_t i = 0; i < pattern.rows; i++)
+                {
+                    for (size_t k = pattern.rowStart[i]; k < pattern.rowStart[i + 1]; k++)
+                    {
+                        const size_t slot = fill[pattern.columns[k]]++;
+                        rowIndex[slot] = i;
+                        entry[slot] = k;
+                    }
+                }
+            }
+        };
+
+        inline std::vector<size_t> colorColumns(const SparsityPattern &pattern, size_t &numColors)
+        {
+            const size_t n = pattern.cols;
+            const ColumnIndex byColumn(pattern);
+            std::vector<size_t> order(n);
+            for (size_t j = 0; j < n; j++)
+                order[j] = j;
+            // largest degree first, ties by index so the coloring is deterministic
+            std::stable_sort(order.begin(), order.end(), [&](size_t p, size_t q) {
+                return byColumn.colStart[p + 1] - byColumn.colStart[p] > byColumn.colStart[q + 1] - byColumn.colStart[q];
+            });
+
+            const size_t none = size_t(-1);
+            std::vector<size_t> color(n, none), forbidden;
+            numColors = 0;
+            for (size_t column : order)
+            {
+                // colors of every column that shares a row with this one are marked with its index
+                for (size_t s = byColumn.colStart[column]; s < byColumn.colStart[column + 1]; s++)
+                {
+                    const size_t i = byColumn.rowIndex[s];
+                    for (size_t k = pattern.rowStart[i]; k < pattern.rowStart[i + 1]; k++)
+                    {
+                        const size_t c = color[pattern.columns[k]];
+                        if (c != none)
+                            forbidden[c] = column;
+                    }
+                }
+                size_t c = 0;
+                while (c < numColors && forbidden[c] == column)
+                    c++;
+                if (c == numColors)
+                {
+                    numColors++;
+                    forbidden.push_back(none);
+                }
+                color[column] = c;
+            }
+            return color;
+        }
+
+        // JACOBIAN()
+        inline double jacobianStep(const JacobianOptions &options, const double x)
+        {
+            double relative = options.step;
+            if (relative <= 0.0)
+                relative = options.central ? std::cbrt(std::numeric_limits<double>::epsilon()) : std::sqrt(std::numeric_limits<double>::epsilon());
+            const double h = relative * std::max(1.0, std::abs(x));
+            // make x + h - x exact so the step in the quotient is the one actually taken
+            volatile double shifted = x + h;
+            return shifted - x;
+        }
+
+        template <typename Body>
+        void forEachTask(const size_t count, const bool parallel, Body &&body)
+        {
+            if (parallel)
+                ThreadPool::global().parallelFor(0, count, body);
+            else
+                for (size_t t = 0; t < count; t++)
+                    body(t, size_t(0));
+        }
+
+        template <typename F>
+        Matrix<double> jacobian(F func, const std::vector<double> &x, const JacobianOptions &options)
+        {
+            const size_t n = x.size();
+            const std::vector<double> f0 = func(x);
+            const size_t m = f0.size();
+            Matrix<double> J(m, n);
+            if (m == 0 || n == 0)
+                return J;
+
+            const size_t workers = options.parallel ? ThreadPool::global().size() : 1;
+            std::vector<std::vector<double>> points(workers, x);
+            std::atomic<bool> mismatch(false);
+            forEachTask(n, options.parallel, [&](size_t j, size_t worker) {
+                std::vector<double> &p = points[worker];
+                const double h = jacobianStep(options, x[j]);
+                p[j] = x[j] + h;
+                const std::vector<double> fp = func(static_cast<const std::vector<double> &>(p));
+                if (options.central)
+                {
+                    p[j] = x[j] - h;
+                    const std::vector<double> fm = func(static_cast<const std::vector<double> &>(p));
+                    if (fp.size() != m || fm.size() != m)
+                        mismatch = true;
+                    else
+                        for (size_t i = 0; i < m; i++)
+                            J.rowData(i)[j] = (fp[i] - fm[i]) / (2.0 * h);
+                }
+                else
+                {
+                    if (fp.size() != m)
+                        mismatch = true;
+                    else
+                        for (size_t i = 0; i < m; i++)
+                            J.rowData(i)[j] = (fp[i] - f0[i]) / h;
+                }
+                p[j] = x[j];
+            });
+            if (mismatch)
+            {
+                std::cerr << "ERROR: Function output size changed between evaluations [jacobian()]\n";
+                return Matrix<double>(m, n);
+            }
+            return J;
+        }
+
+        template <typename F>
+        SparseMatrix<double> jacobian(F func, const std::vector<double> &x, const SparsityPattern &pattern, const JacobianOptions &options)
+        {
+            SparseMatrix<double> J;
+            J.pattern = pattern;
+            J.values.assign(pattern.nonzeros(), 0.0);
+            const size_t n = x.size();
+            if (pattern.cols != n)
+            {
+                std::cerr << "ERROR: Pattern columns do not match the number of inputs [jacobian()]\n";
+                return J;
+            }
+
+            size_t numColors = 0;
+            const std::vector<size_t> color = colorColumns(pattern, numColors);
+            std::vector<std::vector<size_t>> groups(numColors);
+            for (size_t j = 0; j < n; j++)
+                groups[color[j]].push_back(j);
+            const ColumnIndex byColumn(pattern);
+            std::vector<double> f0;
+            if (!options.central)
+            {
+                f0 = func(x);
+                if (f0.size() != pattern.rows)
+                {
+                    std::cerr << "ERROR: Function output size does not match the pattern rows [jacobian()]\n";
+                    return J;
+                }
+            }
+
+            const size_t workers = options.parallel ? ThreadPool::global().size() : 1;
+            std::vector<std::vector<double>> points(workers, x);
+            std::atomic<bool> mismatch(false);
+            forEachTask(numColors, options.parallel, [&](size_t c, size_t worker) {
+                std::vector<double> &p = points[worker];
+                for (size_t j : groups[c])
+                    p[j] = x[j] + jacobianStep(options, x[j]);
+                const std::vector<double> fp = func(static_cast<const std::vector<double> &>(p));
+                std::vector<double> fm;
+                if (options.central)
+                {
+                    for (size_t j : groups[c])
+                        p[j] = x[j] - jacobianStep(options, x[j]);
+                    fm = func(static_cast<const std::vector<double> &>(p));
+                }
+                const std::vector<double> &base = options.central ? fm : f0;
+                const bool valid = (fp.size() == pattern.rows && base.size() == pattern.rows);
+                if (!valid)
+                    mismatch = true;
+                for (size_t j : groups[c])
+                {
+                    if (!valid)
+                    {
+                        p[j] = x[j];
+                        continue;
+                    }
+                    const double h = jacobianStep(options, x[j]);
+                    const double span = options.central ? 2.0 * h : h;
+                    // every row touched by column j belongs to j alone within this color
+                    for (size_t s = byColumn.colStart[j]; s < byColumn.colStart[j + 1]; s++)
+                    {
+                        const size_t i = byColumn.rowIndex[s];
+                        J.values[byColumn.entry[s]] = (fp[i] - base[i]) / span;
+                    }
+                    p[j] = x[j];
+                }
+            });
+            if (mismatch)
+            {
+                std::cerr << "ERROR: Function output size does not match the pattern rows [jacobian()]\n";
+                J.values.assign(pattern.nonzeros(), 0.0);
+            }
+            return J;
+        }
+
+        template <size_t N, typename F>
+        Matrix<double> jacobianDual(F func, const std::vector<double> &x)
+        {
+            typedef Dual<double, N> D;
+            const size_t n = x.size();
+            const size_t passes = (n + N - 1) / N;
+            ThreadPool &pool = ThreadPool::global();
+            std::vector<std::vector<D>> points(pool.size(), std::vector<D>(x.begin(), x.end()));
+            std::vector<std::vector<D>> results(passes);
+
+            pool.parallelFor(0, passes, [&](size_t pass, size_t worker) {
+                std::vector<D> &p = points[worker];
+                const size_t start = pass * N, count = std::min(N, n - start);
+                for (size_t k = 0; k < count; k++)
+                    p[start + k].tangent[k] = 1.0;
+                results[pass] = func(static_cast<const std::vector<D> &>(p));
+                for (size_t k = 0; k < count; k++)
+                    p[start + k].tangent[k] = 0.0;
+            });
+
+            const size_t m = passes ? results[0].size() : 0;
+            for (size_t pass = 1; pass < passes; pass++)
+            {
+                if (results[pass].size() != m)
+                {
+                    std::cerr << "ERROR: Function output size changed between evaluations [jacobianDual()]\n";
+                    return Matrix<double>(m, n);
+                }
+            }
+            Matrix<double> J(m, n);
+            for (size_t pass = 0; pass < passes; pass++)
+            {
+                const size_t start = pass * N, count = std::min(N, n - start);
+                for (size_t i = 0; i < m; i++)
+                    for (size_t k = 0; k < count; k++)
+                        J.rowData(i)[start + k] = results[pass][i].tangent[k];
+            }
+            return J;
+        }
+
+        template <size_t N, typename F>
+        SparseMatrix<double> jacobianDual(F func, const std::vector<double> &x, const SparsityPattern &pattern)
+        {
+            typedef Dual<double, N> D;
+            SparseMatrix<double> J;
+            J.pattern = pattern;
+            J.values.assign(pattern.nonzeros(), 0.0);
+            const size_t n = x.size();
+            if (pattern.cols != n)
+            {
+                std::cerr << "ERROR: Pattern columns do not match the number of inputs [jacobianDual()]\n";
+                return J;
+            }
+
+            size_t numColors = 0;
+            const std::vector<size_t> color = colorColumns(pattern, numColors);
+            const ColumnIndex byColumn(pattern);
+            const size_t passes = (numColors + N - 1) / N;
+            ThreadPool &pool = ThreadPool::global();
+            std::vector<std::vector<D>> points(pool.size(), std::vector<D>(x.begin(), x.end()));
+            std::atomic<bool> mismatch(false);
+
+            pool.parallelFor(0, passes, [&](size_t pass, size_t worker) {
+                // colors pass*N .. pass*N + N - 1 go to tangent directions 0 .. N - 1
+                std::vector<D> &p = points[worker];
+                const size_t first = pass * N;
+                for (size_t j = 0; j < n; j++)
+                    if (color[j] >= first && color[j] < first + N)
+                        p[j].tangent[color[j] - first] = 1.0;
+                const std::vector<D> y = func(static_cast<const std::vector<D> &>(p));
+                const bool valid = (y.size() == pattern.rows);
+                if (!valid)
+                    mismatch = true;
+                for (size_t j = 0; j < n; j++)
+                {
+                    if (color[j] < first || color[j] >= first + N)
+                        continue;
+                    if (valid)
+                        for (size_t s = byColumn.colStart[j]; s < byColumn.colStart[j + 1]; s++)
+                            J.values[byColumn.entry[s]] = y[byColumn.rowIndex[s]].tangent[color[j] - first];
+                    p[j].tangent[color[j] - first] = 0.0;
+                }
+            });
+            if (mismatch)
+            {
+                std::cerr << "ERROR: Function output size does not match the pattern rows [jacobianDual()]\n";
+                J.values.assign(pattern.nonzeros(), 0.0);
+            }
+            return J;
+        }
     }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,363 @@
+/*
+Programmer: Connor Fricke (cd.fricke23@gmail.com)
+File: Instrument.h
+Latest Revision: 18-Oct-2026
+Synopsis: Header and implementation file for compile-time switchable timers, counters and tracing
+*/
+
+#ifndef INSTRUMENT_H
+#define INSTRUMENT_H
+
+    #include <algorithm>
+    #include <atomic>
+    #include <chrono>
+    #include <cstdint>
+    #include <cstdio>
+    #include <map>
+    #include <memory>
+    #include <mutex>
+    #include <ostream>
+    #include <string>
+    #include <vector>
+
+    /*
+    Instrumentation is compiled in only when INSTRUMENT_ENABLED is defined to 1 (CMake: -DCPPLIB_INSTRUMENT=ON).
+    Otherwise every macro below expands to nothing and its arguments are never evaluated, so the library's
+    hot paths carry no cost at all. Define it the same way in every translation unit of a program.
+
+        INSTRUMENT_SCOPE(name)                  times the enclosing scope, counts one call
+        INSTRUMENT_WORK(name, bytes, flops)     adds bytes moved and floating point operations to name
+        INSTRUMENT_COUNT(name, bytes)           counts one event (allocation, copy, ...) of the given size
+
+    name must be a string literal. Each site looks its counter up once (a function-local static), after
+    which recording is a few relaxed atomic additions, so any number of threads may record at once.
+    The instrument:: functions (reports, JSON, Chrome trace) exist in both modes; with instrumentation
+    off they simply have nothing to report.
+    */
+    #ifndef INSTRUMENT_ENABLED
+        #define INSTRUMENT_ENABLED 0
+    #endif
+
+    #if INSTRUMENT_ENABLED
+        #define INSTRUMENT_CONCAT_(a, b) a##b
+        #define INSTRUMENT_CONCAT(a, b) INSTRUMENT_CONCAT_(a, b)
+        #define INSTRUMENT_SCOPE(name) \
+            static instrument::Counter &INSTRUMENT_CONCAT(instrumentCounter, __LINE__) = instrument::counter(name); \
+            instrument::ScopedTimer INSTRUMENT_CONCAT(instrumentTimer, __LINE__)(INSTRUMENT_CONCAT(instrumentCounter, __LINE__))
+        #define INSTRUMENT_WORK(name, bytes, flops) \
+            do { \
+                static instrument::Counter &instrumentCounter = instrument::counter(name); \
+                instrumentCounter.work(uint64_t(bytes), uint64_t(flops)); \
+            } while (0)
+        #define INSTRUMENT_COUNT(name, bytes) \
+            do { \
+                static instrument::Counter &instrumentCounter = instrument::counter(name); \
+                instrumentCounter.event(uint64_t(bytes)); \
+            } while (0)
+    #else
+        #define INSTRUMENT_SCOPE(name) ((void)0)
+        #define INSTRUMENT_WORK(name, bytes, flops) ((void)0)
+        #define INSTRUMENT_COUNT(name, bytes) ((void)0)
+    #endif
+
+    // DECLARATIONS
+    namespace instrument {
+        /*
+        Counter:
+            Totals of one named site: calls (or events), time spent inside INSTRUMENT_SCOPE, bytes and FLOPs.
+        */
+        class Counter
+        {
+            std::atomic<uint64_t> calls, nanoseconds, bytes, flops;
+
+        public:
+            const std::string name;
+        // CONSTRUCTORS
+            explicit Counter(const std::string &name);
+        // RECORDING
+            void timed(const uint64_t ns);
+            void work(const uint64_t bytes, const uint64_t flops);
+            void event(const uint64_t bytes);
+            void reset();
+        // ACCESSORS
+            uint64_t callCount() const;
+            double seconds() const;
+            uint64_t byteCount() const;
+            uint64_t flopCount() const;
+        };
+
+        // the counter registered under name, created on first use; its address never changes
+        Counter &counter(const std::string &name);
+
+        /*
+        ScopedTimer:
+            Adds the lifetime of the object to a counter. While a trace is running (startTrace()), each
+            timed scope is also recorded as a complete event for writeChromeTrace().
+        */
+        class ScopedTimer
+        {
+            Counter &target;
+            std::chrono::steady_clock::time_point start;
+
+        public:
+            explicit ScopedTimer(Counter &target);
+            ScopedTimer(const ScopedTimer &) = delete;
+            ScopedTimer &operator=(const ScopedTimer &) = delete;
+            ~ScopedTimer();
+        };
+
+        /*
+        CounterValues / snapshot():
+            Point-in-time copy of every registered counter (or of one, by name; all zero if it was never used).
+        */
+        struct CounterValues
+        {
+            std::string name;
+            uint64_t calls = 0;
+            double seconds = 0.0;
+            uint64_t bytes = 0;
+            uint64_t flops = 0;
+        };
+        std::vector<CounterValues> snapshot();
+        CounterValues snapshot(const std::string &name);
+
+        // zero every counter and drop recorded trace events
+        void reset();
+
+        /*
+        Output:
+            report() writes a table sorted by time, with GB/s and GFLOP/s where work was recorded.
+            writeJSON() writes the same numbers as {"counters": [...]}.
+            writeChromeTrace() writes the events recorded between startTrace() and stopTrace() in the
+            Chrome trace event format, for chrome://tracing or Perfetto.
+        */
+        void report(std::ostream &out);
+        void writeJSON(std::ostream &out);
+        void startTrace();
+        void stopTrace();
+        void writeChromeTrace(std::ostream &out);
+    }
+
+    // DEFINITIONS
+    namespace instrument {
+
+        struct TraceEvent
+        {
+            const std::string *name;
+            uint64_t start, duration;      // nanoseconds since the registry was created
+            uint32_t thread;
+        };
+
+        struct Registry
+        {
+            std::mutex lock;
+            std::map<std::string, std::unique_ptr<Counter>> counters;
+            std::atomic<bool> tracing{false};
+            std::mutex traceLock;
+            std::vector<TraceEvent> events;
+            std::atomic<uint32_t> nextThread{0};
+            const std::chrono::steady_clock::time_point origin = std::chrono::steady_clock::now();
+        };
+
+        inline Registry &registry()
+        {
+            static Registry instance;
+            return instance;
+        }
+
+        inline uint32_t threadIndex()
+        {
+            thread_local const uint32_t index = registry().nextThread.fetch_add(1);
+            return index;
+        }
+
+        // COUNTER
+        inline Counter::Counter(const std::string &name) : calls(0), nanoseconds(0), bytes(0), flops(0), name(name) {}
+
+        inline void Counter::timed(const uint64_t ns)
+        {
+            calls.fetch_add(1, std::memory_order_relaxed);
+            nanoseconds.fetch_add(ns, std::memory_order_relaxed);
+        }
+
+        inline void Counter::work(const uint64_t b, const uint64_t f)
+        {
+            bytes.fetch_add(b, std::memory_order_relaxed);
+            flops.fetch_add(f, std::memory_order_relaxed);
+        }
+
+        inline void Counter::event(const uint64_t b)
+        {
+            calls.fetch_add(1, std::memory_order_relaxed);
+            bytes.fetch_add(b, std::memory_order_relaxed);
+        }
+
+        inline void Counter::reset()
+        {
+            calls = 0;
+            nanoseconds = 0;
+            bytes = 0;
+            flops = 0;
+        }
+
+        inline uint64_t Counter::callCount() const
+        {
+            return calls.load(std::memory_order_relaxed);
+        }
+
+        inline double Counter::seconds() const
+        {
+            return double(nanoseconds.load(std::memory_order_relaxed)) * 1e-9;
+        }
+
+        inline uint64_t Counter::byteCount() const
+        {
+            return bytes.load(std::memory_order_relaxed);
+        }
+
+        inline uint64_t Counter::flopCount() const
+        {
+            return flops.load(std::memory_order_relaxed);
+        }
+
+        inline Counter &counter(const std::string &name)
+        {
+            Registry &r = registry();
+            std::lock_guard<std::mutex> guard(r.lock);
+            std::unique_ptr<Counter> &slot = r.counters[name];
+            if (!slot)
+                slot.reset(new Counter(name));
+            return *slot;
+        }
+
+        // SCOPEDTIMER
+        inline ScopedTimer::ScopedTimer(Counter &target) : target(target), start(std::chrono::steady_clock::now()) {}
+
+        inline ScopedTimer::~ScopedTimer()
+        {
+            const std::chrono::steady_clock::time_point stop = std::chrono::steady_clock::now();
+            const uint64_t ns = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count());
+            target.timed(ns);
+            Registry &r = registry();
+            if (r.tracing.load(std::memory_order_relaxed))
+            {
+                const uint64_t offset = uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(start - r.origin).count());
+                const uint32_t thread = threadIndex();
+                std::lock_guard<std::mutex> guard(r.traceLock);
+                r.events.push_back(TraceEvent{&target.name, offset, ns, thread});
+            }
+        }
+
+        // SNAPSHOT() / RESET()
+        inline std::vector<CounterValues> snapshot()
+        {
+            Registry &r = registry();
+            std::lock_guard<std::mutex> guard(r.lock);
+            std::vector<CounterValues> values;
+            for (const auto &entry : r.counters)
+            {
+                const Counter &c = *entry.second;
+                values.push_back(CounterValues{c.name, c.callCount(), c.seconds(), c.byteCount(), c.flopCount()});
+            }
+            return values;
+        }
+
+        inline CounterValues snapshot(const std::string &name)
+        {
+            Registry &r = registry();
+            std::lock_guard<std::mutex> guard(r.lock);
+            const auto found = r.counters.find(name);
+            if (found == r.counters.end())
+                return CounterValues{name};
+            const Counter &c = *found->second;
+            return CounterValues{c.name, c.callCount(), c.seconds(), c.byteCount(), c.flopCount()};
+        }
+
+        inline void reset()
+        {
+            Registry &r = registry();
+            {
+                std::lock_guard<std::mutex> guard(r.lock);
+                for (auto &entry : r.counters)
+                    entry.second->reset();
+            }
+            std::lock_guard<std::mutex> guard(r.traceLock);
+            r.events.clear();
+        }
+
+        // OUTPUT
+        inline std::string jsonString(const std::string &s)
+        {
+            std::string q = "\"";
+            for (char c : s)
+            {
+                if (c == '"' || c == '\\')
+                    q += '\\';
+                q += c;
+            }
+            return q + "\"";
+        }
+
+        inline void report(std::ostream &out)
+        {
+            std::vector<CounterValues> values = snapshot();
+            std::sort(values.begin(), values.end(), [](const CounterValues &a, const CounterValues &b) {
+                return (a.seconds != b.seconds) ? a.seconds > b.seconds : a.name < b.name;
+            });
+            char line[256];
+            std::snprintf(line, sizeof(line), "%-36s %12s %12s %14s %10s %10s\n", "counter", "calls", "seconds", "bytes", "GB/s", "GFLOP/s");
+            out << line;
+            for (const CounterValues &v : values)
+            {
+                if (v.calls == 0 && v.bytes == 0 && v.flops == 0)
+                    continue;
+                const double gbs = (v.seconds > 0.0) ? double(v.bytes) / v.seconds * 1e-9 : 0.0;
+                const double gflops = (v.seconds > 0.0) ? double(v.flops) / v.seconds * 1e-9 : 0.0;
+                std::snprintf(line, sizeof(line), "%-36s %12llu %12.6f %14llu %10.3f %10.3f\n", v.name.c_str(), (unsigned long long)v.calls,
+                              v.seconds, (unsigned long long)v.bytes, gbs, gflops);
+                out << line;
+            }
+        }
+
+        inline void writeJSON(std::ostream &out)
+        {
+            const std::vector<CounterValues> values = snapshot();
+            out << "{\"enabled\": " << (INSTRUMENT_ENABLED ? "true" : "false") << ", \"counters\": [";
+            for (size_t i = 0; i < values.size(); i++)
+            {
+                const CounterValues &v = values[i];
+                out << (i ? ",\n  " : "\n  ") << "{\"name\": " << jsonString(v.name) << ", \"calls\": " << v.calls
+                    << ", \"seconds\": " << v.seconds << ", \"bytes\": " << v.bytes << ", \"flops\": " << v.flops << "}";
+            }
+            out << "\n]}\n";
+        }
+
+        inline void startTrace()
+        {
+            registry().tracing = true;
+        }
+
+        inline void stopTrace()
+        {
+            registry().tracing = false;
+        }
+
+        inline void writeChromeTrace(std::ostream &out)
+        {
+            Registry &r = registry();
+            std::lock_guard<std::mutex> guard(r.traceLock);
+            out << "{\"traceEvents\": [";
+            char number[64];
+            for (size_t i = 0; i < r.events.size(); i++)
+            {
+                const TraceEvent &e = r.events[i];
+                // timestamps and durations are microseconds
+                std::snprintf(number, sizeof(number), "%.3f, \"dur\": %.3f", double(e.start) * 1e-3, double(e.duration) * 1e-3);
+                out << (i ? ",\n  " : "\n  ") << "{\"name\": " << jsonString(*e.name) << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << e.thread
+                    << ", \"ts\": " << number << "}";
+            }
+            out << "\n], \"displayTimeUnit\": \"ms\"}\n";
+        }
+    }
+
+#endif
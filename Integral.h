@@ -1,7 +1,7 @@
 /*
 Programmer: Connor Fricke (cd.fricke23@gmail.com)
 File: Calculus.h
-Latest Revision: 9-Apr-2025
+Latest Revision: 18-Oct-2026
 Synopsis: Header and implementation file for numerical integration routines
 */
 
@@ -9,80 +9,1572 @@ Synopsis: Header and implementation file for numerical integration routines
 #define INTEGRAL_H
 
     #include <cstdlib>
+    #include <algorithm>
+    #include <cmath>
+    #include <limits>
+    #include <cstdint>
+    #include <iostream>
+    #include <type_traits>
+    #include <vector>
+    #include "Random.h"
+    #include "ThreadPool.h"
 
     // DECLARATIONS
     namespace integral {
+        /*
+        All integrators are templated on the integrand, so plain functions, function objects and capturing
+        lambdas are all accepted and the integrand can be inlined into the sampling loop.
+        Wrapping a callable with batch() selects the batched overloads instead: the callable is then invoked as
+            f(const double* x, double* y, size_t n)
+        and must write y[i] = f(x[i]) for all n points, letting one call (and one vectorized loop inside it)
+        cover up to BATCH_SIZE sample points.
+        */
+        const size_t BATCH_SIZE = 256;
+
+        template <typename F>
+        struct BatchIntegrand
+        {
+            F func;
+        };
+
+        template <typename F>
+        BatchIntegrand<F> batch(F func);
+
+        /*
+        IntegrandResult<F>:
+            Value type of the fixed-rule integrators: the integrand's return type promoted to at least double.
+            An integrand returning derivative::Dual therefore integrates its tangents too, giving exact parameter
+            derivatives of the integral.
+        */
+        template <typename F>
+        using IntegrandResult = typename std::common_type<typename std::invoke_result<F &, double>::type, double>::type;
+
         /* Adapted from Physics 5810 with Prof. Ralf Bundschuh and Prof. Dick Furnstahl */
-        double trapezoidal(double (*func)(double), const double a, const double b, const int n);
+        template <typename F>
+        IntegrandResult<F> trapezoidal(F func, const double a, const double b, const int n);
+        template <typename F>
+        double trapezoidal(BatchIntegrand<F> func, const double a, const double b, const int n);
 
         /* Adapted from adapted from Cameron McElfresh */
         /* https://cameron-mcelfresh.medium.com/monte-carlo-integration-313b37157852 */
-        double monteCarlo(double (*func)(double), const double a, const double b, const int n);
+        /* Serial (func is never called concurrently) and seeded; use the MonteCarloOptions overload for threads or QMC */
+        template <typename F>
+        double monteCarlo(F func, const double a, const double b, const int n);
 
         /* Adapted from Physics 5810 with Prof. Ralf Bundschuh and Prof. Dick Furnstahl */
-        double simpsons(double (*func)(double), const double a, const double b, const int n);
+        template <typename F>
+        IntegrandResult<F> simpsons(F func, const double a, const double b, const int n);
+        template <typename F>
+        double simpsons(BatchIntegrand<F> func, const double a, const double b, const int n);
+
+        enum GaussKronrodRule { GK15, GK21 };
+
+        /*
+        QuadratureOptions:
+            Controls of the adaptive integrators.
+                absTol, relTol: stop once the estimated error is below max(absTol, relTol * |value|)
+                rule: GK15 (7-point Gauss / 15-point Kronrod) or GK21 (10-point Gauss / 21-point Kronrod)
+                maxIntervals: give up (converged = false) once this many subintervals exist
+                parallel: evaluate subintervals on the global ThreadPool (the integrand must then be safe to call concurrently)
+        */
+        struct QuadratureOptions
+        {
+            double absTol = 1e-10;
+            double relTol = 1e-10;
+            GaussKronrodRule rule = GK21;
+            size_t maxIntervals = 2000;
+            bool parallel = true;
+        };
+
+        /*
+        QuadratureResult:
+            value: integral estimate
+            error: estimated absolute error
+            evaluations: number of integrand evaluations
+            intervals: number of subintervals in the final partition
+            converged: whether the requested tolerance was met
+        */
+        struct QuadratureResult
+        {
+            double value = 0.0;
+            double error = 0.0;
+            size_t evaluations = 0;
+            size_t intervals = 0;
+            bool converged = true;
+        };
+
+        /*
+        gaussKronrod(F, const double a, const double b, const QuadratureOptions&):
+            Globally adaptive Gauss-Kronrod quadrature (the QUADPACK QAG/QAGI strategy). Subintervals are kept in
+            a priority queue ordered by error estimate; each step bisects the worst ones until the summed error
+            meets the tolerance. Up to PARALLEL_WIDTH subintervals are bisected per step and their children
+            evaluated in parallel. The width does not depend on the thread count, so results are identical
+            for any number of threads.
+            Either limit may be infinite: [a, inf) uses x = a + t/(1-t), (-inf, b] uses x = b - (1-t)/t and
+            (-inf, inf) uses x = t/(1-t^2). The Kronrod nodes never touch the interval ends.
+            Accepts pointwise integrands and batch() integrands, which receive all nodes of a subinterval in one call.
+        */
+        const size_t PARALLEL_WIDTH = 16;
+
+        template <typename F>
+        QuadratureResult gaussKronrod(F func, const double a, const double b, const QuadratureOptions &options = QuadratureOptions());
+
+        /*
+        RombergIntegrator<F>:
+            Incremental trapezoid rule with Richardson extrapolation (Romberg's method) on [a, b].
+            Level k is the trapezoid rule with 2^k panels. refine() adds a level by evaluating only the
+            2^(k-1) new midpoints and reusing the previous sum, then extends the extrapolation table.
+            All previous levels stay available, so a convergence study up to level k costs the same
+            2^k + 1 evaluations as level k alone. Works best on smooth integrands.
+            Accepts pointwise and batch() integrands (midpoints are evaluated in batches of BATCH_SIZE).
+        */
+        template <typename F>
+        class RombergIntegrator
+        {
+            F func;
+            double a, b;
+            std::vector<std::vector<double>> table;   // table[k][j]: level k after j extrapolations
+            size_t evaluations;
+
+        public:
+        // CONSTRUCTORS
+            RombergIntegrator(F func, const double a, const double b);
+        // REFINEMENT
+            double refine();                                    // adds one level, returns the new estimate
+            QuadratureResult integrate(const double absTol = 1e-10, const double relTol = 1e-10, const size_t maxLevel = 24);
+        // ACCESSORS
+            size_t levels() const;                              // number of levels computed so far
+            double trapezoid(const size_t level) const;         // plain trapezoid estimate with 2^level panels
+            double extrapolated(const size_t level, const size_t order) const;
+            double estimate() const;                            // most extrapolated value of the finest level
+            double error() const;                               // difference between the last two diagonal entries
+            size_t evaluationCount() const;
+        };
+
+        /*
+        romberg(F, const double a, const double b, const double absTol, const double relTol, const size_t maxLevel):
+            One-shot Romberg integration, refining until the estimated error is below max(absTol, relTol * |value|)
+            or maxLevel is reached.
+        */
+        template <typename F>
+        QuadratureResult romberg(F func, const double a, const double b, const double absTol = 1e-10, const double relTol = 1e-10, const size_t maxLevel = 24);
+
+        /*
+        SamplingMethod:
+            PSEUDO_RANDOM: independent uniform points
+            ANTITHETIC: pairs x and (lower + upper - x), which cancels the odd part of the integrand
+            STRATIFIED: the box is cut into k^d equal cells with two uniform points in each
+            SOBOL, HALTON: randomized quasi-Monte Carlo, using independently shifted copies of the sequence
+        */
+        enum SamplingMethod { PSEUDO_RANDOM, ANTITHETIC, STRATIFIED, SOBOL, HALTON };
+
+        /*
+        MonteCarloOptions:
+            method: sampling method, see SamplingMethod
+            seed: every block of samples draws from its own Philox stream of this seed
+            blockSize: samples per block, the unit of parallel work
+            randomizations: number of shifted QMC sequences, the spread between them gives the error estimate
+            parallel: evaluate blocks on the global ThreadPool (the integrand must then be safe to call concurrently)
+        */
+        struct MonteCarloOptions
+        {
+            SamplingMethod method = PSEUDO_RANDOM;
+            uint64_t seed = 0x5EEDull;
+            size_t blockSize = 4096;
+            size_t randomizations = 16;
+            bool parallel = true;
+        };
+
+        /*
+        MonteCarloResult:
+            value: integral estimate
+            stdError: estimated standard error of the value
+            evaluations: number of integrand evaluations
+        */
+        struct MonteCarloResult
+        {
+            double value = 0.0;
+            double stdError = 0.0;
+            size_t evaluations = 0;
+        };
+
+        /*
+        monteCarlo(F, const double a, const double b, const size_t n, const MonteCarloOptions&):
+            Monte Carlo estimate of the integral over [a, b] from about n evaluations of func.
+            The samples are split into fixed blocks, each with its own counter-based random stream, and the block
+            results are combined in block order, so for a given seed the result is bit-identical whatever the
+            number of threads. Accepts pointwise and batch() integrands.
+        monteCarlo(F, const std::vector<double>&, const std::vector<double>&, const size_t n, const MonteCarloOptions&):
+            Same over the box [lower, upper] in d = lower.size() dimensions. A pointwise integrand is called as
+            f(const double* x) with d coordinates. A batch() integrand is called as f(const double* x, double* y, size_t n),
+            with the n points stored one after another (n x d, row-major).
+        */
+        template <typename F>
+        MonteCarloResult monteCarlo(F func, const double a, const double b, const size_t n, const MonteCarloOptions &options);
+        template <typename F>
+        MonteCarloResult monteCarlo(F func, const std::vector<double> &lower, const std::vector<double> &upper, const size_t n, const MonteCarloOptions &options);
+
+        /*
+        CubatureOptions:
+            absTol, relTol: stop once the estimated error is below max(absTol, relTol * |value|)
+            maxEvaluations: give up (converged = false) after this many integrand evaluations
+            parallel: evaluate regions on the global ThreadPool (the integrand must then be safe to call concurrently)
+        */
+        struct CubatureOptions
+        {
+            double absTol = 1e-8;
+            double relTol = 1e-8;
+            size_t maxEvaluations = 1000000;
+            bool parallel = true;
+        };
+
+        /*
+        cubature(F, const std::vector<double>&, const std::vector<double>&, const CubatureOptions&):
+            Globally adaptive cubature over the box [lower, upper] with the degree 7/5 Genz-Malik rule
+            (Genz & Malik, 1980; the embedded rule gives the error estimate), needing 2^d + 2d^2 + 2d + 1
+            points per region. The worst regions are bisected along the axis with the largest fourth
+            difference, up to PARALLEL_WIDTH per step, and the children are evaluated in parallel. For d = 1
+            it falls back to gaussKronrod with the GK15 rule. Best suited to smooth integrands in up to about 7 dimensions.
+            Integrands follow the box convention of monteCarlo(): f(const double* x) or a batch() callable,
+            which receives every point of a region in one call. intervals in the result counts regions.
+        */
+        template <typename F>
+        QuadratureResult cubature(F func, const std::vector<double> &lower, const std::vector<double> &upper, const CubatureOptions &options = CubatureOptions());
+
+        /*
+        VegasOptions:
+            evaluationsPerIteration: samples per VEGAS iteration
+            warmupIterations: iterations used only to train the grid, their estimates are discarded
+            iterations: iterations whose estimates are combined into the result
+            bins: grid bins per axis
+            alpha: grid damping exponent, smaller values adapt more cautiously
+            seed, blockSize, parallel: as in MonteCarloOptions
+        */
+        struct VegasOptions
+        {
+            size_t evaluationsPerIteration = 100000;
+            size_t warmupIterations = 5;
+            size_t iterations = 10;
+            size_t bins = 50;
+            double alpha = 1.5;
+            uint64_t seed = 0x5EEDull;
+            size_t blockSize = 4096;
+            bool parallel = true;
+        };
+
+        /*
+        VegasResult:
+            value, stdError: inverse-variance weighted combination of the iteration estimates
+            chi2PerDof: consistency of the iteration estimates, values well above 1 mean the result is unreliable
+            evaluations: total integrand evaluations including warmup
+        */
+        struct VegasResult
+        {
+            double value = 0.0;
+            double stdError = 0.0;
+            double chi2PerDof = 0.0;
+            size_t evaluations = 0;
+        };
+
+        /*
+        vegas(F, const std::vector<double>&, const std::vector<double>&, const VegasOptions&):
+            VEGAS adaptive importance sampling (Lepage, 1978). A separable piecewise-linear map per axis is
+            trained so that sampling density follows |f|, then Monte Carlo estimates under the map are combined.
+            Suited to higher dimensions and peaked integrands. Samples are drawn in blocks with their own Philox
+            streams and reduced in block order, so results are reproducible for any thread count.
+            Integrands follow the box convention of monteCarlo().
+        */
+        template <typename F>
+        VegasResult vegas(F func, const std::vector<double> &lower, const std::vector<double> &upper, const VegasOptions &options = VegasOptions());
     }
 
     // DEFINITIONS
     namespace integral {
 
-        double trapezoidal(double (*func)(double), const double a, const double b, const int n)
+        template <typename F>
+        BatchIntegrand<F> batch(F func)
+        {
+            return BatchIntegrand<F>{func};
+        }
+
+        template <typename F>
+        IntegrandResult<F> trapezoidal(F func, const double a, const double b, const int n)
         {
             double h = ((b - a) / double(n - 1)); // point spacing
-            double sum = 0.0;
+            IntegrandResult<F> sum = 0.0;
 
             // midpoint contributions
             for (int i = 2; i < n; i++)
             {
                 double x = a + h * double(i - 1);
-                sum += h * func(x);
+                sum += func(x);
             }
+            sum *= h;
             // endpoint contributions
             sum += (h / 2.0) * (func(a) + func(b));
 
             return (sum);
         }
 
-        double monteCarlo(double (*func)(double), const double a, const double b, const int iterations)
+        template <typename F>
+        double trapezoidal(BatchIntegrand<F> func, const double a, const double b, const int n)
+        {
+            double h = ((b - a) / double(n - 1)); // point spacing
+            double x[BATCH_SIZE], y[BATCH_SIZE];
+            double sum = 0.0;
+
+            // midpoint contributions, points 1..n-2 in batches
+            for (int start = 1; start < n - 1; start += int(BATCH_SIZE))
+            {
+                const int count = std::min(int(BATCH_SIZE), n - 1 - start);
+                for (int i = 0; i < count; i++)
+                {
+                    x[i] = a + h * double(start + i);
+                }
+                func.func(x, y, size_t(count));
+                for (int i = 0; i < count; i++)
+                {
+                    sum += y[i];
+                }
+            }
+            sum *= h;
+            // endpoint contributions
+            x[0] = a;
+            x[1] = b;
+            func.func(x, y, 2);
+            sum += (h / 2.0) * (y[0] + y[1]);
+
+            return (sum);
+        }
+
+        template <typename F>
+        double monteCarlo(F func, const double a, const double b, const int iterations)
         {
             /*
             https://cameron-mcelfresh.medium.com/monte-carlo-integration-313b37157852
             */
+            if (iterations <= 0)
+                return 0.0;
+            // existing callers may pass stateful integrands, so this overload stays on the calling thread
+            MonteCarloOptions options;
+            options.parallel = false;
+            return monteCarlo(func, a, b, size_t(iterations), options).value;
+        }
 
-            double sum = 0;
-            double randNum, f;
+        template <typename F>
+        IntegrandResult<F> simpsons(F func, const double a, const double b, const int n)
+        {
+            double h = ((b - a) / double(n - 1));
+            IntegrandResult<F> odd = 0., even = 0.;
 
-            for (int i = 0; i < iterations - 1; i++)
+            // single sweep over the interior points, alternating weights 4/3 (odd) and 2/3 (even)
+            int i = 1;
+            for (; i + 1 < n - 1; i += 2)
             {
-                // generate random number within bounds
-                randNum = a + (double(std::rand()) / RAND_MAX) * (b - a);
-                // sample function
-                f = func(randNum);
-                sum += f;
+                odd += func(a + h * double(i));
+                even += func(a + h * double(i + 1));
             }
+            if (i < n - 1)
+                odd += func(a + h * double(i));
 
-            return (b - a) * sum / iterations;
+            IntegrandResult<F> sum = (4. / 3.) * h * odd + (2. / 3.) * h * even;
+            // endpoint contributions
+            sum += (h / 3.) * (func(a) + func(b));
+            return (sum);
         }
 
-        double simpsons(double (*func)(double), const double a, const double b, const int n)
+        template <typename F>
+        double simpsons(BatchIntegrand<F> func, const double a, const double b, const int n)
         {
             double h = ((b - a) / double(n - 1));
-            double sum = 0.;
+            double x[BATCH_SIZE], y[BATCH_SIZE];
+            double odd = 0., even = 0.;
 
-            for (int i = 2; i < n; i += 2) // loop for odd points
+            // interior points 1..n-2 in batches, weights 4/3 on odd and 2/3 on even indices
+            for (int start = 1; start < n - 1; start += int(BATCH_SIZE))
             {
-                double x = a + h * double(i - 1);
-                sum += (4. / 3.) * h * func(x);
-            }
-            for (int i = 3; i < n; i += 2) // loop for even points
-            {
-                double x = a + h * double(i - 1);
-                sum += (2. / 3.) * h * func(x);
+                const int count = std::min(int(BATCH_SIZE), n - 1 - start);
+                for (int i = 0; i < count; i++)
+                {
+                    x[i] = a + h * double(start + i);
+                }
+                func.func(x, y, size_t(count));
+                // BATCH_SIZE is even, so every batch starts on an odd index
+                int i = 0;
+                for (; i + 1 < count; i += 2)
+                {
+                    odd += y[i];
+                    even += y[i + 1];
+                }
+                if (i < count)
+                    odd += y[i];
             }
+
+            double sum = (4. / 3.) * h * odd + (2. / 3.) * h * even;
             // endpoint contributions
-            sum += (h / 3.) * (func(a) + func(b));
+            x[0] = a;
+            x[1] = b;
+            func.func(x, y, 2);
+            sum += (h / 3.) * (y[0] + y[1]);
             return (sum);
         }
+
+        // GAUSS-KRONROD
+        // Nodes on [0, 1) in decreasing order (the last one is the center), Kronrod weights for each node,
+        // and Gauss weights for the odd-indexed nodes (plus the center for the odd order GK15).
+        const double GK15_NODES[8] = {
+            0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+            0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+            0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+            0.207784955007898467600689403773245, 0.000000000000000000000000000000000};
+        const double GK15_KRONROD[8] = {
+            0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+            0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+            0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+            0.204432940075298892414161999234649, 0.209482141084727828012999174891714};
+        const double GK15_GAUSS[4] = {
+            0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+            0.381830050505118944950369775488975, 0.417959183673469387755102040816327};
+
+        const double GK21_NODES[11] = {
+            0.995657163025808080735527280689003, 0.973906528517171720077964012084452,
+            0.930157491355708226001207180059508, 0.865063366688984510732096688423493,
+            0.780817726586416897063717578345042, 0.679409568299024406234327365114874,
+            0.562757134668604683339000099272694, 0.433395394129247190799265943165784,
+            0.294392862701460198131126603103866, 0.148874338981631210884826001129720,
+            0.000000000000000000000000000000000};
+        const double GK21_KRONROD[11] = {
+            0.011694638867371874278064396062192, 0.032558162307964727478818972459390,
+            0.054755896574351996031381300244580, 0.075039674810919952767043140916190,
+            0.093125454583697605535065465083366, 0.109387158802297641899210590325805,
+            0.123491976262065851077208980132213, 0.134709217311473325928054001771707,
+            0.142775938577060080797094273138717, 0.147739104901338491374841515972068,
+            0.149445554002916905664936468389821};
+        const double GK21_GAUSS[5] = {
+            0.066671344308688137593568809893332, 0.149451349150580593145776339657697,
+            0.219086362515982043995534934228163, 0.269266719309996355091226921569469,
+            0.295524224714752870173892994651146};
+
+        struct Subinterval
+        {
+            double a, b, value, error;
+            bool operator<(const Subinterval &other) const { return error < other.error; }
+        };
+
+        template <typename F>
+        void evaluatePoints(F &func, const double *x, double *y, const size_t n)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                y[i] = func(x[i]);
+            }
+        }
+
+        template <typename F>
+        void evaluatePoints(BatchIntegrand<F> &func, const double *x, double *y, const size_t n)
+        {
+            func.func(x, y, n);
+        }
+
+        // applies the Kronrod rule and its embedded Gauss rule on [a, b], returns the number of evaluations
+        template <typename F>
+        size_t kronrodRule(F &func, const double a, const double b, const GaussKronrodRule rule, Subinterval &out)
+        {
+            const bool k15 = (rule == GK15);
+            const double *xgk = k15 ? GK15_NODES : GK21_NODES;
+            const double *wgk = k15 ? GK15_KRONROD : GK21_KRONROD;
+            const double *wg = k15 ? GK15_GAUSS : GK21_GAUSS;
+            const int n = k15 ? 8 : 11;
+            const int points = 2 * n - 1;
+
+            const double center = 0.5 * (a + b);
+            const double half = 0.5 * (b - a);
+            double x[21], y[21];
+            x[0] = center;
+            for (int j = 0; j < n - 1; j++)
+            {
+                x[1 + 2 * j] = center - half * xgk[j];
+                x[2 + 2 * j] = center + half * xgk[j];
+            }
+            evaluatePoints(func, x, y, size_t(points));
+
+            double resk = wgk[n - 1] * y[0];
+            double resg = k15 ? wg[3] * y[0] : 0.0;
+            double resabs = wgk[n - 1] * std::abs(y[0]);
+            for (int j = 0; j < n - 1; j++)
+            {
+                const double pair = y[1 + 2 * j] + y[2 + 2 * j];
+                resk += wgk[j] * pair;
+                resabs += wgk[j] * (std::abs(y[1 + 2 * j]) + std::abs(y[2 + 2 * j]));
+                if (j % 2 == 1)
+                    resg += wg[j / 2] * pair;
+            }
+            const double mean = 0.5 * resk;
+            double resasc = wgk[n - 1] * std::abs(y[0] - mean);
+            for (int j = 0; j < n - 1; j++)
+            {
+                resasc += wgk[j] * (std::abs(y[1 + 2 * j] - mean) + std::abs(y[2 + 2 * j] - mean));
+            }
+
+            // QUADPACK error heuristic: scale |K - G| by the variation of f, never below roundoff
+            const double scale = std::abs(half);
+            double error = std::abs((resk - resg) * half);
+            resasc *= scale;
+            resabs *= scale;
+            if (resasc != 0.0 && error != 0.0)
+                error = resasc * std::min(1.0, std::pow(200.0 * error / resasc, 1.5));
+            const double eps = std::numeric_limits<double>::epsilon();
+            if (resabs > std::numeric_limits<double>::min() / (50.0 * eps))
+                error = std::max(50.0 * eps * resabs, error);
+
+            out.a = a;
+            out.b = b;
+            out.value = resk * half;
+            out.error = error;
+            return size_t(points);
+        }
+
+        template <typename F>
+        QuadratureResult adaptiveKronrod(F &func, const double a, const double b, const QuadratureOptions &options)
+        {
+            QuadratureResult result;
+            std::vector<Subinterval> heap(1);
+            result.evaluations += kronrodRule(func, a, b, options.rule, heap[0]);
+
+            std::vector<Subinterval> popped, children;
+            while (true)
+            {
+                // recompute the totals from scratch each step so no rounding drift accumulates
+                double value = 0.0, error = 0.0;
+                for (const Subinterval &s : heap)
+                {
+                    value += s.value;
+                    error += s.error;
+                }
+                result.value = value;
+                result.error = error;
+                result.intervals = heap.size();
+                const double tolerance = std::max(options.absTol, options.relTol * std::abs(value));
+                if (error <= tolerance)
+                {
+                    result.converged = true;
+                    break;
+                }
+                if (heap.size() >= options.maxIntervals)
+                {
+                    result.converged = false;
+                    break;
+                }
+
+                // take the worst intervals until what is left would already meet the tolerance
+                popped.clear();
+                double remaining = error;
+                while (!heap.empty() && popped.size() < PARALLEL_WIDTH && (popped.empty() || remaining > tolerance))
+                {
+                    std::pop_heap(heap.begin(), heap.end());
+                    remaining -= heap.back().error;
+                    popped.push_back(heap.back());
+                    heap.pop_back();
+                }
+
+                // intervals too narrow to split further mean the tolerance is below roundoff
+                bool exhausted = false;
+                for (const Subinterval &s : popped)
+                {
+                    const double mid = 0.5 * (s.a + s.b);
+                    if (!(mid > s.a && mid < s.b))
+                        exhausted = true;
+                }
+                if (exhausted)
+                {
+                    for (const Subinterval &s : popped)
+                    {
+                        heap.push_back(s);
+                        std::push_heap(heap.begin(), heap.end());
+                    }
+                    result.converged = false;
+                    break;
+                }
+
+                children.resize(2 * popped.size());
+                auto evaluate = [&](size_t i, size_t) {
+                    const Subinterval &parent = popped[i / 2];
+                    const double mid = 0.5 * (parent.a + parent.b);
+                    if (i % 2 == 0)
+                        kronrodRule(func, parent.a, mid, options.rule, children[i]);
+                    else
+                        kronrodRule(func, mid, parent.b, options.rule, children[i]);
+                };
+                if (options.parallel)
+                    ThreadPool::global().parallelFor(0, children.size(), evaluate);
+                else
+                    for (size_t i = 0; i < children.size(); i++)
+                        evaluate(i, 0);
+                result.evaluations += children.size() * size_t(options.rule == GK15 ? 15 : 21);
+
+                for (const Subinterval &child : children)
+                {
+                    heap.push_back(child);
+                    std::push_heap(heap.begin(), heap.end());
+                }
+            }
+            return result;
+        }
+
+        /*
+        RangeMap / MappedIntegrand / MappedBatchIntegrand:
+            Substitutions taking an infinite range onto a finite one, applied to the integrand
+            together with the Jacobian dx/dt.
+                UPPER_INFINITE: [a, inf) <- [0, 1), x = a + t/(1-t)
+                LOWER_INFINITE: (-inf, b] <- (0, 1], x = b - (1-t)/t
+                BOTH_INFINITE: (-inf, inf) <- (-1, 1), x = t/(1-t^2)
+        */
+        struct RangeMap
+        {
+            enum Kind { UPPER_INFINITE, LOWER_INFINITE, BOTH_INFINITE };
+            Kind kind;
+            double limit;
+
+            double map(const double t, double &jacobian) const
+            {
+                if (kind == UPPER_INFINITE)
+                {
+                    const double d = 1.0 - t;
+                    jacobian = 1.0 / (d * d);
+                    return limit + t / d;
+                }
+                if (kind == LOWER_INFINITE)
+                {
+                    jacobian = 1.0 / (t * t);
+                    return limit - (1.0 - t) / t;
+                }
+                const double d = 1.0 - t * t;
+                jacobian = (1.0 + t * t) / (d * d);
+                return t / d;
+            }
+        };
+
+        template <typename F>
+        struct MappedIntegrand
+        {
+            F func;
+            RangeMap range;
+
+            double operator()(const double t)
+            {
+                double jacobian;
+                const double x = range.map(t, jacobian);
+                return func(x) * jacobian;
+            }
+        };
+
+        template <typename F>
+        struct MappedBatchIntegrand
+        {
+            F func;
+            RangeMap range;
+
+            void operator()(const double *t, double *y, const size_t n)
+            {
+                double x[BATCH_SIZE], jacobian[BATCH_SIZE];
+                for (size_t start = 0; start < n; start += BATCH_SIZE)
+                {
+                    const size_t count = std::min(BATCH_SIZE, n - start);
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        x[i] = range.map(t[start + i], jacobian[i]);
+                    }
+                    func(x, y + start, count);
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        y[start + i] *= jacobian[i];
+                    }
+                }
+            }
+        };
+
+        template <typename F>
+        MappedIntegrand<F> mapRange(F func, const RangeMap range)
+        {
+            return MappedIntegrand<F>{func, range};
+        }
+
+        template <typename F>
+        BatchIntegrand<MappedBatchIntegrand<F>> mapRange(BatchIntegrand<F> func, const RangeMap range)
+        {
+            return batch(MappedBatchIntegrand<F>{func.func, range});
+        }
+
+        template <typename F>
+        QuadratureResult gaussKronrod(F func, const double a, const double b, const QuadratureOptions &options)
+        {
+            if (a == b)
+                return QuadratureResult();
+            if (a > b)
+            {
+                QuadratureResult flipped = gaussKronrod(func, b, a, options);
+                flipped.value = -flipped.value;
+                return flipped;
+            }
+
+            const bool lowerInf = std::isinf(a), upperInf = std::isinf(b);
+            if (lowerInf && upperInf)
+            {
+                auto mapped = mapRange(func, RangeMap{RangeMap::BOTH_INFINITE, 0.0});
+                return adaptiveKronrod(mapped, -1.0, 1.0, options);
+            }
+            if (upperInf)
+            {
+                auto mapped = mapRange(func, RangeMap{RangeMap::UPPER_INFINITE, a});
+                return adaptiveKronrod(mapped, 0.0, 1.0, options);
+            }
+            if (lowerInf)
+            {
+                auto mapped = mapRange(func, RangeMap{RangeMap::LOWER_INFINITE, b});
+                return adaptiveKronrod(mapped, 0.0, 1.0, options);
+            }
+            return adaptiveKronrod(func, a, b, options);
+        }
+
+        // ROMBERG
+        template <typename F>
+        RombergIntegrator<F>::RombergIntegrator(F func, const double a, const double b)
+            : func(func), a(a), b(b), evaluations(0)
+        {
+        }
+
+        template <typename F>
+        double RombergIntegrator<F>::refine()
+        {
+            const size_t k = table.size();
+            double trap;
+            if (k == 0)
+            {
+                double x[2] = {a, b}, y[2];
+                evaluatePoints(func, x, y, 2);
+                evaluations += 2;
+                trap = 0.5 * (b - a) * (y[0] + y[1]);
+            }
+            else
+            {
+                // only the midpoints of the previous level's panels are new
+                const size_t count = size_t(1) << (k - 1);
+                const double h = (b - a) / double(size_t(1) << k);
+                double x[BATCH_SIZE], y[BATCH_SIZE];
+                double sum = 0.0;
+                for (size_t start = 0; start < count; start += BATCH_SIZE)
+                {
+                    const size_t n = std::min(BATCH_SIZE, count - start);
+                    for (size_t i = 0; i < n; i++)
+                    {
+                        x[i] = a + double(2 * (start + i) + 1) * h;
+                    }
+                    evaluatePoints(func, x, y, n);
+                    for (size_t i = 0; i < n; i++)
+                    {
+                        sum += y[i];
+                    }
+                }
+                evaluations += count;
+                trap = 0.5 * table[k - 1][0] + h * sum;
+            }
+
+            std::vector<double> row(k + 1);
+            row[0] = trap;
+            double factor = 1.0;
+            for (size_t j = 1; j <= k; j++)
+            {
+                factor *= 4.0;
+                row[j] = row[j - 1] + (row[j - 1] - table[k - 1][j - 1]) / (factor - 1.0);
+            }
+            table.push_back(std::move(row));
+            return table.back().back();
+        }
+
+        template <typename F>
+        QuadratureResult RombergIntegrator<F>::integrate(const double absTol, const double relTol, const size_t maxLevel)
+        {
+            // a few levels first, so coincidentally equal coarse estimates are not taken as convergence
+            const size_t minLevels = 4;
+            QuadratureResult result;
+            result.converged = false;
+            while (table.size() < minLevels || table.size() <= maxLevel)
+            {
+                if (table.size() >= minLevels)
+                {
+                    const double tolerance = std::max(absTol, relTol * std::abs(estimate()));
+                    if (error() <= tolerance)
+                    {
+                        result.converged = true;
+                        break;
+                    }
+                }
+                refine();
+            }
+            if (!result.converged)
+                result.converged = error() <= std::max(absTol, relTol * std::abs(estimate()));
+            result.value = estimate();
+            result.error = error();
+            result.evaluations = evaluations;
+            result.intervals = size_t(1) << (table.size() - 1);
+            return result;
+        }
+
+        template <typename F>
+        size_t RombergIntegrator<F>::levels() const
+        {
+            return table.size();
+        }
+
+        template <typename F>
+        double RombergIntegrator<F>::trapezoid(const size_t level) const
+        {
+            return extrapolated(level, 0);
+        }
+
+        template <typename F>
+        double RombergIntegrator<F>::extrapolated(const size_t level, const size_t order) const
+        {
+            if (level >= table.size() || order > level)
+            {
+                std::cerr << "ERROR: Romberg level " << level << " order " << order << " has not been computed [extrapolated()]" << std::endl;
+                return 0.0;
+            }
+            return table[level][order];
+        }
+
+        template <typename F>
+        double RombergIntegrator<F>::estimate() const
+        {
+            return table.empty() ? 0.0 : table.back().back();
+        }
+
+        template <typename F>
+        double RombergIntegrator<F>::error() const
+        {
+            if (table.size() < 2)
+                return std::numeric_limits<double>::infinity();
+            return std::abs(table.back().back() - table[table.size() - 2].back());
+        }
+
+        template <typename F>
+        size_t RombergIntegrator<F>::evaluationCount() const
+        {
+            return evaluations;
+        }
+
+        template <typename F>
+        QuadratureResult romberg(F func, const double a, const double b, const double absTol, const double relTol, const size_t maxLevel)
+        {
+            RombergIntegrator<F> integrator(func, a, b);
+            return integrator.integrate(absTol, relTol, maxLevel);
+        }
+
+        // MONTE CARLO
+        template <typename F>
+        struct ScalarIntegrand
+        {
+            F func;
+
+            double operator()(const double *x)
+            {
+                return func(x[0]);
+            }
+        };
+
+        template <typename F>
+        ScalarIntegrand<F> toBoxIntegrand(F func)
+        {
+            return ScalarIntegrand<F>{func};
+        }
+
+        // batch integrands already see a 1-D box as a plain array of points
+        template <typename F>
+        BatchIntegrand<F> toBoxIntegrand(BatchIntegrand<F> func)
+        {
+            return func;
+        }
+
+        template <typename F>
+        void evaluateBox(F &func, const double *x, double *y, const size_t n, const size_t d)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                y[i] = func(x + i * d);
+            }
+        }
+
+        template <typename F>
+        void evaluateBox(BatchIntegrand<F> &func, const double *x, double *y, const size_t n, const size_t d)
+        {
+            for (size_t start = 0; start < n; start += BATCH_SIZE)
+            {
+                func.func(x + start * d, y + start, std::min(BATCH_SIZE, n - start));
+            }
+        }
+
+        // mean and sum of squared deviations of a block of samples, merged in block order (Chan et al.)
+        struct BlockMoments
+        {
+            double count = 0.0, mean = 0.0, m2 = 0.0;
+
+            void merge(const BlockMoments &other)
+            {
+                if (other.count == 0.0)
+                    return;
+                const double total = count + other.count;
+                const double delta = other.mean - mean;
+                mean += delta * other.count / total;
+                m2 += other.m2 + delta * delta * count * other.count / total;
+                count = total;
+            }
+        };
+
+        template <typename F>
+        MonteCarloResult monteCarlo(F func, const double a, const double b, const size_t n, const MonteCarloOptions &options)
+        {
+            return monteCarlo(toBoxIntegrand(func), std::vector<double>{a}, std::vector<double>{b}, n, options);
+        }
+
+        template <typename F>
+        MonteCarloResult monteCarlo(F func, const std::vector<double> &lower, const std::vector<double> &upper, const size_t n, const MonteCarloOptions &options)
+        {
+            MonteCarloResult result;
+            const size_t d = lower.size();
+            if (d == 0 || upper.size() != d)
+            {
+                std::cerr << "ERROR: integration bounds must be non-empty and of equal dimension [monteCarlo()]" << std::endl;
+                return result;
+            }
+            if (options.method == SOBOL && d > rng::SobolSequence::MAX_DIMENSIONS)
+            {
+                std::cerr << "ERROR: Sobol sampling supports at most " << rng::SobolSequence::MAX_DIMENSIONS << " dimensions [monteCarlo()]" << std::endl;
+                return result;
+            }
+            if (n == 0)
+                return result;
+
+            std::vector<double> width(d);
+            double volume = 1.0;
+            for (size_t j = 0; j < d; j++)
+            {
+                width[j] = upper[j] - lower[j];
+                volume *= width[j];
+            }
+
+            const SamplingMethod method = options.method;
+            const bool paired = (method == ANTITHETIC || method == STRATIFIED);
+            const bool quasi = (method == SOBOL || method == HALTON);
+            // a unit is one sample, one antithetic pair or one stratum
+            const size_t pointsPerUnit = paired ? 2 : 1;
+            const size_t unitsPerBlock = std::max<size_t>(1, options.blockSize / pointsPerUnit);
+
+            size_t units = n / pointsPerUnit;
+            size_t strataPerAxis = 1;
+            if (method == STRATIFIED)
+            {
+                // largest k with k^d <= n/2
+                while (true)
+                {
+                    size_t cells = 1;
+                    for (size_t j = 0; j < d && cells <= units; j++)
+                        cells *= strataPerAxis + 1;
+                    if (cells > units)
+                        break;
+                    strataPerAxis++;
+                }
+                units = 1;
+                for (size_t j = 0; j < d; j++)
+                    units *= strataPerAxis;
+            }
+            const size_t randomizations = quasi ? std::max<size_t>(2, std::min(options.randomizations, n)) : 1;
+            if (quasi)
+                units = n / randomizations;
+            if (units == 0)
+                units = 1;
+
+            const size_t blocksPerRun = (units + unitsPerBlock - 1) / unitsPerBlock;
+            const size_t tasks = blocksPerRun * randomizations;
+            std::vector<BlockMoments> moments(tasks);
+            std::vector<double> sums(tasks, 0.0), variances(tasks, 0.0);
+
+            ThreadPool &pool = ThreadPool::global();
+            const size_t workers = options.parallel ? pool.size() : 1;
+            std::vector<std::vector<double>> points(workers, std::vector<double>(unitsPerBlock * pointsPerUnit * d));
+            std::vector<std::vector<double>> values(workers, std::vector<double>(unitsPerBlock * pointsPerUnit));
+
+            auto runBlock = [&](size_t task, size_t worker) {
+                const size_t run = task / blocksPerRun;
+                const size_t first = (task % blocksPerRun) * unitsPerBlock;
+                const size_t count = std::min(unitsPerBlock, units - first);
+                double *x = points[worker].data();
+                double *y = values[worker].data();
+
+                if (quasi)
+                {
+                    const uint64_t shiftSeed = options.seed + 0x9E3779B97F4A7C15ull * (run + 1);
+                    if (method == SOBOL)
+                    {
+                        rng::SobolSequence sequence(d);
+                        sequence.randomize(shiftSeed);
+                        sequence.seek(first);
+                        for (size_t i = 0; i < count; i++)
+                            sequence.next(x + i * d);
+                    }
+                    else
+                    {
+                        rng::HaltonSequence sequence(d);
+                        sequence.randomize(shiftSeed);
+                        sequence.seek(first);
+                        for (size_t i = 0; i < count; i++)
+                            sequence.next(x + i * d);
+                    }
+                }
+                else
+                {
+                    rng::Philox4x32 gen(options.seed, task);
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        double *p = x + i * pointsPerUnit * d;
+                        if (method == STRATIFIED)
+                        {
+                            // decode the stratum index into its cell, two jittered points per cell
+                            size_t cell = first + i;
+                            for (size_t j = 0; j < d; j++)
+                            {
+                                const double offset = double(cell % strataPerAxis);
+                                cell /= strataPerAxis;
+                                p[j] = (offset + gen.uniform()) / double(strataPerAxis);
+                                p[d + j] = (offset + gen.uniform()) / double(strataPerAxis);
+                            }
+                        }
+                        else
+                        {
+                            for (size_t j = 0; j < d; j++)
+                            {
+                                p[j] = gen.uniform();
+                                if (method == ANTITHETIC)
+                                    p[d + j] = 1.0 - p[j];
+                            }
+                        }
+                    }
+                }
+
+                // unit cube onto the box
+                const size_t total = count * pointsPerUnit;
+                for (size_t i = 0; i < total; i++)
+                {
+                    for (size_t j = 0; j < d; j++)
+                        x[i * d + j] = lower[j] + x[i * d + j] * width[j];
+                }
+                evaluateBox(func, x, y, total, d);
+
+                if (method == STRATIFIED)
+                {
+                    double sum = 0.0, var = 0.0;
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        const double diff = y[2 * i] - y[2 * i + 1];
+                        sum += 0.5 * (y[2 * i] + y[2 * i + 1]);
+                        var += 0.25 * diff * diff;
+                    }
+                    sums[task] = sum;
+                    variances[task] = var;
+                }
+                else if (quasi)
+                {
+                    double sum = 0.0;
+                    for (size_t i = 0; i < count; i++)
+                        sum += y[i];
+                    sums[task] = sum;
+                }
+                else
+                {
+                    if (method == ANTITHETIC)
+                    {
+                        for (size_t i = 0; i < count; i++)
+                            y[i] = 0.5 * (y[2 * i] + y[2 * i + 1]);
+                    }
+                    BlockMoments block;
+                    double sum = 0.0;
+                    for (size_t i = 0; i < count; i++)
+                        sum += y[i];
+                    block.count = double(count);
+                    block.mean = sum / double(count);
+                    for (size_t i = 0; i < count; i++)
+                        block.m2 += (y[i] - block.mean) * (y[i] - block.mean);
+                    moments[task] = block;
+                }
+            };
+            if (options.parallel)
+                pool.parallelFor(0, tasks, runBlock);
+            else
+                for (size_t task = 0; task < tasks; task++)
+                    runBlock(task, 0);
+
+            // combine in task order so the rounding does not depend on the schedule
+            result.evaluations = units * pointsPerUnit * randomizations;
+            if (method == STRATIFIED)
+            {
+                double sum = 0.0, var = 0.0;
+                for (size_t task = 0; task < tasks; task++)
+                {
+                    sum += sums[task];
+                    var += variances[task];
+                }
+                result.value = volume * sum / double(units);
+                result.stdError = volume * std::sqrt(var) / double(units);
+            }
+            else if (quasi)
+            {
+                BlockMoments runs;
+                for (size_t run = 0; run < randomizations; run++)
+                {
+                    double sum = 0.0;
+                    for (size_t block = 0; block < blocksPerRun; block++)
+                        sum += sums[run * blocksPerRun + block];
+                    BlockMoments single;
+                    single.count = 1.0;
+                    single.mean = volume * sum / double(units);
+                    runs.merge(single);
+                }
+                result.value = runs.mean;
+                result.stdError = std::sqrt(runs.m2 / (runs.count - 1.0) / runs.count);
+            }
+            else
+            {
+                BlockMoments all;
+                for (size_t task = 0; task < tasks; task++)
+                    all.merge(moments[task]);
+                result.value = volume * all.mean;
+                result.stdError = (all.count > 1.0) ? volume * std::sqrt(all.m2 / (all.count - 1.0) / all.count) : 0.0;
+            }
+            return result;
+        }
+
+        // CUBATURE
+        // a pointwise box integrand in one dimension, seen by the 1-D integrators as a batch over its points
+        template <typename F>
+        struct LineIntegrand
+        {
+            F func;
+
+            void operator()(const double *x, double *y, const size_t n)
+            {
+                for (size_t i = 0; i < n; i++)
+                {
+                    y[i] = func(x + i);
+                }
+            }
+        };
+
+        template <typename F>
+        BatchIntegrand<LineIntegrand<F>> toLineIntegrand(F func)
+        {
+            return batch(LineIntegrand<F>{func});
+        }
+
+        template <typename F>
+        BatchIntegrand<F> toLineIntegrand(BatchIntegrand<F> func)
+        {
+            return func;
+        }
+
+        struct Region
+        {
+            std::vector<double> center, halfWidth;
+            double value, error;
+            size_t splitAxis;
+            bool operator<(const Region &other) const { return error < other.error; }
+        };
+
+        inline size_t genzMalikPoints(const size_t d)
+        {
+            return (size_t(1) << d) + 2 * d * d + 2 * d + 1;
+        }
+
+        // applies the degree 7 Genz-Malik rule and its embedded degree 5 rule to a region, x and y hold genzMalikPoints(d) points
+        template <typename F>
+        void genzMalikRule(F &func, Region &region, double *x, double *y)
+        {
+            const size_t d = region.center.size();
+            const double *c = region.center.data();
+            const double *h = region.halfWidth.data();
+            const double lambda2 = std::sqrt(9.0 / 70.0), lambda4 = std::sqrt(9.0 / 10.0), lambda5 = std::sqrt(9.0 / 19.0);
+
+            // point layout: center, +-lambda2 and +-lambda4 on each axis, +-lambda4 on each pair of axes, all corners at lambda5
+            size_t p = 0;
+            auto emit = [&]() -> double * {
+                double *point = x + (p++) * d;
+                for (size_t j = 0; j < d; j++)
+                    point[j] = c[j];
+                return point;
+            };
+            emit();
+            for (size_t i = 0; i < d; i++)
+            {
+                emit()[i] -= lambda2 * h[i];
+                emit()[i] += lambda2 * h[i];
+                emit()[i] -= lambda4 * h[i];
+                emit()[i] += lambda4 * h[i];
+            }
+            for (size_t i = 0; i < d; i++)
+            {
+                for (size_t j = i + 1; j < d; j++)
+                {
+                    for (int signs = 0; signs < 4; signs++)
+                    {
+                        double *point = emit();
+                        point[i] += ((signs & 1) ? lambda4 : -lambda4) * h[i];
+                        point[j] += ((signs & 2) ? lambda4 : -lambda4) * h[j];
+                    }
+                }
+            }
+            for (size_t corner = 0; corner < (size_t(1) << d); corner++)
+            {
+                double *point = emit();
+                for (size_t j = 0; j < d; j++)
+                    point[j] += (((corner >> j) & 1) ? lambda5 : -lambda5) * h[j];
+            }
+            evaluateBox(func, x, y, p, d);
+
+            const double f0 = y[0];
+            double sum2 = 0.0, sum3 = 0.0, sum4 = 0.0, sum5 = 0.0, maxDiff = -1.0;
+            region.splitAxis = 0;
+            for (size_t i = 0; i < d; i++)
+            {
+                const double *f = y + 1 + 4 * i;
+                sum2 += f[0] + f[1];
+                sum3 += f[2] + f[3];
+                // fourth difference along the axis, the ratio (lambda2/lambda4)^2 = 1/7 cancels the quadratic term
+                const double diff = std::abs(f[0] + f[1] - 2.0 * f0 - (f[2] + f[3] - 2.0 * f0) / 7.0);
+                if (diff > maxDiff || (diff == maxDiff && h[i] > h[region.splitAxis]))
+                {
+                    maxDiff = diff;
+                    region.splitAxis = i;
+                }
+            }
+            size_t q = 1 + 4 * d;
+            for (; q < 1 + 4 * d + 2 * d * (d - 1); q++)
+                sum4 += y[q];
+            for (; q < p; q++)
+                sum5 += y[q];
+
+            const double dd = double(d);
+            double volume = 1.0;
+            for (size_t j = 0; j < d; j++)
+                volume *= 2.0 * h[j];
+            const double w1 = (12824.0 - 9120.0 * dd + 400.0 * dd * dd) / 19683.0, w3 = 980.0 / 6561.0;
+            const double w5 = (1820.0 - 400.0 * dd) / 19683.0, w7 = 200.0 / 19683.0;
+            const double w9 = 6859.0 / 19683.0 / double(size_t(1) << d);
+            const double e1 = (729.0 - 950.0 * dd + 50.0 * dd * dd) / 729.0, e3 = 245.0 / 486.0;
+            const double e5 = (265.0 - 100.0 * dd) / 1458.0, e7 = 25.0 / 729.0;
+
+            const double seventh = volume * (w1 * f0 + w3 * sum2 + w5 * sum3 + w7 * sum4 + w9 * sum5);
+            const double fifth = volume * (e1 * f0 + e3 * sum2 + e5 * sum3 + e7 * sum4);
+            region.value = seventh;
+            region.error = std::abs(seventh - fifth);
+        }
+
+        template <typename F>
+        QuadratureResult cubature(F func, const std::vector<double> &lower, const std::vector<double> &upper, const CubatureOptions &options)
+        {
+            QuadratureResult result;
+            const size_t d = lower.size();
+            if (d == 0 || upper.size() != d)
+            {
+                std::cerr << "ERROR: integration bounds must be non-empty and of equal dimension [cubature()]" << std::endl;
+                return result;
+            }
+            if (d == 1)
+            {
+                QuadratureOptions line;
+                line.absTol = options.absTol;
+                line.relTol = options.relTol;
+                line.rule = GK15;
+                line.maxIntervals = std::max<size_t>(1, options.maxEvaluations / 15);
+                line.parallel = options.parallel;
+                return gaussKronrod(toLineIntegrand(func), lower[0], upper[0], line);
+            }
+            if (d >= 8 * sizeof(size_t) - 1)
+            {
+                std::cerr << "ERROR: too many dimensions for cubature, use vegas() [cubature()]" << std::endl;
+                return result;
+            }
+
+            const size_t points = genzMalikPoints(d);
+            ThreadPool &pool = ThreadPool::global();
+            const size_t workers = options.parallel ? pool.size() : 1;
+            std::vector<std::vector<double>> xs(workers, std::vector<double>(points * d)), ys(workers, std::vector<double>(points));
+
+            std::vector<Region> heap(1);
+            heap[0].center.resize(d);
+            heap[0].halfWidth.resize(d);
+            for (size_t j = 0; j < d; j++)
+            {
+                heap[0].center[j] = 0.5 * (lower[j] + upper[j]);
+                heap[0].halfWidth[j] = 0.5 * (upper[j] - lower[j]);
+            }
+            genzMalikRule(func, heap[0], xs[0].data(), ys[0].data());
+            result.evaluations = points;
+
+            std::vector<Region> popped, children;
+            while (true)
+            {
+                double value = 0.0, error = 0.0;
+                for (const Region &r : heap)
+                {
+                    value += r.value;
+                    error += r.error;
+                }
+                result.value = value;
+                result.error = error;
+                result.intervals = heap.size();
+                const double tolerance = std::max(options.absTol, options.relTol * std::abs(value));
+                if (error <= tolerance)
+                {
+                    result.converged = true;
+                    break;
+                }
+                if (result.evaluations + 2 * points > options.maxEvaluations)
+                {
+                    result.converged = false;
+                    break;
+                }
+
+                // as in gaussKronrod: the worst regions until the rest would meet the tolerance, within the budget
+                popped.clear();
+                double remaining = error;
+                while (!heap.empty() && popped.size() < PARALLEL_WIDTH && (popped.empty() || remaining > tolerance) &&
+                       result.evaluations + 2 * points * (popped.size() + 1) <= options.maxEvaluations)
+                {
+                    std::pop_heap(heap.begin(), heap.end());
+                    remaining -= heap.back().error;
+                    popped.push_back(std::move(heap.back()));
+                    heap.pop_back();
+                }
+
+                children.resize(2 * popped.size());
+                for (size_t i = 0; i < popped.size(); i++)
+                {
+                    const size_t axis = popped[i].splitAxis;
+                    const double quarter = 0.5 * popped[i].halfWidth[axis];
+                    for (size_t side = 0; side < 2; side++)
+                    {
+                        Region &child = children[2 * i + side];
+                        child.center = popped[i].center;
+                        child.halfWidth = popped[i].halfWidth;
+                        child.halfWidth[axis] = quarter;
+                        child.center[axis] += side ? quarter : -quarter;
+                    }
+                }
+                auto evaluate = [&](size_t i, size_t worker) {
+                    genzMalikRule(func, children[i], xs[worker].data(), ys[worker].data());
+                };
+                if (options.parallel)
+                    pool.parallelFor(0, children.size(), evaluate);
+                else
+                    for (size_t i = 0; i < children.size(); i++)
+                        evaluate(i, 0);
+                result.evaluations += children.size() * points;
+
+                for (Region &child : children)
+                {
+                    heap.push_back(std::move(child));
+                    std::push_heap(heap.begin(), heap.end());
+                }
+            }
+            return result;
+        }
+
+        // VEGAS
+        // refines one axis of the grid so every new bin carries an equal share of the damped importance weights
+        inline void refineVegasAxis(double *edges, const double *importance, const size_t bins, const double alpha)
+        {
+            std::vector<double> smoothed(bins), weight(bins);
+            if (bins == 1)
+                return;
+            smoothed[0] = 0.5 * (importance[0] + importance[1]);
+            smoothed[bins - 1] = 0.5 * (importance[bins - 2] + importance[bins - 1]);
+            for (size_t i = 1; i + 1 < bins; i++)
+                smoothed[i] = (importance[i - 1] + importance[i] + importance[i + 1]) / 3.0;
+            double total = 0.0;
+            for (size_t i = 0; i < bins; i++)
+                total += smoothed[i];
+            if (!(total > 0.0))
+                return;
+
+            double weightSum = 0.0;
+            for (size_t i = 0; i < bins; i++)
+            {
+                const double r = smoothed[i] / total;
+                weight[i] = (r > 0.0 && r < 1.0) ? std::pow((1.0 - r) / std::log(1.0 / r), alpha) : (r >= 1.0 ? 1.0 : 0.0);
+                weightSum += weight[i];
+            }
+            if (!(weightSum > 0.0))
+                return;
+
+            std::vector<double> newEdges(bins + 1);
+            newEdges[0] = 0.0;
+            newEdges[bins] = 1.0;
+            const double share = weightSum / double(bins);
+            double accumulated = 0.0;
+            size_t i = 0;
+            for (size_t k = 1; k < bins; k++)
+            {
+                const double target = share * double(k);
+                while (i < bins - 1 && accumulated + weight[i] < target)
+                    accumulated += weight[i++];
+                // interpolate linearly inside old bin i
+                const double fraction = (weight[i] > 0.0) ? (target - accumulated) / weight[i] : 0.0;
+                newEdges[k] = edges[i] + std::min(1.0, std::max(0.0, fraction)) * (edges[i + 1] - edges[i]);
+            }
+            for (size_t k = 0; k <= bins; k++)
+                edges[k] = newEdges[k];
+        }
+
+        template <typename F>
+        VegasResult vegas(F func, const std::vector<double> &lower, const std::vector<double> &upper, const VegasOptions &options)
+        {
+            VegasResult result;
+            const size_t d = lower.size();
+            if (d == 0 || upper.size() != d)
+            {
+                std::cerr << "ERROR: integration bounds must be non-empty and of equal dimension [vegas()]" << std::endl;
+                return result;
+            }
+            if (options.iterations == 0 || options.evaluationsPerIteration < 2)
+            {
+                std::cerr << "ERROR: vegas needs at least one iteration of two or more samples [vegas()]" << std::endl;
+                return result;
+            }
+
+            const size_t bins = std::max<size_t>(1, options.bins);
+            const size_t n = options.evaluationsPerIteration;
+            const size_t blockSize = std::max<size_t>(1, options.blockSize);
+            const size_t blocks = (n + blockSize - 1) / blockSize;
+            std::vector<double> width(d);
+            double volume = 1.0;
+            for (size_t j = 0; j < d; j++)
+            {
+                width[j] = upper[j] - lower[j];
+                volume *= width[j];
+            }
+
+            // grid edges on the unit interval, bins + 1 per axis
+            std::vector<double> edges(d * (bins + 1));
+            for (size_t j = 0; j < d; j++)
+                for (size_t k = 0; k <= bins; k++)
+                    edges[j * (bins + 1) + k] = double(k) / double(bins);
+
+            ThreadPool &pool = ThreadPool::global();
+            const size_t workers = options.parallel ? pool.size() : 1;
+            std::vector<std::vector<double>> xs(workers, std::vector<double>(blockSize * d)), ys(workers, std::vector<double>(blockSize));
+            std::vector<std::vector<double>> jacobians(workers, std::vector<double>(blockSize));
+            std::vector<std::vector<uint32_t>> binIndex(workers, std::vector<uint32_t>(blockSize * d));
+            std::vector<BlockMoments> moments(blocks);
+            std::vector<std::vector<double>> importance(blocks, std::vector<double>(d * bins));
+
+            double weightedSum = 0.0, weightSum = 0.0, chi2Sum = 0.0, exactValue = 0.0;
+            size_t accepted = 0;
+            bool exact = false;
+            const size_t totalIterations = options.warmupIterations + options.iterations;
+            for (size_t iteration = 0; iteration < totalIterations; iteration++)
+            {
+                auto runBlock = [&](size_t block, size_t worker) {
+                    const size_t count = std::min(blockSize, n - block * blockSize);
+                    double *x = xs[worker].data();
+                    double *y = ys[worker].data();
+                    double *jac = jacobians[worker].data();
+                    uint32_t *index = binIndex[worker].data();
+                    rng::Philox4x32 gen(options.seed, (uint64_t(iteration) << 32) | block);
+
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        double jacobian = volume;
+                        for (size_t j = 0; j < d; j++)
+                        {
+                            const double *e = &edges[j * (bins + 1)];
+                            const double u = gen.uniform() * double(bins);
+                            const size_t k = std::min(bins - 1, size_t(u));
+                            const double binWidth = e[k + 1] - e[k];
+                            x[i * d + j] = lower[j] + (e[k] + (u - double(k)) * binWidth) * width[j];
+                            jacobian *= double(bins) * binWidth;
+                            index[i * d + j] = uint32_t(k);
+                        }
+                        jac[i] = jacobian;
+                    }
+                    evaluateBox(func, x, y, count, d);
+
+                    BlockMoments m;
+                    double sum = 0.0;
+                    std::vector<double> &imp = importance[block];
+                    std::fill(imp.begin(), imp.end(), 0.0);
+                    for (size_t i = 0; i < count; i++)
+                    {
+                        y[i] *= jac[i];
+                        sum += y[i];
+                        const double squared = y[i] * y[i];
+                        for (size_t j = 0; j < d; j++)
+                            imp[j * bins + index[i * d + j]] += squared;
+                    }
+                    m.count = double(count);
+                    m.mean = sum / double(count);
+                    for (size_t i = 0; i < count; i++)
+                        m.m2 += (y[i] - m.mean) * (y[i] - m.mean);
+                    moments[block] = m;
+                };
+                if (options.parallel)
+                    pool.parallelFor(0, blocks, runBlock);
+                else
+                    for (size_t block = 0; block < blocks; block++)
+                        runBlock(block, 0);
+                result.evaluations += n;
+
+                // reduce in block order
+                BlockMoments all;
+                std::vector<double> total(d * bins, 0.0);
+                for (size_t block = 0; block < blocks; block++)
+                {
+                    all.merge(moments[block]);
+                    for (size_t k = 0; k < d * bins; k++)
+                        total[k] += importance[block][k];
+                }
+
+                if (iteration >= options.warmupIterations)
+                {
+                    const double variance = all.m2 / (all.count - 1.0) / all.count;
+                    if (variance > 0.0)
+                    {
+                        weightedSum += all.mean / variance;
+                        weightSum += 1.0 / variance;
+                        chi2Sum += all.mean * all.mean / variance;
+                        accepted++;
+                    }
+                    else
+                    {
+                        // the map has made f * jacobian constant, this iteration is exact
+                        exact = true;
+                        exactValue = all.mean;
+                    }
+                }
+
+                for (size_t j = 0; j < d; j++)
+                    refineVegasAxis(&edges[j * (bins + 1)], &total[j * bins], bins, options.alpha);
+            }
+
+            if (exact || accepted == 0)
+            {
+                result.value = exactValue;
+                return result;
+            }
+            result.value = weightedSum / weightSum;
+            result.stdError = std::sqrt(1.0 / weightSum);
+            // sum (I_i - I)^2 / sigma_i^2 expanded, over the accepted iterations
+            if (accepted > 1)
+                result.chi2PerDof = std::max(0.0, chi2Sum - weightedSum * result.value) / double(accepted - 1);
+            return result;
+        }
     }
 
-#endif
\ No newline at end of file
+#endif
@@ -1,7 +1,7 @@
 /*
 Programmer: Connor Fricke (cd.fricke23@gmail.com)
 File: Matrix.h
-Latest Revision: 10-Apr-2025
+Latest Revision: 18-Oct-2026
 Synopsis: Header and implementation file for templated matrix class and member routines
 */
 
@@ -9,8 +9,22 @@ Synopsis: Header and implementation file for templated matrix class and member r
 #define MATRIX_H
 
     #include "Vector.h" // dependency
+    #include "Instrument.h"
+    #include "ThreadPool.h"
+    #include <algorithm>
+    #include <memory>
+    #include <type_traits>
+
+    // the double multiply kernel has an AVX2/FMA version selected at run time on x86 GCC/Clang builds
+    #if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+        #define MATRIX_X86_DISPATCH 1
+        #include <immintrin.h>
+    #else
+        #define MATRIX_X86_DISPATCH 0
+    #endif
 
     // CLASS DEFINITION AND MEMBER FUNCTION DECLARATIONS
+    // Elements are stored row-major in a single contiguous block; data[i] points at the start of row i.
     template <typename T>
     class Matrix {
         T** data;
@@ -18,6 +32,8 @@ Synopsis: Header and implementation file for templated matrix class and member r
         // Memory management
         T** allocate(const size_t I, const size_t J);
         void deallocate(T** del, const size_t I);
+        // Kernels
+        static void multiplyBlocked(const T* A, const T* B, T* C, const size_t M, const size_t K, const size_t N);
 
         public:
         // CONSTRUCTORS
@@ -33,13 +49,22 @@ Synopsis: Header and implementation file for templated matrix class and member r
             template <typename U> 
             friend std::ostream& operator<<(std::ostream& out, Matrix<U>& A);
         // ACCESSORS
-            T at(const size_t i, const size_t j) const;
+            T at(const size_t i, const size_t j) const;                 // checked according to BOUNDS_POLICY
+            T& operator()(const size_t i, const size_t j);              // unchecked
+            const T& operator()(const size_t i, const size_t j) const;
+            T* operator[](const size_t i);                              // unchecked row pointer, A[i][j]
+            const T* operator[](const size_t i) const;
             Vector<T> getRow(const size_t i) const;
             Vector<T> getCol(const size_t j) const;
             size_t rows() const;
             size_t cols() const;
+            T* rowData(const size_t i);             // unchecked pointer to the J contiguous elements of row i
+            const T* rowData(const size_t i) const;
+            T* rawData();                           // unchecked pointer to all I*J elements, row-major
+            const T* rawData() const;
+            Matrix<T> transpose() const;
         // MUTATORS
-            void set(const size_t i, const size_t j, const T& val);
+            void set(const size_t i, const size_t j, const T& val);     // checked according to BOUNDS_POLICY
             void resize(const size_t I, const size_t J);
             void clear();
         // OPERATORS
@@ -64,30 +89,31 @@ Synopsis: Header and implementation file for templated matrix class and member r
     {
         if (I == 0 || J == 0)
         {
-            std::cerr << "WARNING: No memory allocated for empty matrix.\n";
+            INSTRUMENT_COUNT("Matrix empty allocation", 0);
             return nullptr;
         }
-        T** newData = new T*[I];
+        INSTRUMENT_COUNT("Matrix allocation", I * J * sizeof(T));
+        // both arrays stay owned until every allocation and assignment has succeeded, so a throw leaks nothing
+        std::unique_ptr<T*[]> newData(new T*[I]);
+        std::unique_ptr<T[]> block(new T[I * J]);
         for (size_t i = 0; i < I; i++)
         {
-            newData[i] = new T[J];
+            newData[i] = block.get() + i * J;
             for (size_t j = 0; j < J; j++)
             {
                 newData[i][j] = (T)0;
             }
         }
-        return newData;
+        block.release();
+        return newData.release();
     }
 
     template <typename T>
-    void Matrix<T>::deallocate(T** del, const size_t I)
+    void Matrix<T>::deallocate(T** del, const size_t /* I */)
     {
         if (!del) {return;} // safeguard
-        // free up memory
-        for (size_t i = 0; i < I; i++)
-        {
-            delete[] del[i];
-        }
+        // free up memory (row pointers all point into the block owned by row 0)
+        delete[] del[0];
         delete[] del;
 
         if (del == this->data) {this->data = nullptr;} 
@@ -121,6 +147,7 @@ Synopsis: Header and implementation file for templated matrix class and member r
     template <typename T>
     Matrix<T>::Matrix(const Matrix<T> &A)
     {
+        INSTRUMENT_COUNT("Matrix copy construct", A.I * A.J * sizeof(T));
         this->data = allocate(A.I, A.J);
         this->I = A.I;
         this->J = A.J;
@@ -136,6 +163,7 @@ Synopsis: Header and implementation file for templated matrix class and member r
     template <typename U>
     Matrix<U>::Matrix(Matrix<U>&& A)
     {
+        INSTRUMENT_COUNT("Matrix move construct", 0);
         // Steal the data
         this->data = A.data;
         this->I = A.I;
@@ -147,22 +175,21 @@ Synopsis: Header and implementation file for templated matrix class and member r
 
     template <typename T>
     Matrix<T>::Matrix(std::initializer_list<std::initializer_list<T>> init) {
+        this->I = init.size();
+        this->J = (init.size() > 0) ? init.begin()->size() : 0;
         for (const auto& row: init) {
-            if (row.size() != init.begin()->size()) {
-                std::cerr << "ERROR: Rows of initializer list must be of equal lengths!\n";
-                Matrix();
-            }
+            DIMENSION_CHECK(row.size() == this->J, "Rows of initializer list must be of equal lengths [Matrix()]");
         }
-
-        this->I = init.size();
-        this->J = init.begin()->size();
         this->data = allocate(this->I, this->J);
         size_t i = 0;
         for (const auto &row : init)
         {
             size_t j = 0;
-            for (const auto &val : row)
-                this->data[i][j++] = val;
+            for (const auto &val : row) {
+                if (j < this->J)            // ragged rows are truncated when unchecked
+                    this->data[i][j] = val;
+                j++;
+            }
             i++;
         }
     }
@@ -233,21 +260,83 @@ Synopsis: Header and implementation file for templated matrix class and member r
     }
 
     template <typename T>
-    T Matrix<T>::at(const size_t i, const size_t j) const {
-        if (i > (this->I - 1) || j > (this->J - 1)) {
-            std::cerr << "ERROR: Out of range [at()]\n";
-            return (T)0;
+    T* Matrix<T>::rowData(const size_t i)
+    {
+        return this->data[i];
+    }
+
+    template <typename T>
+    const T* Matrix<T>::rowData(const size_t i) const
+    {
+        return this->data[i];
+    }
+
+    template <typename T>
+    T* Matrix<T>::rawData()
+    {
+        return (this->data) ? this->data[0] : nullptr;
+    }
+
+    template <typename T>
+    const T* Matrix<T>::rawData() const
+    {
+        return (this->data) ? this->data[0] : nullptr;
+    }
+
+    template <typename T>
+    Matrix<T> Matrix<T>::transpose() const
+    {
+        INSTRUMENT_SCOPE("Matrix transpose");
+        INSTRUMENT_WORK("Matrix transpose", 2 * this->I * this->J * sizeof(T), 0);
+        Matrix<T> result(this->J, this->I);
+        // 32 x 32 tiles keep both the reads and the writes cache friendly
+        const size_t TILE = 32;
+        for (size_t i0 = 0; i0 < this->I; i0 += TILE) {
+            for (size_t j0 = 0; j0 < this->J; j0 += TILE) {
+                for (size_t i = i0; i < std::min(i0 + TILE, this->I); i++) {
+                    for (size_t j = j0; j < std::min(j0 + TILE, this->J); j++) {
+                        result.data[j][i] = this->data[i][j];
+                    }
+                }
+            }
         }
+        return result;
+    }
+
+    template <typename T>
+    T Matrix<T>::at(const size_t i, const size_t j) const {
+        BOUNDS_CHECK(i < this->I && j < this->J, "Matrix index out of range [at()]");
+        return this->data[i][j];
+    }
+
+    template <typename T>
+    T& Matrix<T>::operator()(const size_t i, const size_t j)
+    {
         return this->data[i][j];
     }
 
+    template <typename T>
+    const T& Matrix<T>::operator()(const size_t i, const size_t j) const
+    {
+        return this->data[i][j];
+    }
+
+    template <typename T>
+    T* Matrix<T>::operator[](const size_t i)
+    {
+        return this->data[i];
+    }
+
+    template <typename T>
+    const T* Matrix<T>::operator[](const size_t i) const
+    {
+        return this->data[i];
+    }
+
     template <typename T>
     Vector<T> Matrix<T>::getRow(const size_t i) const
     {
-        if (i > (this->I - 1)) {
-            std::cerr << "ERROR: Out of range! [getRow()]\n";
-            return Vector<T>(0, true);
-        }
+        BOUNDS_CHECK(i < this->I, "Matrix row out of range [getRow()]");
         Vector<T> row(this->J, true);
         for (size_t j = 0; j < this->J; j++) {
             row[j] = data[i][j];
@@ -258,10 +347,7 @@ Synopsis: Header and implementation file for templated matrix class and member r
     template <typename T>
     Vector<T> Matrix<T>::getCol(const size_t j) const
     {
-        if (j > (this->J - 1)) {
-            std::cerr << "ERROR: Out of range! [getCol()]\n";
-            return Vector<T>(0, false);
-        }
+        BOUNDS_CHECK(j < this->J, "Matrix column out of range [getCol()]");
         Vector<T> col(this->I, false);
         for (size_t i = 0; i < this->I; i++) {
             col[i] = data[i][j];
@@ -273,10 +359,7 @@ Synopsis: Header and implementation file for templated matrix class and member r
     template <typename T>
     void Matrix<T>::set(const size_t i, const size_t j, const T& val)
     {
-        if (i > (this->I - 1) || j > (this->J - 1)) {
-            std::cerr << "ERROR: Out of range! [set()]\n";
-            return;
-        }
+        BOUNDS_CHECK(i < this->I && j < this->J, "Matrix index out of range [set()]");
         this->data[i][j] = val;
     }
 
@@ -312,7 +395,7 @@ Synopsis: Header and implementation file for templated matrix class and member r
     template <typename U>
     Matrix<U>& Matrix<U>::operator=(const Matrix<U>& A)
     {
-        std::cout << "[COPY ASSIGNMENT]\n";
+        INSTRUMENT_COUNT("Matrix copy assignment", A.I * A.J * sizeof(U));
         if (this == &A) {
             return *this;
         }
@@ -333,7 +416,7 @@ Synopsis: Header and implementation file for templated matrix class and member r
     template <typename U>
     Matrix<U>& Matrix<U>::operator=(Matrix<U>&& A) 
     {
-        std::cout << "[MOVE ASSIGNMENT]\n";
+        INSTRUMENT_COUNT("Matrix move assignment", 0);
         if (this == &A) {
             return *this;
         }
@@ -357,14 +440,13 @@ Synopsis: Header and implementation file for templated matrix class and member r
     template <typename U>
     Matrix<U> operator+(const Matrix<U>& A, const Matrix<U>& B) 
     {
-        if ((A.I != B.I) || (A.J != B.J)) {
-            std::cerr << "ERROR: Matrices must be the same shape for addition! [operator+]\n";
-            return A;
-        }
+        DIMENSION_CHECK(A.I == B.I && A.J == B.J, "Matrices must be the same shape for addition [operator+]");
+        INSTRUMENT_SCOPE("Matrix operator+");
+        INSTRUMENT_WORK("Matrix operator+", 3 * A.I * A.J * sizeof(U), A.I * A.J);
         Matrix<U> sum(A.I, A.J);
         for (size_t i = 0; i < A.I; i++) {
             for (size_t j = 0; j < A.J; j++) {
-                sum.set(i, j, A.at(i,j) + B.at(i, j));
+                sum.data[i][j] = A.data[i][j] + B.data[i][j];
             }
         }
         return sum;
@@ -376,7 +458,7 @@ Synopsis: Header and implementation file for templated matrix class and member r
         Matrix<U> product(A.I, A.J);
         for (size_t i = 0; i < A.I; i++) {
             for (size_t j = 0; j < A.J; j++) {
-                product.set(i, j, C * A.at(i,j));
+                product.data[i][j] = C * A.data[i][j];
             }
         }
         return product;
@@ -388,7 +470,7 @@ Synopsis: Header and implementation file for templated matrix class and member r
         Matrix<U> product(A.I, A.J);
         for (size_t i = 0; i < A.I; i++) {
             for (size_t j = 0; j < A.J; j++) {
-                product.set(i, j, C * A.at(i,j));
+                product.data[i][j] = C * A.data[i][j];
             }
         }
         return product;
@@ -397,12 +479,146 @@ Synopsis: Header and implementation file for templated matrix class and member r
     template <typename U>
     Matrix<U> operator*(const Matrix<U>& A, const Matrix<U>& B) 
     {
-        if (A.J != B.I) {
-            std::cerr << "Invalid dimensions for matrix multiplication! [operator*]\n";
-            return A;
+        DIMENSION_CHECK(A.J == B.I, "Invalid dimensions for matrix multiplication [operator*]");
+        INSTRUMENT_SCOPE("Matrix operator*");
+        INSTRUMENT_WORK("Matrix operator*", (A.I * A.J + B.I * B.J + A.I * B.J) * sizeof(U), 2 * A.I * A.J * B.J);
+        Matrix<U> product(A.I, B.J);
+        if (A.I == 0 || A.J == 0 || B.J == 0) {
+            return product;
         }
+        Matrix<U>::multiplyBlocked(A.data[0], B.data[0], product.data[0], A.I, A.J, B.J);
+        return product;
+    }
+
+    // KERNELS
+    #if MATRIX_X86_DISPATCH
+    inline bool matrixHasAVX2FMA()
+    {
+        static const bool available = []() {
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        }();
+        return available;
+    }
 
-        // TODO: IMPLEMENT
+    // C[0..4)[0..8) += A[0..4)[k0..k1) * B[k0..k1)[0..8), with row strides K (A) and N (B, C)
+    __attribute__((target("avx2,fma"))) inline void matrixKernel4x8(const double* A, const size_t K, const double* B, const size_t N,
+                                                                     double* C, const size_t k0, const size_t k1)
+    {
+        __m256d c00 = _mm256_loadu_pd(C), c01 = _mm256_loadu_pd(C + 4);
+        __m256d c10 = _mm256_loadu_pd(C + N), c11 = _mm256_loadu_pd(C + N + 4);
+        __m256d c20 = _mm256_loadu_pd(C + 2 * N), c21 = _mm256_loadu_pd(C + 2 * N + 4);
+        __m256d c30 = _mm256_loadu_pd(C + 3 * N), c31 = _mm256_loadu_pd(C + 3 * N + 4);
+        for (size_t k = k0; k < k1; k++)
+        {
+            const __m256d b0 = _mm256_loadu_pd(B + k * N), b1 = _mm256_loadu_pd(B + k * N + 4);
+            __m256d a = _mm256_broadcast_sd(A + k);
+            c00 = _mm256_fmadd_pd(a, b0, c00);
+            c01 = _mm256_fmadd_pd(a, b1, c01);
+            a = _mm256_broadcast_sd(A + K + k);
+            c10 = _mm256_fmadd_pd(a, b0, c10);
+            c11 = _mm256_fmadd_pd(a, b1, c11);
+            a = _mm256_broadcast_sd(A + 2 * K + k);
+            c20 = _mm256_fmadd_pd(a, b0, c20);
+            c21 = _mm256_fmadd_pd(a, b1, c21);
+            a = _mm256_broadcast_sd(A + 3 * K + k);
+            c30 = _mm256_fmadd_pd(a, b0, c30);
+            c31 = _mm256_fmadd_pd(a, b1, c31);
+        }
+        _mm256_storeu_pd(C, c00);
+        _mm256_storeu_pd(C + 4, c01);
+        _mm256_storeu_pd(C + N, c10);
+        _mm256_storeu_pd(C + N + 4, c11);
+        _mm256_storeu_pd(C + 2 * N, c20);
+        _mm256_storeu_pd(C + 2 * N + 4, c21);
+        _mm256_storeu_pd(C + 3 * N, c30);
+        _mm256_storeu_pd(C + 3 * N + 4, c31);
+    }
+    #endif
+
+    /*
+    multiplyBlocked(A, B, C, M, K, N):
+        C (M x N) += A (M x K) * B (K x N), all row-major and contiguous. C is cut into MC x NC tiles that
+        are computed in parallel on the global ThreadPool; within a tile the K dimension is walked in KC
+        slices so the touched rows of B stay in cache, and a 4 x 8 register block of C accumulates over
+        each slice (fixed-size inner loops the compiler keeps in vector registers; an explicit AVX2/FMA
+        kernel for double). Every element of C
+        sums over k in the same order whatever the thread count, so the product is deterministic.
+    */
+    template <typename T>
+    void Matrix<T>::multiplyBlocked(const T* A, const T* B, T* C, const size_t M, const size_t K, const size_t N)
+    {
+        const size_t MC = 64, NC = 256, KC = 256;
+        const size_t rowTiles = (M + MC - 1) / MC, colTiles = (N + NC - 1) / NC;
+
+        auto tile = [&](size_t t, size_t) {
+            const size_t i0 = (t / colTiles) * MC, i1 = std::min(i0 + MC, M);
+            const size_t j0 = (t % colTiles) * NC, j1 = std::min(j0 + NC, N);
+            for (size_t k0 = 0; k0 < K; k0 += KC)
+            {
+                const size_t k1 = std::min(k0 + KC, K);
+                size_t i = i0;
+                for (; i + 4 <= i1; i += 4)
+                {
+                    size_t j = j0;
+                #if MATRIX_X86_DISPATCH
+                    if constexpr (std::is_same<T, double>::value)
+                    {
+                        if (matrixHasAVX2FMA())
+                        {
+                            for (; j + 8 <= j1; j += 8)
+                                matrixKernel4x8(A + i * K, K, B + j, N, C + i * N + j, k0, k1);
+                        }
+                    }
+                #endif
+                    for (; j + 8 <= j1; j += 8)
+                    {
+                        T acc[4][8];
+                        for (size_t r = 0; r < 4; r++)
+                            for (size_t c = 0; c < 8; c++)
+                                acc[r][c] = C[(i + r) * N + j + c];
+                        for (size_t k = k0; k < k1; k++)
+                        {
+                            const T* b = B + k * N + j;
+                            for (size_t r = 0; r < 4; r++)
+                            {
+                                const T a = A[(i + r) * K + k];
+                                for (size_t c = 0; c < 8; c++)
+                                    acc[r][c] += a * b[c];
+                            }
+                        }
+                        for (size_t r = 0; r < 4; r++)
+                            for (size_t c = 0; c < 8; c++)
+                                C[(i + r) * N + j + c] = acc[r][c];
+                    }
+                    // leftover columns
+                    for (size_t r = 0; r < 4; r++)
+                        for (size_t k = k0; k < k1; k++)
+                        {
+                            const T a = A[(i + r) * K + k];
+                            for (size_t jj = j; jj < j1; jj++)
+                                C[(i + r) * N + jj] += a * B[k * N + jj];
+                        }
+                }
+                // leftover rows
+                for (; i < i1; i++)
+                    for (size_t k = k0; k < k1; k++)
+                    {
+                        const T a = A[i * K + k];
+                        for (size_t jj = j0; jj < j1; jj++)
+                            C[i * N + jj] += a * B[k * N + jj];
+                    }
+            }
+        };
+
+        const size_t tiles = rowTiles * colTiles;
+        if (tiles == 1 || double(M) * double(N) * double(K) < 32768.0) {
+            for (size_t t = 0; t < tiles; t++)
+                tile(t, 0);
+        }
+        else {
+            ThreadPool::global().parallelFor(0, tiles, tile);
+        }
     }
 
 
@@ -0,0 +1,848 @@
+/*
+Programmer: Connor Fricke (cd.fricke23@gmail.com)
+File: Pipeline.h
+Latest Revision: 18-Oct-2026
+Synopsis: Header and implementation file for a block-based real-time streaming pipeline of DSP stages
+*/
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+    #include <atomic>
+    #include <chrono>
+    #include <cstdint>
+    #include <exception>
+    #include <functional>
+    #include <memory>
+    #include <mutex>
+    #include <thread>
+    #include <vector>
+    #include "DSP.h"
+    #ifdef __linux__
+        #include <pthread.h>
+        #include <sched.h>
+    #endif
+
+    // DECLARATIONS
+    namespace dsp {
+
+        /*
+        SampleBlock:
+            One fixed-capacity block of samples travelling between two stages. `last` marks the final block
+            of the stream (which may be partially filled or empty).
+        */
+        struct SampleBlock
+        {
+            std::unique_ptr<double[]> samples;
+            size_t count = 0;
+            bool last = false;
+        };
+
+        /*
+        BlockRing:
+            Lock-free single-producer/single-consumer ring of preallocated SampleBlocks. The producer fills the
+            slot returned by acquireWrite() in place and publishes it with commitWrite(); the consumer reads the
+            slot returned by acquireRead() in place and hands it back with releaseRead(). No samples are copied
+            and nothing is allocated after construction. The capacity is rounded up to a power of two.
+        */
+        class BlockRing
+        {
+            std::vector<SampleBlock> slots;
+            size_t mask;
+            size_t blockSize;
+            alignas(64) std::atomic<size_t> head;   // next slot to write, owned by the producer
+            alignas(64) std::atomic<size_t> tail;   // next slot to read, owned by the consumer
+
+        public:
+            BlockRing(const size_t capacity, const size_t blockSize);
+
+            SampleBlock *acquireWrite();    // nullptr while the ring is full
+            void commitWrite();
+            SampleBlock *acquireRead();     // nullptr while the ring is empty
+            void releaseRead();
+
+            size_t occupancy() const;
+            size_t capacity() const;
+            size_t blockCapacity() const;
+        };
+
+        class Pipeline;
+
+        /*
+        BlockWriter:
+            Output port handed to every stage. push() copies samples into the current output block; full blocks
+            are passed on automatically (to the next stage's ring when threaded, or straight into the next stage
+            when fused).
+        */
+        class BlockWriter
+        {
+            friend class Pipeline;
+            double *buffer = nullptr;
+            size_t capacity = 0;
+            size_t count = 0;
+            Pipeline *owner = nullptr;
+            size_t index = 0;
+
+            void flush();
+
+        public:
+            void push(const double value);
+            void push(const double *values, const size_t n);
+        };
+
+        /*
+        SourceStage:
+            Start of a pipeline. generate() pushes the next samples (normally about one block) and returns
+            false once the stream is exhausted.
+        */
+        class SourceStage
+        {
+        public:
+            virtual ~SourceStage() {}
+            virtual bool generate(BlockWriter &out) = 0;
+            virtual const char *name() const { return "source"; }
+        };
+
+        /*
+        PipelineStage:
+            Processing stage. process() consumes n input samples and pushes any number of outputs, keeping its
+            own state between calls. prepare() is called once before the stream starts with the largest input
+            block size, so stages can preallocate, and finish() once after the last block to flush tails.
+        */
+        class PipelineStage
+        {
+        public:
+            virtual ~PipelineStage() {}
+            virtual void prepare(const size_t maxBlock) { (void)maxBlock; }
+            virtual void process(const double *in, const size_t n, BlockWriter &out) = 0;
+            virtual void finish(BlockWriter &out) { (void)out; }
+            virtual const char *name() const { return "stage"; }
+        };
+
+        /*
+        StageCounters:
+            Snapshot of the counters kept for every pipeline element (index 0 is the source).
+                samplesIn / samplesOut: samples consumed and produced
+                blocksIn: input blocks processed
+                busyNanoseconds: time spent inside generate()/process()
+                inputStalls / outputStalls: times the element waited on an empty input ring or a full output ring
+                maxBacklog: largest number of blocks seen queued on the input ring (threaded mode)
+        */
+        struct StageCounters
+        {
+            const char *name = "";
+            uint64_t samplesIn = 0;
+            uint64_t samplesOut = 0;
+            uint64_t blocksIn = 0;
+            uint64_t busyNanoseconds = 0;
+            uint64_t inputStalls = 0;
+            uint64_t outputStalls = 0;
+            uint64_t maxBacklog = 0;
+
+            // throughput while busy, in samples per second
+            double throughput() const;
+        };
+
+        /*
+        Pipeline:
+            Chains a SourceStage through any number of PipelineStages into a sink callback, passing fixed-size
+            blocks. In THREADED mode every element runs on its own thread (optionally pinned to a CPU) and
+            consecutive elements are connected by BlockRings, so latency is bounded by ringBlocks * blockSize
+            samples per link and a slow stage back-pressures its producers instead of growing a queue.
+            In FUSED mode all elements run on the calling thread, each full block being pushed straight through
+            the downstream stages while it is still in cache. After prepare(), neither mode allocates.
+            Stages and the source are held by reference and must outlive the pipeline run.
+            If cpus are given, the calling thread runs pinned to cpus[0] and gets its previous affinity back when
+            run() returns. An exception thrown by the source, a stage or the sink stops the stream; in THREADED
+            mode the other elements drain their rings and exit, and run() rethrows the first exception once every
+            thread has been joined.
+        */
+        class Pipeline
+        {
+            friend class BlockWriter;
+
+            struct Counters
+            {
+                std::atomic<uint64_t> samplesIn{0}, samplesOut{0}, blocksIn{0}, busyNanoseconds{0};
+                std::atomic<uint64_t> inputStalls{0}, outputStalls{0}, maxBacklog{0};
+            };
+
+            size_t blockSize, ringBlocks;
+            SourceStage *source;
+            std::vector<PipelineStage *> stages;
+            std::function<void(const double *, size_t)> sink;
+            std::vector<BlockWriter> writers;                   // writers[e] is the output port of element e
+            std::vector<std::unique_ptr<BlockRing>> rings;      // rings[e] connects element e to e+1 (threaded)
+            std::vector<SampleBlock *> slotsInFlight;           // rings[e] slot currently being written (threaded)
+            std::vector<std::vector<double>> fusedBuffers;      // per element output block (fused)
+            std::unique_ptr<Counters[]> counters;
+            std::atomic<bool> stopRequested;
+            std::atomic<bool> failed;
+            std::exception_ptr error;                           // first exception of a threaded run
+            std::mutex errorMutex;
+            bool threaded;
+
+            // pins the calling thread to cpus[0] (if any) and restores its previous affinity on destruction
+            class CallerPin
+            {
+            #ifdef __linux__
+                cpu_set_t saved;
+            #endif
+                bool restore;
+
+            public:
+                CallerPin(const std::vector<int> &cpus);
+                ~CallerPin();
+            };
+
+            void deliver(const size_t e, const bool last);
+            void consume(const size_t e);
+            void produce();
+            void setup(const bool threaded);
+            void fail(const std::exception_ptr &e);
+            static void pin(const int cpu);
+            static uint64_t now();
+
+        public:
+            enum Mode { FUSED, THREADED };
+
+            Pipeline(const size_t blockSize = 1024, const size_t ringBlocks = 8);
+
+            void setSource(SourceStage &source);
+            void addStage(PipelineStage &stage);
+            void setSink(const std::function<void(const double *, size_t)> &sink);
+
+            // streams until the source is exhausted or stop() is called, then drains every stage
+            void run(const Mode mode = FUSED, const std::vector<int> &cpus = std::vector<int>());
+            // asks the source to stop at its next block, safe to call from any thread
+            void stop();
+
+            // number of elements, including the source
+            size_t size() const;
+            // counters of element e (0 = source), safe to poll while running
+            StageCounters stats(const size_t e) const;
+        };
+
+        // STAGES
+        /*
+        SignalSource: streams generateSignal() over components at SAMPLING_RATE, `total` samples (0 runs until stop()).
+        BufferSource: streams an existing array without copying it up front.
+        FIRStage / IIRStage: streaming lowpassFIR / movingAvgIIR with state carried across blocks.
+        ResampleStage: streaming PolyphaseResampler (L/M).
+        DecimateStage: streaming MultistageDecimator.
+        GoertzelStage: runs goertzelIIR over consecutive frames of `frameLength` samples and emits the DFT magnitude |X[k]| of each frame.
+        */
+        class SignalSource : public SourceStage
+        {
+            std::vector<SignalComponent> components;
+            double rate;
+            size_t total, produced, chunk;
+
+        public:
+            SignalSource(const std::vector<SignalComponent> &components, const double SAMPLING_RATE, const size_t total, const size_t chunk = 1024);
+            bool generate(BlockWriter &out) override;
+            const char *name() const override { return "signal"; }
+        };
+
+        class BufferSource : public SourceStage
+        {
+            const double *data;
+            size_t n, position, chunk;
+
+        public:
+            BufferSource(const double *data, const size_t n, const size_t chunk = 1024);
+            bool generate(BlockWriter &out) override;
+            const char *name() const override { return "buffer"; }
+        };
+
+        class FIRStage : public PipelineStage
+        {
+            double alpha, delay0;
+
+        public:
+            FIRStage(const double alpha);
+            void process(const double *in, const size_t n, BlockWriter &out) override;
+            const char *name() const override { return "lowpassFIR"; }
+        };
+
+        class IIRStage : public PipelineStage
+        {
+            double alpha, delay0;
+
+        public:
+            IIRStage(const double alpha);
+            void process(const double *in, const size_t n, BlockWriter &out) override;
+            const char *name() const override { return "movingAvgIIR"; }
+        };
+
+        class ResampleStage : public PipelineStage
+        {
+            PolyphaseResampler resampler;
+            std::vector<double> scratch;
+
+        public:
+            ResampleStage(const int L, const int M);
+            void prepare(const size_t maxBlock) override;
+            void process(const double *in, const size_t n, BlockWriter &out) override;
+            const char *name() const override { return "resample"; }
+        };
+
+        class DecimateStage : public PipelineStage
+        {
+            MultistageDecimator decimator;
+            std::vector<double> scratch;
+
+        public:
+            DecimateStage(const int factor);
+            void prepare(const size_t maxBlock) override;
+            void process(const double *in, const size_t n, BlockWriter &out) override;
+            const char *name() const override { return "decimate"; }
+        };
+
+        class GoertzelStage : public PipelineStage
+        {
+            size_t frameLength, position;
+            double COS, SIN, drs1, drs2;
+
+        public:
+            GoertzelStage(const int k, const size_t frameLength);
+            void process(const double *in, const size_t n, BlockWriter &out) override;
+            const char *name() const override { return "goertzel"; }
+        };
+    }
+
+    // DEFINITIONS
+    namespace dsp {
+
+        // BLOCK RING
+        inline BlockRing::BlockRing(const size_t capacity, const size_t blockSize)
+        {
+            size_t slotsNeeded = 2;
+            while (slotsNeeded < capacity)
+                slotsNeeded <<= 1;
+            this->slots.resize(slotsNeeded);
+            for (SampleBlock &slot : slots)
+            {
+                slot.samples.reset(new double[blockSize]);
+            }
+            this->mask = slotsNeeded - 1;
+            this->blockSize = blockSize;
+            this->head.store(0);
+            this->tail.store(0);
+        }
+
+        inline SampleBlock *BlockRing::acquireWrite()
+        {
+            const size_t h = head.load(std::memory_order_relaxed);
+            if (h - tail.load(std::memory_order_acquire) == slots.size())
+                return nullptr;
+            return &slots[h & mask];
+        }
+
+        inline void BlockRing::commitWrite()
+        {
+            head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        inline SampleBlock *BlockRing::acquireRead()
+        {
+            const size_t t = tail.load(std::memory_order_relaxed);
+            if (head.load(std::memory_order_acquire) == t)
+                return nullptr;
+            return &slots[t & mask];
+        }
+
+        inline void BlockRing::releaseRead()
+        {
+            tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+
+        inline size_t BlockRing::occupancy() const
+        {
+            return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+        }
+
+        inline size_t BlockRing::capacity() const { return slots.size(); }
+
+        inline size_t BlockRing::blockCapacity() const { return blockSize; }
+
+        // BLOCK WRITER
+        inline void BlockWriter::push(const double value)
+        {
+            buffer[count++] = value;
+            if (count == capacity)
+                flush();
+        }
+
+        inline void BlockWriter::push(const double *values, const size_t n)
+        {
+            size_t done = 0;
+            while (done < n)
+            {
+                const size_t take = std::min(n - done, capacity - count);
+                std::copy(values + done, values + done + take, buffer + count);
+                count += take;
+                done += take;
+                if (count == capacity)
+                    flush();
+            }
+        }
+
+        inline void BlockWriter::flush()
+        {
+            owner->deliver(index, false);
+        }
+
+        inline double StageCounters::throughput() const
+        {
+            const uint64_t samples = (samplesIn > 0) ? samplesIn : samplesOut;
+            return (busyNanoseconds == 0) ? 0.0 : double(samples) * 1e9 / double(busyNanoseconds);
+        }
+
+        // PIPELINE
+        inline Pipeline::Pipeline(const size_t blockSize, const size_t ringBlocks)
+        {
+            this->blockSize = std::max<size_t>(blockSize, 1);
+            this->ringBlocks = std::max<size_t>(ringBlocks, 2);
+            this->source = nullptr;
+            this->stopRequested.store(false);
+            this->failed.store(false);
+            this->threaded = false;
+        }
+
+        inline void Pipeline::setSource(SourceStage &source) { this->source = &source; }
+
+        inline void Pipeline::addStage(PipelineStage &stage) { this->stages.push_back(&stage); }
+
+        inline void Pipeline::setSink(const std::function<void(const double *, size_t)> &sink) { this->sink = sink; }
+
+        inline void Pipeline::stop() { stopRequested.store(true); }
+
+        inline size_t Pipeline::size() const { return stages.size() + 1; }
+
+        inline uint64_t Pipeline::now()
+        {
+            return uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        inline void Pipeline::pin(const int cpu)
+        {
+        #ifdef __linux__
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set);
+        #else
+            (void)cpu;
+        #endif
+        }
+
+        inline Pipeline::CallerPin::CallerPin(const std::vector<int> &cpus)
+        {
+            this->restore = false;
+            if (cpus.empty())
+                return;
+        #ifdef __linux__
+            this->restore = (pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &this->saved) == 0);
+        #endif
+            pin(cpus[0]);
+        }
+
+        inline Pipeline::CallerPin::~CallerPin()
+        {
+        #ifdef __linux__
+            if (restore)
+                pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &saved);
+        #endif
+        }
+
+        inline void Pipeline::fail(const std::exception_ptr &e)
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error)
+                error = e;
+            failed.store(true);
+            stopRequested.store(true);
+        }
+
+        inline StageCounters Pipeline::stats(const size_t e) const
+        {
+            StageCounters s;
+            if (e >= size() || !counters)
+                return s;
+            s.name = (e == 0) ? (source ? source->name() : "source") : stages[e - 1]->name();
+            s.samplesIn = counters[e].samplesIn.load();
+            s.samplesOut = counters[e].samplesOut.load();
+            s.blocksIn = counters[e].blocksIn.load();
+            s.busyNanoseconds = counters[e].busyNanoseconds.load();
+            s.inputStalls = counters[e].inputStalls.load();
+            s.outputStalls = counters[e].outputStalls.load();
+            s.maxBacklog = counters[e].maxBacklog.load();
+            return s;
+        }
+
+        inline void Pipeline::setup(const bool threaded)
+        {
+            const size_t E = size();
+            this->threaded = threaded;
+            counters.reset(new Counters[E]);
+            writers.assign(E, BlockWriter());
+            rings.clear();
+            slotsInFlight.assign(E, nullptr);
+            fusedBuffers.assign(E, std::vector<double>());
+            stopRequested.store(false);
+            failed.store(false);
+            error = nullptr;
+
+            for (size_t e = 0; e < E; e++)
+            {
+                writers[e].owner = this;
+                writers[e].index = e;
+                writers[e].capacity = blockSize;
+                writers[e].count = 0;
+                if (threaded && e + 1 < E)
+                {
+                    // the last element writes straight into the sink and needs no ring
+                    rings.emplace_back(new BlockRing(ringBlocks, blockSize));
+                    slotsInFlight[e] = rings[e]->acquireWrite();
+                    writers[e].buffer = slotsInFlight[e]->samples.get();
+                }
+                else
+                {
+                    fusedBuffers[e].resize(blockSize);
+                    writers[e].buffer = fusedBuffers[e].data();
+                }
+            }
+            for (PipelineStage *stage : stages)
+            {
+                stage->prepare(blockSize);
+            }
+        }
+
+        inline void Pipeline::deliver(const size_t e, const bool last)
+        {
+            BlockWriter &w = writers[e];
+            counters[e].samplesOut.fetch_add(w.count, std::memory_order_relaxed);
+
+            if (e + 1 == size())
+            {
+                // end of the chain
+                if (sink && w.count > 0)
+                    sink(w.buffer, w.count);
+                w.count = 0;
+                return;
+            }
+
+            if (!threaded)
+            {
+                // fused: run the next stage on this block right away
+                const size_t n = w.count;
+                w.count = 0;
+                if (n == 0)
+                    return;
+                Counters &next = counters[e + 1];
+                const uint64_t start = now();
+                stages[e]->process(w.buffer, n, writers[e + 1]);
+                next.busyNanoseconds.fetch_add(now() - start, std::memory_order_relaxed);
+                next.samplesIn.fetch_add(n, std::memory_order_relaxed);
+                next.blocksIn.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+
+            // threaded: publish the slot, then wait for a free one
+            SampleBlock *slot = slotsInFlight[e];
+            slot->count = w.count;
+            slot->last = last;
+            rings[e]->commitWrite();
+            w.count = 0;
+            if (last)
+                return;
+
+            SampleBlock *next = rings[e]->acquireWrite();
+            while (!next)
+            {
+                counters[e].outputStalls.fetch_add(1, std::memory_order_relaxed);
+                std::this_thread::yield();
+                next = rings[e]->acquireWrite();
+            }
+            slotsInFlight[e] = next;
+            w.buffer = next->samples.get();
+        }
+
+        inline void Pipeline::produce()
+        {
+            Counters &c = counters[0];
+            bool more = true;
+            while (more && !stopRequested.load(std::memory_order_relaxed))
+            {
+                const uint64_t start = now();
+                more = source->generate(writers[0]);
+                c.busyNanoseconds.fetch_add(now() - start, std::memory_order_relaxed);
+                c.blocksIn.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        inline void Pipeline::consume(const size_t e)
+        {
+            // element e >= 1 reads rings[e-1] and writes writers[e]; once any element has failed it only drains
+            // its input, so nothing upstream blocks on a full ring, and passes the end of the stream on
+            BlockRing &input = *rings[e - 1];
+            Counters &c = counters[e];
+            PipelineStage *stage = stages[e - 1];
+            bool last = false;
+            while (!last)
+            {
+                SampleBlock *block = input.acquireRead();
+                while (!block)
+                {
+                    c.inputStalls.fetch_add(1, std::memory_order_relaxed);
+                    std::this_thread::yield();
+                    block = input.acquireRead();
+                }
+                const uint64_t backlog = input.occupancy();
+                if (backlog > c.maxBacklog.load(std::memory_order_relaxed))
+                    c.maxBacklog.store(backlog, std::memory_order_relaxed);
+
+                const uint64_t start = now();
+                if (block->count > 0 && !failed.load(std::memory_order_relaxed))
+                {
+                    try
+                    {
+                        stage->process(block->samples.get(), block->count, writers[e]);
+                    }
+                    catch (...)
+                    {
+                        fail(std::current_exception());
+                    }
+                }
+                c.busyNanoseconds.fetch_add(now() - start, std::memory_order_relaxed);
+                c.samplesIn.fetch_add(block->count, std::memory_order_relaxed);
+                c.blocksIn.fetch_add(1, std::memory_order_relaxed);
+
+                last = block->last;
+                input.releaseRead();
+            }
+            try
+            {
+                if (!failed.load())
+                    stage->finish(writers[e]);
+                if (failed.load())
+                    writers[e].count = 0;           // the partial output of a failed stream is dropped
+                deliver(e, true);
+            }
+            catch (...)
+            {
+                // only the last element can get here after delivering (its sink threw), and with nothing
+                // buffered the second deliver() does not call the sink again
+                fail(std::current_exception());
+                writers[e].count = 0;
+                deliver(e, true);
+            }
+        }
+
+        inline void Pipeline::run(const Mode mode, const std::vector<int> &cpus)
+        {
+            if (!source)
+            {
+                std::cerr << "ERROR: Pipeline has no source! [Pipeline::run()]\n";
+                return;
+            }
+            setup(mode == THREADED);
+            const size_t E = size();
+            const CallerPin callerPin(cpus);
+
+            if (mode == FUSED)
+            {
+                // everything runs on this thread, so an exception simply propagates
+                produce();
+                // drain: flush each partial block down the chain, then let the next stage flush its tail
+                for (size_t e = 0; e < E; e++)
+                {
+                    deliver(e, true);
+                    if (e + 1 < E)
+                        stages[e]->finish(writers[e + 1]);
+                }
+                return;
+            }
+
+            std::vector<std::thread> threads;
+            for (size_t e = 1; e < E; e++)
+            {
+                try
+                {
+                    threads.emplace_back([this, e, &cpus]() {
+                        if (!cpus.empty())
+                            pin(cpus[e % cpus.size()]);
+                        consume(e);
+                    });
+                }
+                catch (...)
+                {
+                    // no samples flow before produce(), so the threads already started just pass the end on
+                    fail(std::current_exception());
+                    break;
+                }
+            }
+            try
+            {
+                produce();
+            }
+            catch (...)
+            {
+                fail(std::current_exception());
+                writers[0].count = 0;
+            }
+            deliver(0, true);
+            for (std::thread &t : threads)
+            {
+                t.join();
+            }
+            if (error)
+                std::rethrow_exception(error);
+        }
+
+        // STAGES
+        inline SignalSource::SignalSource(const std::vector<SignalComponent> &components, const double SAMPLING_RATE, const size_t total, const size_t chunk)
+        {
+            this->components = components;
+            this->rate = SAMPLING_RATE;
+            this->total = total;
+            this->produced = 0;
+            this->chunk = std::max<size_t>(chunk, 1);
+        }
+
+        inline bool SignalSource::generate(BlockWriter &out)
+        {
+            size_t n = chunk;
+            if (total != 0)
+                n = std::min(chunk, total - produced);
+            for (size_t i = 0; i < n; i++)
+            {
+                const double t = double(produced + i) / rate;
+                double currentValue = 0.0;
+                for (const SignalComponent &c : components)
+                {
+                    currentValue += c.coeff * sin((2.0 * PI * c.freq * t) + c.phase);
+                }
+                out.push(currentValue);
+            }
+            produced += n;
+            return (total == 0) || (produced < total);
+        }
+
+        inline BufferSource::BufferSource(const double *data, const size_t n, const size_t chunk)
+        {
+            this->data = data;
+            this->n = n;
+            this->position = 0;
+            this->chunk = std::max<size_t>(chunk, 1);
+        }
+
+        inline bool BufferSource::generate(BlockWriter &out)
+        {
+            const size_t take = std::min(chunk, n - position);
+            out.push(data + position, take);
+            position += take;
+            return position < n;
+        }
+
+        inline FIRStage::FIRStage(const double alpha)
+        {
+            this->alpha = alpha;
+            this->delay0 = 0.0;
+        }
+
+        inline void FIRStage::process(const double *in, const size_t n, BlockWriter &out)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                out.push((alpha * in[i]) + ((1.0 - alpha) * delay0));
+                delay0 = in[i];
+            }
+        }
+
+        inline IIRStage::IIRStage(const double alpha)
+        {
+            this->alpha = alpha;
+            this->delay0 = 0.0;
+        }
+
+        inline void IIRStage::process(const double *in, const size_t n, BlockWriter &out)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                delay0 = (alpha * in[i]) + ((1.0 - alpha) * delay0);
+                out.push(delay0);
+            }
+        }
+
+        inline ResampleStage::ResampleStage(const int L, const int M) : resampler(L, M) {}
+
+        inline void ResampleStage::prepare(const size_t maxBlock)
+        {
+            // run one block of silence through so every internal buffer reaches its steady-state size,
+            // reset() keeps the capacity
+            scratch.reserve(maxBlock * size_t(resampler.up()) / size_t(resampler.down()) + 2);
+            std::vector<double> zeros(maxBlock, 0.0);
+            resampler.process(zeros.data(), maxBlock, scratch);
+            resampler.reset();
+            scratch.clear();
+        }
+
+        inline void ResampleStage::process(const double *in, const size_t n, BlockWriter &out)
+        {
+            scratch.clear();
+            resampler.process(in, n, scratch);
+            out.push(scratch.data(), scratch.size());
+        }
+
+        inline DecimateStage::DecimateStage(const int factor) : decimator(factor) {}
+
+        inline void DecimateStage::prepare(const size_t maxBlock)
+        {
+            scratch.reserve(maxBlock + 2);
+            std::vector<double> zeros(maxBlock, 0.0);
+            decimator.process(zeros.data(), maxBlock, scratch);
+            decimator.reset();
+            scratch.clear();
+        }
+
+        inline void DecimateStage::process(const double *in, const size_t n, BlockWriter &out)
+        {
+            scratch.clear();
+            decimator.process(in, n, scratch);
+            out.push(scratch.data(), scratch.size());
+        }
+
+        inline GoertzelStage::GoertzelStage(const int k, const size_t frameLength)
+        {
+            this->frameLength = std::max<size_t>(frameLength, 2);
+            this->position = 0;
+            this->COS = cos(2 * PI * double(k) / double(this->frameLength));
+            this->SIN = sin(2 * PI * double(k) / double(this->frameLength));
+            this->drs1 = 0;
+            this->drs2 = 0;
+        }
+
+        inline void GoertzelStage::process(const double *in, const size_t n, BlockWriter &out)
+        {
+            for (size_t i = 0; i < n; i++)
+            {
+                double drs0 = in[i] + (2 * COS * drs1) - drs2;
+                drs2 = drs1;
+                drs1 = drs0;
+                if (++position == frameLength)
+                {
+                    // same FIR step as goertzelIIR(): y[N] = s[N] - cos()s[N-1] + isin()s[N-1]
+                    double s_N = 2 * COS * drs1 - drs2;
+                    out.push(std::abs(dcomp(s_N - (COS * drs1), SIN * drs1)));
+                    position = 0;
+                    drs1 = 0;
+                    drs2 = 0;
+                }
+            }
+        }
+    }
+
+#endif
@@ -0,0 +1,753 @@
+/*
+Programmer: Connor Fricke (cd.fricke23@gmail.com)
+File: Random.h
+Latest Revision: 18-Oct-2026
+Synopsis: Header and implementation file for random number engines, normal sampling, parallel fills and quasi-random sequences
+*/
+
+#ifndef RANDOM_H
+#define RANDOM_H
+
+    #include <algorithm>
+    #include <atomic>
+    #include <cmath>
+    #include <cstdint>
+    #include <iostream>
+    #include <limits>
+    #include <mutex>
+    #include <random>
+    #include <thread>
+    #include <vector>
+    #include "ThreadPool.h"
+
+    // DECLARATIONS
+    namespace rng {
+        /*
+        splitmix64(uint64_t&):
+            Advances a 64-bit state and returns a well mixed output, used to expand a single seed into
+            the state of the larger engines.
+        */
+        uint64_t splitmix64(uint64_t &state);
+
+        /*
+        toUnit(uint64_t):
+            Maps the top 53 bits of a random integer onto a double in [0, 1).
+        */
+        double toUnit(const uint64_t bits);
+
+        /*
+        Philox4x32:
+            Counter-based generator (Salmon et al., "Parallel random numbers: as easy as 1, 2, 3", 2011).
+            Output block c of stream s is a pure function of (seed, s, c), so any stream can be
+            started at any position in O(1). Give every independent unit of work its own stream
+            and the numbers it sees no longer depend on which thread runs it.
+            Satisfies UniformRandomBitGenerator, so it can drive the <random> distributions.
+        */
+        class Philox4x32
+        {
+            uint32_t key[2];
+            uint64_t streamId;
+            uint64_t counter;       // index of the next 4x32 block
+            uint32_t buffer[4];
+            int used;               // 32-bit words of buffer already consumed
+
+            void generate();
+
+        public:
+            typedef uint64_t result_type;
+        // CONSTRUCTORS
+            explicit Philox4x32(const uint64_t seed = 0, const uint64_t stream = 0);
+        // GENERATION
+            static void block(const uint32_t key[2], const uint32_t counter[4], uint32_t out[4]);
+            uint64_t operator()();
+            double uniform();                                   // [0, 1)
+            void seek(const uint64_t position);                 // jump to the given 64-bit output
+            void discard(const uint64_t n);
+            uint64_t stream() const;
+            static constexpr uint64_t min() { return 0; }
+            static constexpr uint64_t max() { return std::numeric_limits<uint64_t>::max(); }
+        };
+
+        /*
+        Xoshiro256pp:
+            xoshiro256++ (Blackman & Vigna, 2019), a small and very fast 256-bit state generator.
+            jump() advances by 2^128 outputs and longJump() by 2^192, which gives 2^64 (or 2^128)
+            non-overlapping per-thread streams from a single seed.
+        */
+        class Xoshiro256pp
+        {
+            uint64_t s[4];
+
+            void jumpWith(const uint64_t *polynomial);
+
+        public:
+            typedef uint64_t result_type;
+        // CONSTRUCTORS
+            explicit Xoshiro256pp(const uint64_t seed = 0);
+        // GENERATION
+            uint64_t operator()();
+            double uniform();                                   // [0, 1)
+            void jump();
+            void longJump();
+            static constexpr uint64_t min() { return 0; }
+            static constexpr uint64_t max() { return std::numeric_limits<uint64_t>::max(); }
+        };
+
+        /*
+        SobolSequence:
+            Gray-code Sobol low-discrepancy points in [0, 1)^d using the Joe & Kuo (2008) direction numbers,
+            for up to MAX_DIMENSIONS dimensions. seek() jumps to any index, so blocks of the sequence can be
+            generated independently. randomize() applies a random digital shift (Owen-style randomized QMC),
+            which makes each point uniformly distributed while keeping the low discrepancy.
+        */
+        class SobolSequence
+        {
+            size_t dims;
+            std::vector<uint32_t> direction;    // dims x 32 direction numbers
+            std::vector<uint32_t> state;
+            std::vector<uint32_t> shift;
+            uint64_t index;
+
+        public:
+            static const size_t MAX_DIMENSIONS = 16;
+        // CONSTRUCTORS
+            explicit SobolSequence(const size_t dimensions);
+        // GENERATION
+            size_t dimensions() const;
+            void seek(const uint64_t position);
+            void next(double *point);
+            void randomize(const uint64_t seed);
+        };
+
+        /*
+        HaltonSequence:
+            Halton low-discrepancy points in [0, 1)^d, using the first d primes as bases. Every point is
+            computed directly from its index, so seek() is free. randomize() applies a random shift
+            modulo 1 (Cranley-Patterson rotation).
+        */
+        class HaltonSequence
+        {
+            size_t dims;
+            std::vector<uint32_t> bases;
+            std::vector<double> shift;
+            uint64_t index;
+
+        public:
+        // CONSTRUCTORS
+            explicit HaltonSequence(const size_t dimensions);
+        // GENERATION
+            size_t dimensions() const;
+            void seek(const uint64_t position);
+            void next(double *point);
+            void randomize(const uint64_t seed);
+        };
+
+        /*
+        Normal sampling:
+            normal(engine) draws a standard normal variate with the Ziggurat method (Marsaglia & Tsang, 2000;
+            the 128-layer double precision variant of Doornik, 2005). About 99% of draws cost one 64-bit
+            engine output, one multiply and one compare; the rest fall back to the exact wedge or tail test.
+            Works with any engine returning 64 random bits from operator() (Philox4x32, Xoshiro256pp, std::mt19937_64).
+        */
+        template <typename Engine>
+        double normal(Engine &engine);
+
+        /*
+        Buffer fills:
+            fillUniform(engine, out, n, lo, hi) writes n uniform variates on [lo, hi), fillNormal(engine, out, n,
+            mean, sd) writes n normal variates. Raw engine output is produced into a small local block first and
+            converted in a separate tight loop, which the compiler vectorizes. fillNormal runs the Ziggurat fast
+            path over the whole block the same way and finishes the rare edge draws afterwards, so its output is
+            a valid normal sample but not the same numbers as n calls of normal() on that engine.
+            parallelFillUniform/parallelFillNormal(out, n, ..., seed) split the buffer into fixed FILL_BLOCK sized
+            chunks; chunk c is generated from Philox4x32(seed, c) on the global ThreadPool. The output depends
+            only on the seed, never on the number of threads.
+        */
+        const size_t FILL_BLOCK = 65536;
+
+        template <typename Engine, typename T>
+        void fillUniform(Engine &engine, T *out, const size_t n, const double lo = 0.0, const double hi = 1.0);
+        template <typename Engine, typename T>
+        void fillNormal(Engine &engine, T *out, const size_t n, const double mean = 0.0, const double sd = 1.0);
+        template <typename T>
+        void parallelFillUniform(T *out, const size_t n, const double lo, const double hi, const uint64_t seed);
+        template <typename T>
+        void parallelFillNormal(T *out, const size_t n, const double mean, const double sd, const uint64_t seed);
+
+        /*
+        Per-thread engines:
+            threadEngine() returns an Xoshiro256pp owned by the calling thread, started from the process seed
+            advanced by jump() once per stream index, so threads draw from non-overlapping 2^128 long streams
+            without locking. The stream index is stable: the thread that called seedThreadEngines() uses stream 0
+            and background worker w of ThreadPool::global() uses stream w. Any other thread uses the index it set
+            with setThreadStream(), or else the next free index from ThreadPool::globalSize() up, handed out in
+            order of first use (only then does it depend on scheduling); threadEngine() never builds the global
+            pool. The jumped states are computed once per seed and shared. seedThreadEngines(seed) sets the
+            process seed; engines restart from it at their next call. Until it is called the process seed comes
+            from std::random_device.
+            Each thread's sequence is reproducible, but which thread runs which iteration of a parallel loop is
+            not: for output independent of the thread count, key streams to the data (Philox4x32(seed, index),
+            parallelFill*).
+        */
+        Xoshiro256pp &threadEngine();
+        void seedThreadEngines(const uint64_t seed);
+        void setThreadStream(const uint64_t stream);
+    }
+
+    // DEFINITIONS
+    namespace rng {
+
+        inline uint64_t splitmix64(uint64_t &state)
+        {
+            uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
+
+        inline double toUnit(const uint64_t bits)
+        {
+            return double(bits >> 11) * 0x1.0p-53;
+        }
+
+        // PHILOX4X32
+        inline Philox4x32::Philox4x32(const uint64_t seed, const uint64_t stream)
+        {
+            this->key[0] = uint32_t(seed);
+            this->key[1] = uint32_t(seed >> 32);
+            this->streamId = stream;
+            this->counter = 0;
+            this->used = 4;
+        }
+
+        inline void Philox4x32::block(const uint32_t key[2], const uint32_t counter[4], uint32_t out[4])
+        {
+            uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+            uint32_t k0 = key[0], k1 = key[1];
+            for (int round = 0; round < 10; round++)
+            {
+                const uint64_t p0 = uint64_t(0xD2511F53u) * c0;
+                const uint64_t p1 = uint64_t(0xCD9E8D57u) * c2;
+                const uint32_t n0 = uint32_t(p1 >> 32) ^ c1 ^ k0;
+                const uint32_t n2 = uint32_t(p0 >> 32) ^ c3 ^ k1;
+                c1 = uint32_t(p1);
+                c3 = uint32_t(p0);
+                c0 = n0;
+                c2 = n2;
+                k0 += 0x9E3779B9u;
+                k1 += 0xBB67AE85u;
+            }
+            out[0] = c0;
+            out[1] = c1;
+            out[2] = c2;
+            out[3] = c3;
+        }
+
+        inline void Philox4x32::generate()
+        {
+            // the low half of the counter walks the stream, the high half selects it
+            const uint32_t ctr[4] = {uint32_t(counter), uint32_t(counter >> 32), uint32_t(streamId), uint32_t(streamId >> 32)};
+            block(key, ctr, buffer);
+            counter++;
+            used = 0;
+        }
+
+        inline uint64_t Philox4x32::operator()()
+        {
+            if (used >= 4)
+                generate();
+            const uint64_t result = uint64_t(buffer[used]) | (uint64_t(buffer[used + 1]) << 32);
+            used += 2;
+            return result;
+        }
+
+        inline double Philox4x32::uniform()
+        {
+            return toUnit((*this)());
+        }
+
+        inline void Philox4x32::seek(const uint64_t position)
+        {
+            // two 64-bit outputs per block
+            counter = position / 2;
+            used = 4;
+            if (position % 2 == 1)
+            {
+                generate();
+                used = 2;
+            }
+        }
+
+        inline void Philox4x32::discard(const uint64_t n)
+        {
+            const uint64_t position = (used >= 4) ? 2 * counter : 2 * (counter - 1) + uint64_t(used / 2);
+            seek(position + n);
+        }
+
+        inline uint64_t Philox4x32::stream() const
+        {
+            return streamId;
+        }
+
+        // XOSHIRO256++
+        inline Xoshiro256pp::Xoshiro256pp(const uint64_t seed)
+        {
+            uint64_t sm = seed;
+            for (int i = 0; i < 4; i++)
+            {
+                this->s[i] = splitmix64(sm);
+            }
+        }
+
+        inline uint64_t Xoshiro256pp::operator()()
+        {
+            auto rotl = [](const uint64_t x, const int k) { return (x << k) | (x >> (64 - k)); };
+            const uint64_t result = rotl(s[0] + s[3], 23) + s[0];
+            const uint64_t t = s[1] << 17;
+            s[2] ^= s[0];
+            s[3] ^= s[1];
+            s[1] ^= s[2];
+            s[0] ^= s[3];
+            s[2] ^= t;
+            s[3] = rotl(s[3], 45);
+            return result;
+        }
+
+        inline double Xoshiro256pp::uniform()
+        {
+            return toUnit((*this)());
+        }
+
+        inline void Xoshiro256pp::jumpWith(const uint64_t *polynomial)
+        {
+            uint64_t t[4] = {0, 0, 0, 0};
+            for (int i = 0; i < 4; i++)
+            {
+                for (int b = 0; b < 64; b++)
+                {
+                    if (polynomial[i] & (uint64_t(1) << b))
+                    {
+                        for (int j = 0; j < 4; j++)
+                            t[j] ^= s[j];
+                    }
+                    (*this)();
+                }
+            }
+            for (int j = 0; j < 4; j++)
+                s[j] = t[j];
+        }
+
+        inline void Xoshiro256pp::jump()
+        {
+            static const uint64_t JUMP[4] = {0x180EC6D33CFD0ABAull, 0xD5A61266F0C9392Cull, 0xA9582618E03FC9AAull, 0x39ABDC4529B1661Cull};
+            jumpWith(JUMP);
+        }
+
+        inline void Xoshiro256pp::longJump()
+        {
+            static const uint64_t LONG_JUMP[4] = {0x76E15D3EFEFDCBBFull, 0xC5004E441C522FB3ull, 0x77710069854EE241ull, 0x39109BB02ACBE635ull};
+            jumpWith(LONG_JUMP);
+        }
+
+        // SOBOLSEQUENCE
+        inline SobolSequence::SobolSequence(const size_t dimensions)
+        {
+            // Joe & Kuo new-joe-kuo-6.21201: degree s, coefficients a and initial numbers m of dimensions 2..16
+            static const uint32_t S[15] = {1, 2, 3, 3, 4, 4, 5, 5, 5, 5, 5, 5, 6, 6, 6};
+            static const uint32_t A[15] = {0, 1, 1, 2, 1, 4, 2, 4, 7, 11, 13, 14, 1, 13, 16};
+            static const uint32_t M[15][6] = {
+                {1}, {1, 3}, {1, 3, 1}, {1, 1, 1}, {1, 1, 3, 3}, {1, 3, 5, 13}, {1, 1, 5, 5, 17},
+                {1, 1, 5, 5, 5}, {1, 1, 7, 11, 19}, {1, 1, 5, 1, 1}, {1, 1, 1, 3, 11}, {1, 3, 5, 5, 31},
+                {1, 3, 3, 9, 7, 49}, {1, 1, 1, 15, 21, 21}, {1, 3, 1, 13, 27, 49}};
+
+            size_t d = dimensions;
+            if (d == 0 || d > MAX_DIMENSIONS)
+            {
+                std::cerr << "ERROR: Sobol sequence supports 1 to " << MAX_DIMENSIONS << " dimensions [SobolSequence()]" << std::endl;
+                d = (d == 0) ? 1 : MAX_DIMENSIONS;
+            }
+            this->dims = d;
+            this->direction.assign(d * 32, 0);
+            this->state.assign(d, 0);
+            this->shift.assign(d, 0);
+            this->index = 0;
+
+            for (int k = 0; k < 32; k++)
+            {
+                direction[k] = uint32_t(1) << (31 - k);
+            }
+            for (size_t j = 1; j < d; j++)
+            {
+                uint32_t *v = &direction[j * 32];
+                const uint32_t s = S[j - 1], a = A[j - 1];
+                for (uint32_t k = 0; k < s; k++)
+                {
+                    v[k] = M[j - 1][k] << (31 - k);
+                }
+                for (uint32_t k = s; k < 32; k++)
+                {
+                    v[k] = v[k - s] ^ (v[k - s] >> s);
+                    for (uint32_t i = 1; i < s; i++)
+                    {
+                        if ((a >> (s - 1 - i)) & 1)
+                            v[k] ^= v[k - i];
+                    }
+                }
+            }
+        }
+
+        inline size_t SobolSequence::dimensions() const
+        {
+            return dims;
+        }
+
+        inline void SobolSequence::seek(const uint64_t position)
+        {
+            index = position;
+            const uint64_t gray = position ^ (position >> 1);
+            for (size_t j = 0; j < dims; j++)
+            {
+                uint32_t x = 0;
+                for (int k = 0; k < 32; k++)
+                {
+                    if ((gray >> k) & 1)
+                        x ^= direction[j * 32 + k];
+                }
+                state[j] = x;
+            }
+        }
+
+        inline void SobolSequence::next(double *point)
+        {
+            for (size_t j = 0; j < dims; j++)
+            {
+                point[j] = double(state[j] ^ shift[j]) * 0x1.0p-32;
+            }
+            // consecutive gray codes differ in the lowest set bit of the new index
+            index++;
+            int bit = 0;
+            while (bit < 31 && !((index >> bit) & 1))
+                bit++;
+            for (size_t j = 0; j < dims; j++)
+            {
+                state[j] ^= direction[j * 32 + bit];
+            }
+        }
+
+        inline void SobolSequence::randomize(const uint64_t seed)
+        {
+            Philox4x32 gen(seed, 0x50B01u);
+            for (size_t j = 0; j < dims; j++)
+            {
+                shift[j] = uint32_t(gen() >> 32);
+            }
+        }
+
+        // HALTONSEQUENCE
+        inline HaltonSequence::HaltonSequence(const size_t dimensions)
+        {
+            size_t d = dimensions;
+            if (d == 0)
+            {
+                std::cerr << "ERROR: Halton sequence needs at least one dimension [HaltonSequence()]" << std::endl;
+                d = 1;
+            }
+            this->dims = d;
+            this->shift.assign(d, 0.0);
+            this->index = 0;
+            for (uint32_t candidate = 2; bases.size() < d; candidate++)
+            {
+                bool prime = true;
+                for (uint32_t p : bases)
+                {
+                    if (p * p > candidate)
+                        break;
+                    if (candidate % p == 0)
+                    {
+                        prime = false;
+                        break;
+                    }
+                }
+                if (prime)
+                    bases.push_back(candidate);
+            }
+        }
+
+        inline size_t HaltonSequence::dimensions() const
+        {
+            return dims;
+        }
+
+        inline void HaltonSequence::seek(const uint64_t position)
+        {
+            index = position;
+        }
+
+        inline void HaltonSequence::next(double *point)
+        {
+            for (size_t j = 0; j < dims; j++)
+            {
+                // radical inverse of the index in base b
+                const uint32_t b = bases[j];
+                const double inverse = 1.0 / double(b);
+                double factor = inverse, x = 0.0;
+                for (uint64_t i = index; i > 0; i /= b)
+                {
+                    x += double(i % b) * factor;
+                    factor *= inverse;
+                }
+                x += shift[j];
+                point[j] = (x >= 1.0) ? x - 1.0 : x;
+            }
+            index++;
+        }
+
+        inline void HaltonSequence::randomize(const uint64_t seed)
+        {
+            Philox4x32 gen(seed, 0x4A17u);
+            for (size_t j = 0; j < dims; j++)
+            {
+                shift[j] = gen.uniform();
+            }
+        }
+
+        // NORMAL()
+        struct ZigguratTables
+        {
+            static const int LAYERS = 128;
+            double x[LAYERS + 1];       // layer edges, x[1] is the start of the tail
+            double ratio[LAYERS];       // x[i + 1] / x[i], the fraction of layer i inside the curve
+
+            ZigguratTables()
+            {
+                const double R = 3.442619855899, V = 9.91256303526217e-3;
+                double f = std::exp(-0.5 * R * R);
+                x[0] = V / f;
+                x[1] = R;
+                x[LAYERS] = 0.0;
+                for (int i = 2; i < LAYERS; i++)
+                {
+                    x[i] = std::sqrt(-2.0 * std::log(V / x[i - 1] + f));
+                    f = std::exp(-0.5 * x[i] * x[i]);
+                }
+                for (int i = 0; i < LAYERS; i++)
+                {
+                    ratio[i] = x[i + 1] / x[i];
+                }
+            }
+        };
+
+        inline const ZigguratTables &zigguratTables()
+        {
+            static const ZigguratTables tables;
+            return tables;
+        }
+
+        // the slow part of the Ziggurat for a draw outside its layer's rectangle: the tail or wedge test,
+        // false when the draw is rejected and a new one must be made
+        template <typename Engine>
+        bool zigguratEdge(Engine &engine, const uint64_t bits, double &out)
+        {
+            const ZigguratTables &z = zigguratTables();
+            const double u = 2.0 * toUnit(bits) - 1.0;
+            const int i = int(bits & 0x7F);
+            if (i == 0)
+            {
+                // tail beyond R (Marsaglia, 1964)
+                double x, y;
+                do
+                {
+                    x = std::log(1.0 - toUnit(engine())) / z.x[1];
+                    y = std::log(1.0 - toUnit(engine()));
+                } while (-2.0 * y < x * x);
+                out = (u < 0.0) ? x - z.x[1] : z.x[1] - x;
+                return true;
+            }
+            // wedge between the layer rectangle and the curve
+            const double x = u * z.x[i];
+            const double f0 = std::exp(-0.5 * (z.x[i] * z.x[i] - x * x));
+            const double f1 = std::exp(-0.5 * (z.x[i + 1] * z.x[i + 1] - x * x));
+            out = x;
+            return f1 + toUnit(engine()) * (f0 - f1) < 1.0;
+        }
+
+        template <typename Engine>
+        double normal(Engine &engine)
+        {
+            const ZigguratTables &z = zigguratTables();
+            for (;;)
+            {
+                // the top 53 bits give u in [-1, 1), the low 7 bits pick the layer
+                const uint64_t bits = engine();
+                const double u = 2.0 * toUnit(bits) - 1.0;
+                const int i = int(bits & 0x7F);
+                if (std::fabs(u) < z.ratio[i])
+                    return u * z.x[i];
+                double x;
+                if (zigguratEdge(engine, bits, x))
+                    return x;
+            }
+        }
+
+        // FILLUNIFORM() / FILLNORMAL()
+        template <typename Engine, typename T>
+        void fillUniform(Engine &engine, T *out, const size_t n, const double lo, const double hi)
+        {
+            const size_t CHUNK = 256;
+            uint64_t bits[CHUNK];
+            const double scale = (hi - lo) * 0x1.0p-53;
+            for (size_t first = 0; first < n; first += CHUNK)
+            {
+                const size_t count = std::min(CHUNK, n - first);
+                for (size_t i = 0; i < count; i++)
+                    bits[i] = engine();
+                for (size_t i = 0; i < count; i++)
+                    out[first + i] = T(lo + double(int64_t(bits[i] >> 11)) * scale);
+            }
+        }
+
+        template <typename Engine, typename T>
+        void fillNormal(Engine &engine, T *out, const size_t n, const double mean, const double sd)
+        {
+            // the Ziggurat fast path runs branch-free over a block of raw draws, and the few draws outside
+            // their layer's rectangle are finished afterwards with the same bits
+            const ZigguratTables &z = zigguratTables();
+            const size_t CHUNK = 256;
+            uint64_t bits[CHUNK];
+            unsigned char edge[CHUNK];
+            for (size_t first = 0; first < n; first += CHUNK)
+            {
+                const size_t count = std::min(CHUNK, n - first);
+                for (size_t i = 0; i < count; i++)
+                    bits[i] = engine();
+                for (size_t i = 0; i < count; i++)
+                {
+                    const double u = 2.0 * double(int64_t(bits[i] >> 11)) * 0x1.0p-53 - 1.0;
+                    const int layer = int(bits[i] & 0x7F);
+                    edge[i] = !(std::fabs(u) < z.ratio[layer]);
+                    out[first + i] = T(mean + sd * (u * z.x[layer]));
+                }
+                for (size_t i = 0; i < count; i++)
+                {
+                    if (!edge[i])
+                        continue;
+                    double x;
+                    if (!zigguratEdge(engine, bits[i], x))
+                        x = normal(engine);
+                    out[first + i] = T(mean + sd * x);
+                }
+            }
+        }
+
+        // PARALLELFILLUNIFORM() / PARALLELFILLNORMAL()
+        template <typename T>
+        void parallelFillUniform(T *out, const size_t n, const double lo, const double hi, const uint64_t seed)
+        {
+            const size_t blocks = (n + FILL_BLOCK - 1) / FILL_BLOCK;
+            ThreadPool::global().parallelFor(0, blocks, [&](size_t b, size_t) {
+                Philox4x32 engine(seed, b);
+                const size_t first = b * FILL_BLOCK;
+                fillUniform(engine, out + first, std::min(FILL_BLOCK, n - first), lo, hi);
+            });
+        }
+
+        template <typename T>
+        void parallelFillNormal(T *out, const size_t n, const double mean, const double sd, const uint64_t seed)
+        {
+            const size_t blocks = (n + FILL_BLOCK - 1) / FILL_BLOCK;
+            ThreadPool::global().parallelFor(0, blocks, [&](size_t b, size_t) {
+                Philox4x32 engine(seed, b);
+                const size_t first = b * FILL_BLOCK;
+                fillNormal(engine, out + first, std::min(FILL_BLOCK, n - first), mean, sd);
+            });
+        }
+
+        // THREADENGINE()
+        struct ThreadEngineSeed
+        {
+            std::mutex lock;                        // guards everything below except epoch
+            std::atomic<uint64_t> epoch;            // bumped by every seedThreadEngines()
+            std::thread::id seeder;                 // draws stream 0
+            uint64_t nextStream;                    // next index for threads without a stable one
+            std::vector<Xoshiro256pp> streams;      // streams[k]: the seed engine jumped k times
+
+            ThreadEngineSeed() : epoch(0), nextStream(0)
+            {
+                streams.push_back(Xoshiro256pp((uint64_t(std::random_device()()) << 32) | std::random_device()()));
+            }
+        };
+
+        inline ThreadEngineSeed &threadEngineSeed()
+        {
+            static ThreadEngineSeed state;
+            return state;
+        }
+
+        inline uint64_t &threadStream()
+        {
+            thread_local uint64_t stream = ~uint64_t(0);    // none set
+            return stream;
+        }
+
+        inline uint64_t &threadEngineEpoch()
+        {
+            thread_local uint64_t epoch = ~uint64_t(0);     // seed epoch the thread's engine was started from
+            return epoch;
+        }
+
+        inline Xoshiro256pp &threadEngine()
+        {
+            thread_local Xoshiro256pp engine;
+            uint64_t &epoch = threadEngineEpoch();
+            ThreadEngineSeed &state = threadEngineSeed();
+            const uint64_t current = state.epoch.load(std::memory_order_acquire);
+            if (epoch != current)
+            {
+                // only background threads of an existing global pool have a worker index; the pool is never built here
+                const ThreadPool *pool = ThreadPool::workerOf();
+                const size_t worker = (pool != nullptr && pool->isGlobal()) ? pool->workerIndex() : 0;
+                std::lock_guard<std::mutex> guard(state.lock);
+                uint64_t stream;
+                if (threadStream() != ~uint64_t(0))
+                    stream = threadStream();
+                else if (worker > 0)
+                    stream = worker;
+                else if (std::this_thread::get_id() == state.seeder)
+                    stream = 0;
+                else
+                {
+                    state.nextStream = std::max<uint64_t>(state.nextStream, ThreadPool::globalSize());
+                    stream = state.nextStream++;
+                }
+                while (state.streams.size() <= stream)
+                {
+                    Xoshiro256pp next = state.streams.back();
+                    next.jump();
+                    state.streams.push_back(next);
+                }
+                engine = state.streams[stream];
+                epoch = current;
+            }
+            return engine;
+        }
+
+        inline void seedThreadEngines(const uint64_t seed)
+        {
+            ThreadEngineSeed &state = threadEngineSeed();
+            {
+                std::lock_guard<std::mutex> guard(state.lock);
+                state.seeder = std::this_thread::get_id();
+                state.nextStream = 0;
+                state.streams.assign(1, Xoshiro256pp(seed));
+            }
+            state.epoch.fetch_add(1, std::memory_order_release);
+        }
+
+        inline void setThreadStream(const uint64_t stream)
+        {
+            threadStream() = stream;
+            threadEngineEpoch() = ~uint64_t(0);     // restart the calling thread's engine at its next call
+        }
+    }
+
+#endif
@@ -1,7 +1,7 @@
 /*
 Programmer: Connor Fricke (cd.fricke23@gmail.com)
 File: Stats.h
-Latest Revision: 22-Feb-2024
+Latest Revision: 18-Oct-2026
 Synopsis: Header and implementation file for statistics routines
 */
 
@@ -9,8 +9,27 @@ Synopsis: Header and implementation file for statistics routines
 #define STATS_H
 
     #include <cstdlib>
+    #include <algorithm>
+    #include <cmath>
+    #include <cstdint>
+    #include <cstring>
+    #include <iostream>
+    #include <limits>
+    #include <type_traits>
     #include <vector>
     #include <random>
+    #include "Instrument.h"
+    #include "Matrix.h"
+    #include "Random.h"
+    #include "ThreadPool.h"
+
+    // reduction kernels have AVX2 versions selected at run time on x86 GCC/Clang builds
+    #if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+        #define STATS_X86_DISPATCH 1
+        #include <immintrin.h>
+    #else
+        #define STATS_X86_DISPATCH 0
+    #endif
 
     // DECLARATIONS
     namespace stats {
@@ -19,81 +38,1881 @@ Synopsis: Header and implementation file for statistics routines
 
         // SUM()
         template <typename T>
-        T sum(std::vector<T> arr);
-        
+        T sum(const std::vector<T> &arr);
+
         // MEAN()
         template <typename T>
-        double mean(std::vector<T> arr);
+        double mean(const std::vector<T> &arr);
 
         // STDEV()
+        /* population standard deviation, sqrt(sum (x - mean)^2 / N) */
         template <typename T>
-        double stdev(std::vector<T> arr);
+        double stdev(const std::vector<T> &arr);
 
         // REALDISTRIBUTION
+        /*
+        realDistribution(dist, num_samples, min, max, [seed]):
+            num_samples variates, UNIFORM on [min, max) or GAUSSIAN with mean min and standard deviation max.
+            Filled in parallel from counter-based Philox streams (see rng::parallelFillUniform), so a given
+            seed reproduces the same samples on any thread count. UNIFORM samples are also the same on any
+            machine; GAUSSIAN ones can differ in the last bits between C math libraries, since the Ziggurat
+            tables and its wedge and tail tests use exp and log. Without a seed, one is drawn from std::random_device.
+        */
         std::vector<double> realDistribution(const int dist, const int num_samples, const double min, const double max);
+        std::vector<double> realDistribution(const int dist, const int num_samples, const double min, const double max, const uint64_t seed);
+
+        /*
+        Parallel reductions:
+            sum, mean, variance, stdev, min, max and dot over raw arrays (pointer + count) or vectors.
+            The data is cut into blocks of REDUCTION_BLOCK elements, which are reduced on the global ThreadPool.
+            Within a block, 8 independent lanes are accumulated (AVX2 where available, otherwise a scalar loop
+            with the same lane order) in double precision for float and double data. The block results are then
+            combined by pairwise summation (or pairwise Chan merges for the variance) in block order. The block
+            layout does not depend on the thread count, so results are bit-identical on 1 or 64 threads, and
+            rounding error grows like O(log n) rather than O(n). Integer sums are accumulated exactly in T.
+            sum() of other element types (std::complex, derivative::Dual, ...) uses the same blocks, accumulated in T;
+            mean, variance, stdev and dot take arithmetic types only.
+        */
+        const size_t REDUCTION_BLOCK = 16384;
+
+        template <typename T>
+        T sum(const T *data, const size_t n);
+        template <typename T>
+        double mean(const T *data, const size_t n);
+        template <typename T>
+        double variance(const T *data, const size_t n);     // population, divides by N
+        template <typename T>
+        double variance(const std::vector<T> &arr);
+        template <typename T>
+        double stdev(const T *data, const size_t n);
+        template <typename T>
+        T min(const T *data, const size_t n);
+        template <typename T>
+        T min(const std::vector<T> &arr);
+        template <typename T>
+        T max(const T *data, const size_t n);
+        template <typename T>
+        T max(const std::vector<T> &arr);
+        template <typename T>
+        double dot(const T *a, const T *b, const size_t n);
+        template <typename T>
+        double dot(const std::vector<T> &a, const std::vector<T> &b);
+
+        /*
+        Accumulator:
+            Single-pass streaming statistics: count, sum, mean, variance, skewness, excess kurtosis, min and max.
+            The central moments are updated with Welford's method extended to the third and fourth moments
+            (Pébay, "Formulas for robust, one-pass parallel computation of covariances and arbitrary-order
+            statistical moments", 2008). The sum is compensated (Kahan-Babuska-Neumaier), so neither loses
+            precision to cancellation over long streams.
+            merge() combines two accumulators as if all their samples had been pushed into one, so per-thread or
+            per-shard partials reduce to the statistics of the whole stream.
+        */
+        class Accumulator
+        {
+            size_t n;
+            double mu, m2, m3, m4;
+            double total, compensation;
+            double lo, hi;
+
+        public:
+        // CONSTRUCTORS
+            Accumulator();
+        // MUTATORS
+            void push(const double x);
+            template <typename Iterator>
+            void push(Iterator first, Iterator last);
+            template <typename T>
+            void push(const T *data, const size_t count);
+            void merge(const Accumulator &other);
+            void reset();
+        // ACCESSORS
+            size_t count() const;
+            double sum() const;
+            double mean() const;
+            double variance() const;                // population, divides by N
+            double sampleVariance() const;          // unbiased, divides by N - 1
+            double stdev() const;                   // population
+            double sampleStdev() const;
+            double skewness() const;                // population skewness g1
+            double kurtosis() const;                // population excess kurtosis g2
+            double min() const;
+            double max() const;
+        };
+
+        /*
+        TDigest:
+            Streaming quantile sketch (Dunning & Ertl, "Computing extremely accurate quantiles using t-digests",
+            2019), merging variant with the k2 (logit) scale function. Samples are appended to a buffer
+            and folded into at most ~compression centroids whenever it fills, so memory is O(compression) and
+            push() is O(1) amortized (one sort of the buffer every 8 * compression samples).
+            Centroids are small near q = 0 and q = 1, so the error shrinks toward the tails: the rank error
+            of quantile(q) is of order q(1 - q) / compression: with the default compression of 200, about 5e-4
+            at the median (a few times that after many merges) and 1e-5 at p999. The smallest and largest
+            samples stay singleton centroids, and min() and max() are exact.
+            merge() folds another digest's centroids in; the result has the same error guarantee as a digest
+            that saw both streams, but is not bit-identical to it.
+        */
+        class TDigest
+        {
+            struct Centroid
+            {
+                double mean, weight;
+            };
+            double compression;
+            std::vector<Centroid> centroids;
+            std::vector<Centroid> buffer;
+            double total;
+            double lo, hi;
+
+            void compress();
+
+        public:
+        // CONSTRUCTORS
+            explicit TDigest(const double compression = 200.0);
+        // MUTATORS
+            void push(const double x);
+            template <typename Iterator>
+            void push(Iterator first, Iterator last);
+            template <typename T>
+            void push(const T *data, const size_t count);
+            void merge(const TDigest &other);
+            void reset();
+        // ACCESSORS
+            double count() const;
+            double min() const;
+            double max() const;
+            double quantile(const double q);        // q in [0, 1]; folds in pending samples first
+            double cdf(const double x);             // fraction of samples <= x
+            size_t centroidCount();
+        };
+
+        /*
+        LogLinearHistogram:
+            HDR-style fixed-memory histogram of non-negative values in [lowest, highest]. Each power of two
+            is split into 2^subBucketBits equal buckets, so every recorded value is known to a relative
+            error of at most 2^-(subBucketBits + 1) (0.2% with the default of 8 bits), whatever its
+            magnitude. The bucket of a value is read straight from its exponent and top mantissa bits,
+            so push() is O(1) with no allocation. Values below lowest (zero included) share one bucket
+            [0, lowest), values above highest are counted in an overflow bucket. Negative values are rejected
+            with an error and NaNs are ignored. Memory is log2(highest / lowest) * 2^subBucketBits counters.
+            Counts are integers, so merge() of histograms with the same configuration is exact.
+        */
+        class LogLinearHistogram
+        {
+            double lowest, highest;
+            int subBucketBits;
+            uint64_t firstKey;                  // key of the bucket holding lowest
+            std::vector<uint64_t> counts;       // [0]: below lowest, [1 .. size - 2]: buckets, [size - 1]: overflow
+            uint64_t total;
+            double lo, hi;
+
+            size_t bucketOf(const double x) const;
+            double bucketValue(const size_t bucket) const;
+
+        public:
+        // CONSTRUCTORS
+            LogLinearHistogram(const double lowest = 1e-9, const double highest = 1e9, const int subBucketBits = 8);
+        // MUTATORS
+            void push(const double x, const uint64_t count = 1);
+            template <typename Iterator>
+            void push(Iterator first, Iterator last);
+            template <typename T>
+            void push(const T *data, const size_t count);
+            void merge(const LogLinearHistogram &other);
+            void reset();
+        // ACCESSORS
+            uint64_t count() const;
+            double min() const;
+            double max() const;
+            double quantile(const double q) const;  // q in [0, 1]
+            double cdf(const double x) const;       // fraction of samples in buckets at or below x's bucket
+            size_t bucketCount() const;
+        };
+
+        /*
+        Resampling:
+            bootstrap() and jackknife() never copy the data. A resample is a list of indices into the original
+            array, and the statistic is any callable double(const T *data, const size_t *index, size_t count)
+            that reads data[index[0]], ..., data[index[count - 1]]. MeanStatistic and StdevStatistic are
+            ready-made statistics of this form.
+            Bootstrap replicate r draws its indices (Lemire's unbiased bounded integers) from a xoshiro256++
+            keyed by Philox stream r of the seed, and replicates run on the global ThreadPool with one reusable index buffer per
+            worker, so results depend only on the seed, not on the thread count.
+        */
+        struct MeanStatistic
+        {
+            template <typename T>
+            double operator()(const T *data, const size_t *index, const size_t count) const;
+        };
+
+        struct StdevStatistic       // population standard deviation, like stdev()
+        {
+            template <typename T>
+            double operator()(const T *data, const size_t *index, const size_t count) const;
+        };
+
+        /*
+        BootstrapOptions:
+            replicates: number of bootstrap resamples
+            confidence: two-sided coverage of the intervals, e.g. 0.95
+            seed: replicate r draws from Philox stream r of this seed
+            jackknifeGroups: the BCa acceleration comes from a jackknife deleting one of this many contiguous
+                groups at a time (delete-1 when the sample is no larger), which bounds its cost on huge samples
+            parallel: run replicates on the global ThreadPool (the statistic must then be safe to call concurrently)
+        */
+        struct BootstrapOptions
+        {
+            size_t replicates = 10000;
+            double confidence = 0.95;
+            uint64_t seed = 0xB0075ull;
+            size_t jackknifeGroups = 1000;
+            bool parallel = true;
+        };
+
+        /*
+        BootstrapResult:
+            estimate: statistic of the full sample
+            bias, standardError: bootstrap estimates of the statistic's bias and standard error
+            percentileLower, percentileUpper: percentile interval
+            bcaLower, bcaUpper: bias-corrected and accelerated interval (Efron, 1987)
+            replicates: the statistic of every resample, in replicate order
+        */
+        struct BootstrapResult
+        {
+            double estimate = 0.0;
+            double bias = 0.0;
+            double standardError = 0.0;
+            double percentileLower = 0.0, percentileUpper = 0.0;
+            double bcaLower = 0.0, bcaUpper = 0.0;
+            std::vector<double> replicates;
+        };
+
+        /*
+        JackknifeResult:
+            estimate: statistic of the full sample
+            bias, standardError: jackknife estimates of the statistic's bias and standard error
+            replicates: the statistic with group g deleted, in group order
+        */
+        struct JackknifeResult
+        {
+            double estimate = 0.0;
+            double bias = 0.0;
+            double standardError = 0.0;
+            std::vector<double> replicates;
+        };
+
+        template <typename T, typename Statistic>
+        BootstrapResult bootstrap(const T *data, const size_t n, Statistic statistic, const BootstrapOptions &options = BootstrapOptions());
+        template <typename T, typename Statistic>
+        BootstrapResult bootstrap(const std::vector<T> &data, Statistic statistic, const BootstrapOptions &options = BootstrapOptions());
+        // groups = 0 deletes one sample at a time
+        template <typename T, typename Statistic>
+        JackknifeResult jackknife(const T *data, const size_t n, Statistic statistic, const size_t groups = 0, const bool parallel = true);
+        template <typename T, typename Statistic>
+        JackknifeResult jackknife(const std::vector<T> &data, Statistic statistic, const size_t groups = 0, const bool parallel = true);
+
+        // standard normal distribution function and its inverse
+        double normalCdf(const double x);
+        double normalQuantile(const double p);
+
+        /*
+        Covariance and correlation:
+            X holds one observation per row and one variable per column (n x p). covariance() centers the
+            columns and forms Xc^T Xc with the blocked, multithreaded Matrix multiply, dividing by n
+            (population, like variance()) or by n - 1 when sample is set. correlation() rescales the
+            covariance by the standard deviations; constant columns give NaN correlations.
+            pairwiseCovariance()/pairwiseCorrelation() treat NaN entries as missing and use, for each pair
+            of variables, every row where both are present (R's "pairwise.complete.obs"). With M the 0/1
+            presence mask and Z the mean-centered data with missing entries zeroed, the pair counts, cross
+            products and partial sums are the products M^T M, Z^T Z, Z^T M and (Z o Z)^T M, so this path
+            costs four multiplies instead of p^2 passes over the data.
+        */
+        template <typename T>
+        Matrix<double> covariance(const Matrix<T> &X, const bool sample = false);
+        template <typename T>
+        Matrix<double> correlation(const Matrix<T> &X);
+        template <typename T>
+        Matrix<double> pairwiseCovariance(const Matrix<T> &X, const bool sample = false);
+        template <typename T>
+        Matrix<double> pairwiseCorrelation(const Matrix<T> &X);
+
+        /*
+        CovarianceAccumulator:
+            Streaming, mergeable means and covariances of p variables for data too large to hold at once.
+            push(row) is a rank-one Welford update (O(p^2) per row); push(rows, count) centers a whole block
+            of rows and adds its co-moment matrix through the Matrix multiply, which is far faster for
+            large p. Blocks and accumulators combine with the pairwise update of Chan et al. (1979),
+            C = Ca + Cb + d d^T na nb / n with d the difference of the means, so per-thread or per-shard
+            partials merge() into the statistics of the whole stream.
+        */
+        class CovarianceAccumulator
+        {
+            size_t p;
+            size_t n;
+            std::vector<double> mu;
+            std::vector<double> comoment;       // p x p, row-major
+            std::vector<double> deviation;      // p values of scratch for push(row) and mergeMoments()
+
+            void mergeMoments(const size_t count, const double *blockMean, const double *blockComoment);
+
+        public:
+        // CONSTRUCTORS
+            explicit CovarianceAccumulator(const size_t variables);
+        // MUTATORS
+            template <typename T>
+            void push(const T *row);
+            template <typename T>
+            void push(const T *rows, const size_t count);   // count rows of p values, row-major
+            template <typename T>
+            void push(const Matrix<T> &rows);
+            void merge(const CovarianceAccumulator &other);
+            void reset();
+        // ACCESSORS
+            size_t variables() const;
+            size_t count() const;
+            std::vector<double> mean() const;
+            Matrix<double> covariance() const;              // population, divides by N
+            Matrix<double> sampleCovariance() const;        // unbiased, divides by N - 1
+            Matrix<double> correlation() const;
+        };
     }
 
     // DEFINITIONS
     namespace stats {
 
+        // REDUCTION KERNELS
+        // Every kernel reduces one block in 8 lanes: lane k sees elements k, k + 8, k + 16, ... and the
+        // lanes are combined as ((0 + 1) + (2 + 3)) + ((4 + 5) + (6 + 7)). The AVX2 versions follow the
+        // same order (and use no FMA) so both paths give identical results.
+    #if STATS_X86_DISPATCH
+        inline bool hasAVX2()
+        {
+            static const bool available = []() {
+                __builtin_cpu_init();
+                return bool(__builtin_cpu_supports("avx2"));
+            }();
+            return available;
+        }
+
+        __attribute__((target("avx2"))) inline double combineLanes(const __m256d low, const __m256d high)
+        {
+            alignas(32) double lane[8];
+            _mm256_store_pd(lane, low);
+            _mm256_store_pd(lane + 4, high);
+            return ((lane[0] + lane[1]) + (lane[2] + lane[3])) + ((lane[4] + lane[5]) + (lane[6] + lane[7]));
+        }
+
+        __attribute__((target("avx2"))) inline __m256d loadWide(const double *x) { return _mm256_loadu_pd(x); }
+        __attribute__((target("avx2"))) inline __m256d loadWide(const float *x) { return _mm256_cvtps_pd(_mm_loadu_ps(x)); }
+
+        template <typename T>
+        __attribute__((target("avx2"))) double laneSumAVX2(const T *x, const size_t n, size_t &done)
+        {
+            __m256d low = _mm256_setzero_pd(), high = _mm256_setzero_pd();
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                low = _mm256_add_pd(low, loadWide(x + i));
+                high = _mm256_add_pd(high, loadWide(x + i + 4));
+            }
+            done = i;
+            return combineLanes(low, high);
+        }
+
+        template <typename T>
+        __attribute__((target("avx2"))) double laneSquaredDeviationAVX2(const T *x, const size_t n, const double mu, size_t &done)
+        {
+            const __m256d m = _mm256_set1_pd(mu);
+            __m256d low = _mm256_setzero_pd(), high = _mm256_setzero_pd();
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                const __m256d d0 = _mm256_sub_pd(loadWide(x + i), m);
+                const __m256d d1 = _mm256_sub_pd(loadWide(x + i + 4), m);
+                low = _mm256_add_pd(low, _mm256_mul_pd(d0, d0));
+                high = _mm256_add_pd(high, _mm256_mul_pd(d1, d1));
+            }
+            done = i;
+            return combineLanes(low, high);
+        }
+
+        template <typename T>
+        __attribute__((target("avx2"))) double laneDotAVX2(const T *a, const T *b, const size_t n, size_t &done)
+        {
+            __m256d low = _mm256_setzero_pd(), high = _mm256_setzero_pd();
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+            {
+                low = _mm256_add_pd(low, _mm256_mul_pd(loadWide(a + i), loadWide(b + i)));
+                high = _mm256_add_pd(high, _mm256_mul_pd(loadWide(a + i + 4), loadWide(b + i + 4)));
+            }
+            done = i;
+            return combineLanes(low, high);
+        }
+    #endif
+
+        template <typename T>
+        double laneSum(const T *x, const size_t n)
+        {
+            static_assert(std::is_arithmetic<T>::value, "the double lane kernels take arithmetic element types");
+            size_t i = 0;
+            double result = 0.0;
+        #if STATS_X86_DISPATCH
+            if constexpr (std::is_same<T, double>::value || std::is_same<T, float>::value)
+            {
+                if (hasAVX2())
+                    result = laneSumAVX2(x, n, i);
+            }
+        #endif
+            if (i == 0)
+            {
+                double acc[8] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+                for (; i + 8 <= n; i += 8)
+                    for (size_t k = 0; k < 8; k++)
+                        acc[k] += double(x[i + k]);
+                result = ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+            }
+            for (; i < n; i++)
+                result += double(x[i]);
+            return result;
+        }
+
+        template <typename T>
+        double laneSquaredDeviation(const T *x, const size_t n, const double mu)
+        {
+            static_assert(std::is_arithmetic<T>::value, "the double lane kernels take arithmetic element types");
+            size_t i = 0;
+            double result = 0.0;
+        #if STATS_X86_DISPATCH
+            if constexpr (std::is_same<T, double>::value || std::is_same<T, float>::value)
+            {
+                if (hasAVX2())
+                    result = laneSquaredDeviationAVX2(x, n, mu, i);
+            }
+        #endif
+            if (i == 0)
+            {
+                double acc[8] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+                for (; i + 8 <= n; i += 8)
+                    for (size_t k = 0; k < 8; k++)
+                    {
+                        const double d = double(x[i + k]) - mu;
+                        acc[k] += d * d;
+                    }
+                result = ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+            }
+            for (; i < n; i++)
+                result += (double(x[i]) - mu) * (double(x[i]) - mu);
+            return result;
+        }
+
+        template <typename T>
+        double laneDot(const T *a, const T *b, const size_t n)
+        {
+            static_assert(std::is_arithmetic<T>::value, "the double lane kernels take arithmetic element types");
+            size_t i = 0;
+            double result = 0.0;
+        #if STATS_X86_DISPATCH
+            if constexpr (std::is_same<T, double>::value || std::is_same<T, float>::value)
+            {
+                if (hasAVX2())
+                    result = laneDotAVX2(a, b, n, i);
+            }
+        #endif
+            if (i == 0)
+            {
+                double acc[8] = {0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0};
+                for (; i + 8 <= n; i += 8)
+                    for (size_t k = 0; k < 8; k++)
+                        acc[k] += double(a[i + k]) * double(b[i + k]);
+                result = ((acc[0] + acc[1]) + (acc[2] + acc[3])) + ((acc[4] + acc[5]) + (acc[6] + acc[7]));
+            }
+            for (; i < n; i++)
+                result += double(a[i]) * double(b[i]);
+            return result;
+        }
+
+        // min/max are exact, so lane order does not matter and the compiler vectorizes the plain loop
+        template <typename T, typename Pick>
+        T laneExtreme(const T *x, const size_t n, Pick pick)
+        {
+            T acc[8];
+            for (size_t k = 0; k < 8; k++)
+                acc[k] = x[0];
+            size_t i = 0;
+            for (; i + 8 <= n; i += 8)
+                for (size_t k = 0; k < 8; k++)
+                    acc[k] = pick(acc[k], x[i + k]);
+            for (; i < n; i++)
+                acc[0] = pick(acc[0], x[i]);
+            T result = acc[0];
+            for (size_t k = 1; k < 8; k++)
+                result = pick(result, acc[k]);
+            return result;
+        }
+
+        // reduces [0, n) in fixed blocks on the thread pool, partials[b] = block(first, count)
+        template <typename Partial, typename Block>
+        std::vector<Partial> reduceBlocks(const size_t n, Block block)
+        {
+            const size_t blocks = (n + REDUCTION_BLOCK - 1) / REDUCTION_BLOCK;
+            std::vector<Partial> partials(blocks);
+            auto run = [&](size_t b, size_t) {
+                const size_t first = b * REDUCTION_BLOCK;
+                partials[b] = block(first, std::min(REDUCTION_BLOCK, n - first));
+            };
+            if (blocks <= 1)
+            {
+                for (size_t b = 0; b < blocks; b++)
+                    run(b, 0);
+            }
+            else
+            {
+                ThreadPool::global().parallelFor(0, blocks, run);
+            }
+            return partials;
+        }
+
+        // combines partials[lo, hi) as a balanced binary tree
+        template <typename Partial, typename Combine>
+        Partial pairwiseCombine(const std::vector<Partial> &partials, const size_t lo, const size_t hi, Combine combine)
+        {
+            if (hi - lo == 1)
+                return partials[lo];
+            const size_t mid = lo + (hi - lo) / 2;
+            return combine(pairwiseCombine(partials, lo, mid, combine), pairwiseCombine(partials, mid, hi, combine));
+        }
+
         // SUM()
         template <typename T>
-        T sum(std::vector<T> arr)
+        T sum(const T *data, const size_t n)
         {
-            T sum = 0;
-            for (T &x : arr)
+            if (n == 0)
+                return T(0);
+            if constexpr (std::is_integral<T>::value)
+            {
+                const std::vector<T> partials = reduceBlocks<T>(n, [&](size_t first, size_t count) {
+                    T acc = 0;
+                    for (size_t i = first; i < first + count; i++)
+                        acc += data[i];
+                    return acc;
+                });
+                T total = 0;
+                for (const T &p : partials)
+                    total += p;
+                return total;
+            }
+            else if constexpr (std::is_arithmetic<T>::value)
             {
-                sum += x;
+                const std::vector<double> partials = reduceBlocks<double>(n, [&](size_t first, size_t count) {
+                    return laneSum(data + first, count);
+                });
+                return T(pairwiseCombine(partials, 0, partials.size(), [](double a, double b) { return a + b; }));
             }
-            return sum;
+            else
+            {
+                // std::complex, derivative::Dual, ...: same blocks and combine order, accumulated in T
+                const std::vector<T> partials = reduceBlocks<T>(n, [&](size_t first, size_t count) {
+                    T acc = T(0);
+                    for (size_t i = first; i < first + count; i++)
+                        acc += data[i];
+                    return acc;
+                });
+                return pairwiseCombine(partials, 0, partials.size(), [](const T &a, const T &b) { return a + b; });
+            }
+        }
+
+        template <typename T>
+        T sum(const std::vector<T> &arr)
+        {
+            return sum(arr.data(), arr.size());
         }
 
         // MEAN()
         template <typename T>
-        double mean(std::vector<T> arr)
+        double mean(const T *data, const size_t n)
+        {
+            if constexpr (std::is_integral<T>::value)
+            {
+                return double(sum(data, n)) / double(n);
+            }
+            else
+            {
+                if (n == 0)
+                    return std::numeric_limits<double>::quiet_NaN();
+                const std::vector<double> partials = reduceBlocks<double>(n, [&](size_t first, size_t count) {
+                    return laneSum(data + first, count);
+                });
+                return pairwiseCombine(partials, 0, partials.size(), [](double a, double b) { return a + b; }) / double(n);
+            }
+        }
+
+        template <typename T>
+        double mean(const std::vector<T> &arr)
+        {
+            return mean(arr.data(), arr.size());
+        }
+
+        // VARIANCE()
+        template <typename T>
+        double variance(const T *data, const size_t n)
+        {
+            if (n == 0)
+                return std::numeric_limits<double>::quiet_NaN();
+            // each block: two passes over cache-resident data, then the blocks are merged (Chan et al.)
+            struct Moments
+            {
+                double count, mu, m2;
+            };
+            const std::vector<Moments> partials = reduceBlocks<Moments>(n, [&](size_t first, size_t count) {
+                const double mu = laneSum(data + first, count) / double(count);
+                return Moments{double(count), mu, laneSquaredDeviation(data + first, count, mu)};
+            });
+            const Moments all = pairwiseCombine(partials, 0, partials.size(), [](const Moments &a, const Moments &b) {
+                const double total = a.count + b.count;
+                const double delta = b.mu - a.mu;
+                return Moments{total, a.mu + delta * b.count / total, a.m2 + b.m2 + delta * delta * a.count * b.count / total};
+            });
+            return all.m2 / all.count;
+        }
+
+        template <typename T>
+        double variance(const std::vector<T> &arr)
         {
-            return sum(arr) / double(arr.size());
+            return variance(arr.data(), arr.size());
         }
 
         // STDEV()
         template <typename T>
-        double stdev(std::vector<T> arr)
+        double stdev(const T *data, const size_t n)
+        {
+            return std::sqrt(variance(data, n));
+        }
+
+        template <typename T>
+        double stdev(const std::vector<T> &arr)
+        {
+            return stdev(arr.data(), arr.size());
+        }
+
+        // MIN() / MAX()
+        template <typename T>
+        T min(const T *data, const size_t n)
         {
-            double avg = mean(arr);
-            double sum_sqr_res = 0.0; // sum of squared residuals
-            for (T &x : arr)
+            if (n == 0)
             {
-                sum_sqr_res += (x - avg) * (x - avg);
+                std::cerr << "ERROR: Empty range [min()]\n";
+                return T(0);
             }
-            return sqrt(sum_sqr_res);
+            auto pick = [](const T &a, const T &b) { return (b < a) ? b : a; };
+            const std::vector<T> partials = reduceBlocks<T>(n, [&](size_t first, size_t count) {
+                return laneExtreme(data + first, count, pick);
+            });
+            return laneExtreme(partials.data(), partials.size(), pick);
         }
 
-        // REALDISTRIBUTION()
-        std::vector<double> realDistribution(const int dist, const int num_samples, const double min, const double max)
+        template <typename T>
+        T min(const std::vector<T> &arr)
+        {
+            return min(arr.data(), arr.size());
+        }
+
+        template <typename T>
+        T max(const T *data, const size_t n)
+        {
+            if (n == 0)
+            {
+                std::cerr << "ERROR: Empty range [max()]\n";
+                return T(0);
+            }
+            auto pick = [](const T &a, const T &b) { return (a < b) ? b : a; };
+            const std::vector<T> partials = reduceBlocks<T>(n, [&](size_t first, size_t count) {
+                return laneExtreme(data + first, count, pick);
+            });
+            return laneExtreme(partials.data(), partials.size(), pick);
+        }
+
+        template <typename T>
+        T max(const std::vector<T> &arr)
+        {
+            return max(arr.data(), arr.size());
+        }
+
+        // DOT()
+        template <typename T>
+        double dot(const T *a, const T *b, const size_t n)
+        {
+            if (n == 0)
+                return 0.0;
+            const std::vector<double> partials = reduceBlocks<double>(n, [&](size_t first, size_t count) {
+                return laneDot(a + first, b + first, count);
+            });
+            return pairwiseCombine(partials, 0, partials.size(), [](double x, double y) { return x + y; });
+        }
+
+        template <typename T>
+        double dot(const std::vector<T> &a, const std::vector<T> &b)
         {
-            std::vector<double> result(num_samples, 0.0);
+            if (a.size() != b.size())
+            {
+                std::cerr << "ERROR: Vectors differ in length [dot()]\n";
+                return 0.0;
+            }
+            return dot(a.data(), b.data(), a.size());
+        }
 
+        // REALDISTRIBUTION()
+        inline std::vector<double> realDistribution(const int dist, const int num_samples, const double min, const double max)
+        {
             std::random_device rd;
-            std::mt19937 generator(rd());
+            return realDistribution(dist, num_samples, min, max, (uint64_t(rd()) << 32) | rd());
+        }
+
+        inline std::vector<double> realDistribution(const int dist, const int num_samples, const double min, const double max, const uint64_t seed)
+        {
+            std::vector<double> result(std::max(num_samples, 0), 0.0);
 
             if (dist == UNIFORM)
             {
-                std::uniform_real_distribution distribution(min, max);
-                for (int i = 0; i < num_samples; i++)
-                {
-                    result[i] = distribution(generator);
-                }
+                rng::parallelFillUniform(result.data(), result.size(), min, max, seed);
             }
             else if (dist == GAUSSIAN)
             {
-                std::normal_distribution<double> distribution(min, max);
-                for (int i = 0; i < num_samples; i++)
-                {
-                    result[i] = distribution(generator);
-                }
+                rng::parallelFillNormal(result.data(), result.size(), min, max, seed);
             }
             return result;
         }
+
+        // ACCUMULATOR
+        inline Accumulator::Accumulator()
+        {
+            reset();
+        }
+
+        inline void Accumulator::reset()
+        {
+            this->n = 0;
+            this->mu = this->m2 = this->m3 = this->m4 = 0.0;
+            this->total = this->compensation = 0.0;
+            this->lo = std::numeric_limits<double>::infinity();
+            this->hi = -std::numeric_limits<double>::infinity();
+        }
+
+        inline void Accumulator::push(const double x)
+        {
+            const double n1 = double(n);
+            n++;
+            const double nn = double(n);
+            const double delta = x - mu;
+            const double deltaN = delta / nn;
+            const double deltaN2 = deltaN * deltaN;
+            const double term = delta * deltaN * n1;
+            mu += deltaN;
+            m4 += term * deltaN2 * (nn * nn - 3.0 * nn + 3.0) + 6.0 * deltaN2 * m2 - 4.0 * deltaN * m3;
+            m3 += term * deltaN * (nn - 2.0) - 3.0 * deltaN * m2;
+            m2 += term;
+
+            // Neumaier: keep the low-order bits lost by whichever addend is smaller
+            const double t = total + x;
+            if (std::abs(total) >= std::abs(x))
+                compensation += (total - t) + x;
+            else
+                compensation += (x - t) + total;
+            total = t;
+
+            if (x < lo)
+                lo = x;
+            if (x > hi)
+                hi = x;
+        }
+
+        template <typename Iterator>
+        void Accumulator::push(Iterator first, Iterator last)
+        {
+            for (; first != last; ++first)
+            {
+                push(double(*first));
+            }
+        }
+
+        template <typename T>
+        void Accumulator::push(const T *data, const size_t count)
+        {
+            push(data, data + count);
+        }
+
+        inline void Accumulator::merge(const Accumulator &other)
+        {
+            if (other.n == 0)
+                return;
+            if (n == 0)
+            {
+                *this = other;
+                return;
+            }
+            const double na = double(n), nb = double(other.n);
+            const double nn = na + nb;
+            const double delta = other.mu - mu;
+            const double delta2 = delta * delta;
+            const double delta3 = delta2 * delta;
+            const double delta4 = delta2 * delta2;
+
+            const double mergedM2 = m2 + other.m2 + delta2 * na * nb / nn;
+            const double mergedM3 = m3 + other.m3 + delta3 * na * nb * (na - nb) / (nn * nn)
+                                  + 3.0 * delta * (na * other.m2 - nb * m2) / nn;
+            const double mergedM4 = m4 + other.m4 + delta4 * na * nb * (na * na - na * nb + nb * nb) / (nn * nn * nn)
+                                  + 6.0 * delta2 * (na * na * other.m2 + nb * nb * m2) / (nn * nn)
+                                  + 4.0 * delta * (na * other.m3 - nb * m3) / nn;
+            mu += delta * nb / nn;
+            m2 = mergedM2;
+            m3 = mergedM3;
+            m4 = mergedM4;
+            n += other.n;
+
+            const double t = total + other.total;
+            if (std::abs(total) >= std::abs(other.total))
+                compensation += (total - t) + other.total;
+            else
+                compensation += (other.total - t) + total;
+            total = t;
+            compensation += other.compensation;
+
+            if (other.lo < lo)
+                lo = other.lo;
+            if (other.hi > hi)
+                hi = other.hi;
+        }
+
+        inline size_t Accumulator::count() const
+        {
+            return n;
+        }
+
+        inline double Accumulator::sum() const
+        {
+            return total + compensation;
+        }
+
+        inline double Accumulator::mean() const
+        {
+            return (n > 0) ? mu : std::numeric_limits<double>::quiet_NaN();
+        }
+
+        inline double Accumulator::variance() const
+        {
+            return (n > 0) ? m2 / double(n) : std::numeric_limits<double>::quiet_NaN();
+        }
+
+        inline double Accumulator::sampleVariance() const
+        {
+            return (n > 1) ? m2 / double(n - 1) : std::numeric_limits<double>::quiet_NaN();
+        }
+
+        inline double Accumulator::stdev() const
+        {
+            return std::sqrt(variance());
+        }
+
+        inline double Accumulator::sampleStdev() const
+        {
+            return std::sqrt(sampleVariance());
+        }
+
+        inline double Accumulator::skewness() const
+        {
+            if (n == 0 || m2 == 0.0)
+                return std::numeric_limits<double>::quiet_NaN();
+            return std::sqrt(double(n)) * m3 / std::pow(m2, 1.5);
+        }
+
+        inline double Accumulator::kurtosis() const
+        {
+            if (n == 0 || m2 == 0.0)
+                return std::numeric_limits<double>::quiet_NaN();
+            return double(n) * m4 / (m2 * m2) - 3.0;
+        }
+
+        inline double Accumulator::min() const
+        {
+            return (n > 0) ? lo : std::numeric_limits<double>::quiet_NaN();
+        }
+
+        inline double Accumulator::max() const
+        {
+            return (n > 0) ? hi : std::numeric_limits<double>::quiet_NaN();
+        }
+
+        // TDIGEST
+        inline TDigest::TDigest(const double compression)
+        {
+            this->compression = (compression < 20.0) ? 20.0 : compression;
+            this->buffer.reserve(size_t(8.0 * this->compression));
+            reset();
+        }
+
+        inline void TDigest::reset()
+        {
+            this->centroids.clear();
+            this->buffer.clear();
+            this->total = 0.0;
+            this->lo = std::numeric_limits<double>::infinity();
+            this->hi = -std::numeric_limits<double>::infinity();
+        }
+
+        inline void TDigest::push(const double x)
+        {
+            if (std::isnan(x))
+                return;
+            buffer.push_back(Centroid{x, 1.0});
+            total += 1.0;
+            if (x < lo)
+                lo = x;
+            if (x > hi)
+                hi = x;
+            if (buffer.size() >= size_t(8.0 * compression))
+                compress();
+        }
+
+        template <typename Iterator>
+        void TDigest::push(Iterator first, Iterator last)
+        {
+            for (; first != last; ++first)
+            {
+                push(double(*first));
+            }
+        }
+
+        template <typename T>
+        void TDigest::push(const T *data, const size_t count)
+        {
+            push(data, data + count);
+        }
+
+        inline void TDigest::compress()
+        {
+            if (buffer.empty())
+                return;
+            buffer.insert(buffer.end(), centroids.begin(), centroids.end());
+            std::sort(buffer.begin(), buffer.end(), [](const Centroid &a, const Centroid &b) { return a.mean < b.mean; });
+
+            // k2 scale: k(q) = delta / Z * log(q / (1 - q)), Z = 4 log(N / delta) + 24; each centroid spans at most
+            // one unit of k, so its weight is O(q (1 - q) N / delta) and never more than the count bound allows
+            const double Z = 4.0 * std::log(std::max(total / compression, 1.0)) + 24.0;
+            auto kOfQ = [&](double q) {
+                return (q <= 0.0) ? -std::numeric_limits<double>::infinity() : compression / Z * std::log(q / (1.0 - q));
+            };
+            auto qOfK = [&](double k) { return 1.0 / (1.0 + std::exp(-k * Z / compression)); };
+
+            centroids.clear();
+            Centroid current = buffer[0];
+            double weightSoFar = 0.0;
+            double limit = 0.0;
+            for (size_t i = 1; i < buffer.size(); i++)
+            {
+                const Centroid &next = buffer[i];
+                if (weightSoFar + current.weight + next.weight <= limit)
+                {
+                    current.weight += next.weight;
+                    current.mean += (next.mean - current.mean) * next.weight / current.weight;
+                }
+                else
+                {
+                    weightSoFar += current.weight;
+                    centroids.push_back(current);
+                    limit = total * qOfK(kOfQ(weightSoFar / total) + 1.0);
+                    current = next;
+                }
+            }
+            centroids.push_back(current);
+            buffer.clear();
+        }
+
+        inline void TDigest::merge(const TDigest &other)
+        {
+            if (other.total == 0.0)
+                return;
+            if (&other == this)
+            {
+                // the buffer would be extended with its own range, merge a copy instead
+                const TDigest copy(other);
+                merge(copy);
+                return;
+            }
+            buffer.insert(buffer.end(), other.centroids.begin(), other.centroids.end());
+            buffer.insert(buffer.end(), other.buffer.begin(), other.buffer.end());
+            total += other.total;
+            if (other.lo < lo)
+                lo = other.lo;
+            if (other.hi > hi)
+                hi = other.hi;
+            compress();
+        }
+
+        inline double TDigest::count() const
+        {
+            return total;
+        }
+
+        inline double TDigest::min() const
+        {
+            return (total > 0.0) ? lo : std::numeric_limits<double>::quiet_NaN();
+        }
+
+        inline double TDigest::max() const
+        {
+            return (total > 0.0) ? hi : std::numeric_limits<double>::quiet_NaN();
+        }
+
+        inline size_t TDigest::centroidCount()
+        {
+            compress();
+            return centroids.size();
+        }
+
+        inline double TDigest::quantile(const double q)
+        {
+            if (total == 0.0 || std::isnan(q))
+                return std::numeric_limits<double>::quiet_NaN();
+            compress();
+            if (q <= 0.0)
+                return lo;
+            if (q >= 1.0)
+                return hi;
+            const size_t n = centroids.size();
+            if (n == 1)
+                return centroids[0].mean;
+
+            // each centroid's weight is spread evenly around its mean; interpolate between neighbouring means,
+            // and between the extreme centroids and the exact min / max
+            const double index = q * total;
+            const Centroid &first = centroids[0];
+            if (index < first.weight / 2.0)
+                return lo + (first.mean - lo) * index / (first.weight / 2.0);
+            double weightSoFar = first.weight / 2.0;
+            for (size_t i = 0; i + 1 < n; i++)
+            {
+                const double step = (centroids[i].weight + centroids[i + 1].weight) / 2.0;
+                if (weightSoFar + step > index)
+                {
+                    const double t = (index - weightSoFar) / step;
+                    return centroids[i].mean + t * (centroids[i + 1].mean - centroids[i].mean);
+                }
+                weightSoFar += step;
+            }
+            const Centroid &last = centroids[n - 1];
+            const double t = (index - weightSoFar) / (last.weight / 2.0);
+            return std::min(hi, last.mean + t * (hi - last.mean));
+        }
+
+        inline double TDigest::cdf(const double x)
+        {
+            if (total == 0.0 || std::isnan(x))
+                return std::numeric_limits<double>::quiet_NaN();
+            compress();
+            if (x < lo)
+                return 0.0;
+            if (x >= hi)
+                return 1.0;
+            const size_t n = centroids.size();
+            const Centroid &first = centroids[0];
+            if (n == 1 || x < first.mean)
+            {
+                const double span = first.mean - lo;
+                return (span > 0.0) ? (first.weight / 2.0) * (x - lo) / span / total : 0.5;
+            }
+            double weightSoFar = first.weight / 2.0;
+            for (size_t i = 0; i + 1 < n; i++)
+            {
+                const double step = (centroids[i].weight + centroids[i + 1].weight) / 2.0;
+                if (x < centroids[i + 1].mean)
+                {
+                    const double span = centroids[i + 1].mean - centroids[i].mean;
+                    const double t = (span > 0.0) ? (x - centroids[i].mean) / span : 0.5;
+                    return (weightSoFar + t * step) / total;
+                }
+                weightSoFar += step;
+            }
+            const Centroid &last = centroids[n - 1];
+            const double span = hi - last.mean;
+            return (weightSoFar + ((span > 0.0) ? (x - last.mean) / span : 0.5) * last.weight / 2.0) / total;
+        }
+
+        // LOGLINEARHISTOGRAM
+        inline uint64_t histogramKey(const double x, const int subBucketBits)
+        {
+            // for positive doubles the bit pattern is monotonic: exponent, then mantissa
+            uint64_t bits;
+            std::memcpy(&bits, &x, sizeof(bits));
+            return bits >> (52 - subBucketBits);
+        }
+
+        inline LogLinearHistogram::LogLinearHistogram(const double lowest, const double highest, const int subBucketBits)
+        {
+            this->subBucketBits = std::min(std::max(subBucketBits, 1), 20);
+            this->lowest = lowest;
+            this->highest = highest;
+            if (!(lowest > 0.0) || !(highest > lowest) || std::isinf(highest))
+            {
+                std::cerr << "ERROR: Histogram range must satisfy 0 < lowest < highest < inf [LogLinearHistogram()]\n";
+                this->lowest = 1e-9;
+                this->highest = 1e9;
+            }
+            this->firstKey = histogramKey(this->lowest, this->subBucketBits);
+            const uint64_t lastKey = histogramKey(this->highest, this->subBucketBits);
+            this->counts.assign(size_t(lastKey - firstKey) + 3, 0);
+            reset();
+        }
+
+        inline void LogLinearHistogram::reset()
+        {
+            std::fill(counts.begin(), counts.end(), 0);
+            this->total = 0;
+            this->lo = std::numeric_limits<double>::infinity();
+            this->hi = -std::numeric_limits<double>::infinity();
+        }
+
+        inline size_t LogLinearHistogram::bucketOf(const double x) const
+        {
+            if (!(x >= lowest))
+                return 0;
+            if (x > highest)
+                return counts.size() - 1;
+            return size_t(histogramKey(x, subBucketBits) - firstKey) + 1;
+        }
+
+        inline double LogLinearHistogram::bucketValue(const size_t bucket) const
+        {
+            // midpoint of the bucket, clamped to the observed range
+            double value;
+            if (bucket == 0)
+                value = lowest / 2.0;
+            else if (bucket == counts.size() - 1)
+                value = hi;
+            else
+            {
+                const uint64_t key = firstKey + (bucket - 1);
+                const uint64_t lowBits = key << (52 - subBucketBits), highBits = (key + 1) << (52 - subBucketBits);
+                double a, b;
+                std::memcpy(&a, &lowBits, sizeof(a));
+                std::memcpy(&b, &highBits, sizeof(b));
+                value = 0.5 * (a + b);
+            }
+            return std::min(std::max(value, lo), hi);
+        }
+
+        inline void LogLinearHistogram::push(const double x, const uint64_t count)
+        {
+            if (std::isnan(x) || count == 0)
+                return;
+            if (x < 0.0)
+            {
+                std::cerr << "ERROR: Histogram values must be non-negative [LogLinearHistogram::push()]\n";
+                return;
+            }
+            counts[bucketOf(x)] += count;
+            total += count;
+            if (x < lo)
+                lo = x;
+            if (x > hi)
+                hi = x;
+        }
+
+        template <typename Iterator>
+        void LogLinearHistogram::push(Iterator first, Iterator last)
+        {
+            for (; first != last; ++first)
+            {
+                push(double(*first));
+            }
+        }
+
+        template <typename T>
+        void LogLinearHistogram::push(const T *data, const size_t count)
+        {
+            // batched: bucket lookups without the per-sample bookkeeping, extremes reduced once
+            double blockLo = lo, blockHi = hi;
+            size_t added = 0, negative = 0;
+            for (size_t i = 0; i < count; i++)
+            {
+                const double x = double(data[i]);
+                if (!(x >= 0.0))
+                {
+                    negative += (x < 0.0);
+                    continue;
+                }
+                counts[bucketOf(x)]++;
+                blockLo = (x < blockLo) ? x : blockLo;
+                blockHi = (x > blockHi) ? x : blockHi;
+                added++;
+            }
+            total += added;
+            lo = blockLo;
+            hi = blockHi;
+            if (negative > 0)
+                std::cerr << "ERROR: Histogram values must be non-negative, " << negative << " ignored [LogLinearHistogram::push()]\n";
+        }
+
+        inline void LogLinearHistogram::merge(const LogLinearHistogram &other)
+        {
+            if (other.lowest != lowest || other.highest != highest || other.subBucketBits != subBucketBits)
+            {
+                std::cerr << "ERROR: Histograms have different configurations [merge()]\n";
+                return;
+            }
+            for (size_t i = 0; i < counts.size(); i++)
+            {
+                counts[i] += other.counts[i];
+            }
+            total += other.total;
+            if (other.lo < lo)
+                lo = other.lo;
+            if (other.hi > hi)
+                hi = other.hi;
+        }
+
+        inline uint64_t LogLinearHistogram::count() const
+        {
+            return total;
+        }
+
+        inline double LogLinearHistogram::min() const
+        {
+            return (total > 0) ? lo : std::numeric_limits<double>::quiet_NaN();
+        }
+
+        inline double LogLinearHistogram::max() const
+        {
+            return (total > 0) ? hi : std::numeric_limits<double>::quiet_NaN();
+        }
+
+        inline size_t LogLinearHistogram::bucketCount() const
+        {
+            return counts.size();
+        }
+
+        inline double LogLinearHistogram::quantile(const double q) const
+        {
+            if (total == 0 || std::isnan(q))
+                return std::numeric_limits<double>::quiet_NaN();
+            if (q <= 0.0)
+                return lo;
+            if (q >= 1.0)
+                return hi;
+            // value of the sample with rank ceil(q * N)
+            const uint64_t rank = std::max<uint64_t>(1, uint64_t(std::ceil(q * double(total))));
+            uint64_t seen = 0;
+            for (size_t b = 0; b < counts.size(); b++)
+            {
+                seen += counts[b];
+                if (seen >= rank)
+                    return bucketValue(b);
+            }
+            return hi;
+        }
+
+        inline double LogLinearHistogram::cdf(const double x) const
+        {
+            if (total == 0 || std::isnan(x))
+                return std::numeric_limits<double>::quiet_NaN();
+            const size_t last = bucketOf(x);
+            uint64_t seen = 0;
+            for (size_t b = 0; b <= last; b++)
+            {
+                seen += counts[b];
+            }
+            return double(seen) / double(total);
+        }
+
+        // NORMALCDF() / NORMALQUANTILE()
+        inline double normalCdf(const double x)
+        {
+            return 0.5 * std::erfc(-x / std::sqrt(2.0));
+        }
+
+        inline double normalQuantile(const double p)
+        {
+            if (!(p > 0.0 && p < 1.0))
+            {
+                if (p == 0.0)
+                    return -std::numeric_limits<double>::infinity();
+                if (p == 1.0)
+                    return std::numeric_limits<double>::infinity();
+                return std::numeric_limits<double>::quiet_NaN();
+            }
+            // Acklam's rational approximation (relative error 1.2e-9), polished by one Halley step
+            static const double a[6] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                                        1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+            static const double b[5] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                                        6.680131188771972e+01, -1.328068155288572e+01};
+            static const double c[6] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                        -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+            static const double d[4] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                                        3.754408661907416e+00};
+            double x;
+            if (p < 0.02425)
+            {
+                const double q = std::sqrt(-2.0 * std::log(p));
+                x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+            }
+            else if (p > 1.0 - 0.02425)
+            {
+                const double q = std::sqrt(-2.0 * std::log(1.0 - p));
+                x = -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) / ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+            }
+            else
+            {
+                const double q = p - 0.5, r = q * q;
+                x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q / (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+            }
+            const double e = normalCdf(x) - p;
+            const double u = e * std::sqrt(2.0 * 3.14159265358979323846) * std::exp(0.5 * x * x);
+            return x - u / (1.0 + 0.5 * x * u);
+        }
+
+        // MEANSTATISTIC / STDEVSTATISTIC
+        template <typename T>
+        double MeanStatistic::operator()(const T *data, const size_t *index, const size_t count) const
+        {
+            double acc[4] = {0.0, 0.0, 0.0, 0.0};
+            size_t i = 0;
+            for (; i + 4 <= count; i += 4)
+                for (size_t k = 0; k < 4; k++)
+                    acc[k] += double(data[index[i + k]]);
+            for (; i < count; i++)
+                acc[0] += double(data[index[i]]);
+            return ((acc[0] + acc[1]) + (acc[2] + acc[3])) / double(count);
+        }
+
+        template <typename T>
+        double StdevStatistic::operator()(const T *data, const size_t *index, const size_t count) const
+        {
+            // shifted sums: subtracting one sample keeps the single pass free of cancellation
+            const double shift = double(data[index[0]]);
+            double s1 = 0.0, s2 = 0.0;
+            for (size_t i = 0; i < count; i++)
+            {
+                const double d = double(data[index[i]]) - shift;
+                s1 += d;
+                s2 += d * d;
+            }
+            const double m = s1 / double(count);
+            return std::sqrt(std::max(s2 / double(count) - m * m, 0.0));
+        }
+
+        // runs body(task, worker) for every task, on the pool or serially; returns the worker count
+        template <typename Body>
+        size_t forEachReplicate(const size_t tasks, const bool parallel, Body body)
+        {
+            if (!parallel || tasks <= 1)
+            {
+                for (size_t t = 0; t < tasks; t++)
+                    body(t, size_t(0));
+                return 1;
+            }
+            ThreadPool::global().parallelFor(0, tasks, body);
+            return ThreadPool::global().size();
+        }
+
+        // full 128-bit product a * b: returns the high 64 bits and stores the low 64 bits in `low`
+        inline uint64_t multiply128(const uint64_t a, const uint64_t b, uint64_t &low)
+        {
+        #ifdef __SIZEOF_INT128__
+            const unsigned __int128 product = (unsigned __int128)a * b;
+            low = uint64_t(product);
+            return uint64_t(product >> 64);
+        #else
+            const uint64_t aLow = a & 0xFFFFFFFFull, aHigh = a >> 32, bLow = b & 0xFFFFFFFFull, bHigh = b >> 32;
+            const uint64_t ll = aLow * bLow, lh = aLow * bHigh, hl = aHigh * bLow, hh = aHigh * bHigh;
+            const uint64_t middle = (ll >> 32) + (lh & 0xFFFFFFFFull) + (hl & 0xFFFFFFFFull);
+            low = (middle << 32) | (ll & 0xFFFFFFFFull);
+            return hh + (lh >> 32) + (hl >> 32) + (middle >> 32);
+        #endif
+        }
+
+        // uniform integers in [0, n) without modulo bias (Lemire, "Fast random integer generation in an interval", 2019)
+        // for n < 2^32 both halves of each 64-bit engine output are used, larger n take the 64 x 64 -> 128-bit form
+        template <typename Engine>
+        void boundedIndices(Engine &engine, const size_t n, size_t *out, const size_t count)
+        {
+            if (uint64_t(n) > 0xFFFFFFFFull)
+            {
+                const uint64_t bound = uint64_t(n);
+                const uint64_t threshold = (0 - bound) % bound;
+                for (size_t i = 0; i < count; i++)
+                {
+                    uint64_t low;
+                    uint64_t high = multiply128(engine(), bound, low);
+                    while (low < threshold)
+                        high = multiply128(engine(), bound, low);
+                    out[i] = size_t(high);
+                }
+                return;
+            }
+            const uint32_t bound = uint32_t(n);
+            const uint32_t threshold = uint32_t(-bound) % bound;
+            uint64_t bits = 0;
+            bool half = false;
+            auto next32 = [&]() {
+                if (half)
+                {
+                    half = false;
+                    return uint32_t(bits >> 32);
+                }
+                bits = engine();
+                half = true;
+                return uint32_t(bits);
+            };
+            for (size_t i = 0; i < count; i++)
+            {
+                uint64_t m = uint64_t(next32()) * bound;
+                while (uint32_t(m) < threshold)
+                    m = uint64_t(next32()) * bound;
+                out[i] = size_t(m >> 32);
+            }
+        }
+
+        // interpolated order statistic of sorted values (type 7)
+        inline double sortedQuantile(const std::vector<double> &sorted, const double p)
+        {
+            const double position = std::min(std::max(p, 0.0), 1.0) * double(sorted.size() - 1);
+            const size_t below = size_t(position);
+            if (below + 1 >= sorted.size())
+                return sorted.back();
+            return sorted[below] + (position - double(below)) * (sorted[below + 1] - sorted[below]);
+        }
+
+        // JACKKNIFE()
+        template <typename T, typename Statistic>
+        JackknifeResult jackknife(const T *data, const size_t n, Statistic statistic, const size_t groups, const bool parallel)
+        {
+            JackknifeResult result;
+            if (n < 2)
+            {
+                std::cerr << "ERROR: Jackknife needs at least two samples [jackknife()]\n";
+                return result;
+            }
+            const size_t g = (groups == 0 || groups > n) ? n : groups;
+
+            std::vector<size_t> all(n);
+            for (size_t i = 0; i < n; i++)
+                all[i] = i;
+            result.estimate = statistic(data, all.data(), n);
+            result.replicates.assign(g, 0.0);
+
+            // group k holds samples [k * n / g, (k + 1) * n / g)
+            std::vector<std::vector<size_t>> scratch(parallel ? ThreadPool::global().size() : 1);
+            forEachReplicate(g, parallel, [&](size_t k, size_t worker) {
+                const size_t first = k * n / g, last = (k + 1) * n / g;
+                std::vector<size_t> &index = scratch[worker];
+                index.resize(n - (last - first));
+                std::copy(all.begin(), all.begin() + first, index.begin());
+                std::copy(all.begin() + last, all.end(), index.begin() + first);
+                result.replicates[k] = statistic(data, index.data(), index.size());
+            });
+
+            const double gg = double(g);
+            const double average = sum(result.replicates.data(), g) / gg;
+            double ss = 0.0;
+            for (double r : result.replicates)
+                ss += (r - average) * (r - average);
+            result.bias = (gg - 1.0) * (average - result.estimate);
+            result.standardError = std::sqrt((gg - 1.0) / gg * ss);
+            return result;
+        }
+
+        template <typename T, typename Statistic>
+        JackknifeResult jackknife(const std::vector<T> &data, Statistic statistic, const size_t groups, const bool parallel)
+        {
+            return jackknife(data.data(), data.size(), statistic, groups, parallel);
+        }
+
+        // BOOTSTRAP()
+        template <typename T, typename Statistic>
+        BootstrapResult bootstrap(const T *data, const size_t n, Statistic statistic, const BootstrapOptions &options)
+        {
+            BootstrapResult result;
+            if (n < 2 || options.replicates < 2)
+            {
+                std::cerr << "ERROR: Bootstrap needs at least two samples and two replicates [bootstrap()]\n";
+                return result;
+            }
+            if (!(options.confidence > 0.0 && options.confidence < 1.0))
+            {
+                std::cerr << "ERROR: Confidence must lie in (0, 1) [bootstrap()]\n";
+                return result;
+            }
+            INSTRUMENT_SCOPE("stats::bootstrap");
+            const size_t B = options.replicates;
+            result.replicates.assign(B, 0.0);
+
+            std::vector<std::vector<size_t>> scratch(options.parallel ? ThreadPool::global().size() : 1);
+            forEachReplicate(B, options.parallel, [&](size_t r, size_t worker) {
+                // a fast xoshiro256++ per replicate, keyed by Philox stream r of the seed
+                rng::Philox4x32 stream(options.seed, r);
+                rng::Xoshiro256pp engine(stream());
+                std::vector<size_t> &index = scratch[worker];
+                index.resize(n);
+                boundedIndices(engine, n, index.data(), n);
+                result.replicates[r] = statistic(data, index.data(), n);
+            });
+
+            // the jackknife supplies the full-sample estimate and the BCa acceleration
+            const JackknifeResult jack = jackknife(data, n, statistic, std::min(options.jackknifeGroups, n), options.parallel);
+            result.estimate = jack.estimate;
+
+            const double mean = sum(result.replicates.data(), B) / double(B);
+            double ss = 0.0;
+            for (double r : result.replicates)
+                ss += (r - mean) * (r - mean);
+            result.bias = mean - result.estimate;
+            result.standardError = std::sqrt(ss / double(B - 1));
+
+            std::vector<double> sorted = result.replicates;
+            std::sort(sorted.begin(), sorted.end());
+            const double alpha = 1.0 - options.confidence;
+            result.percentileLower = sortedQuantile(sorted, alpha / 2.0);
+            result.percentileUpper = sortedQuantile(sorted, 1.0 - alpha / 2.0);
+
+            // BCa: z0 from the fraction of replicates below the estimate (ties count half), a from the jackknife skewness
+            const size_t below = size_t(std::lower_bound(sorted.begin(), sorted.end(), result.estimate) - sorted.begin());
+            const size_t ties = size_t(std::upper_bound(sorted.begin(), sorted.end(), result.estimate) - sorted.begin()) - below;
+            const double fraction = std::min(std::max((double(below) + 0.5 * double(ties)) / double(B), 0.5 / double(B)), 1.0 - 0.5 / double(B));
+            const double z0 = normalQuantile(fraction);
+
+            const double jackMean = sum(jack.replicates.data(), jack.replicates.size()) / double(jack.replicates.size());
+            double s2 = 0.0, s3 = 0.0;
+            for (double r : jack.replicates)
+            {
+                const double d = jackMean - r;
+                s2 += d * d;
+                s3 += d * d * d;
+            }
+            const double a = (s2 > 0.0) ? s3 / (6.0 * std::pow(s2, 1.5)) : 0.0;
+
+            auto adjusted = [&](const double p) {
+                const double z = z0 + normalQuantile(p);
+                return normalCdf(z0 + z / (1.0 - a * z));
+            };
+            result.bcaLower = sortedQuantile(sorted, adjusted(alpha / 2.0));
+            result.bcaUpper = sortedQuantile(sorted, adjusted(1.0 - alpha / 2.0));
+            return result;
+        }
+
+        template <typename T, typename Statistic>
+        BootstrapResult bootstrap(const std::vector<T> &data, Statistic statistic, const BootstrapOptions &options)
+        {
+            return bootstrap(data.data(), data.size(), statistic, options);
+        }
+
+        // COVARIANCE() / CORRELATION()
+        // centered copy of X in double precision, the column means go to means
+        template <typename T>
+        Matrix<double> centeredColumns(const Matrix<T> &X, std::vector<double> &means)
+        {
+            const size_t n = X.rows(), p = X.cols();
+            Matrix<double> Xc(n, p);
+            means.assign(p, 0.0);
+            for (size_t i = 0; i < n; i++)
+            {
+                const T *x = X.rowData(i);
+                for (size_t j = 0; j < p; j++)
+                    means[j] += double(x[j]);
+            }
+            for (size_t j = 0; j < p; j++)
+                means[j] /= double(n);
+            for (size_t i = 0; i < n; i++)
+            {
+                const T *x = X.rowData(i);
+                double *xc = Xc.rowData(i);
+                for (size_t j = 0; j < p; j++)
+                    xc[j] = double(x[j]) - means[j];
+            }
+            return Xc;
+        }
+
+        // correlation from a covariance matrix, in place
+        inline void covarianceToCorrelation(Matrix<double> &C)
+        {
+            const size_t p = C.rows();
+            std::vector<double> scale(p);
+            for (size_t j = 0; j < p; j++)
+                scale[j] = (C(j, j) > 0.0) ? 1.0 / std::sqrt(C(j, j)) : std::numeric_limits<double>::quiet_NaN();
+            for (size_t i = 0; i < p; i++)
+            {
+                double *c = C.rowData(i);
+                for (size_t j = 0; j < p; j++)
+                    c[j] = (i == j && scale[i] == scale[i]) ? 1.0 : std::min(std::max(c[j] * scale[i] * scale[j], -1.0), 1.0);
+            }
+        }
+
+        template <typename T>
+        Matrix<double> covariance(const Matrix<T> &X, const bool sample)
+        {
+            const size_t n = X.rows(), p = X.cols();
+            if (n < (sample ? 2u : 1u) || p == 0)
+            {
+                std::cerr << "ERROR: Not enough observations [covariance()]\n";
+                return Matrix<double>(p, p);
+            }
+            INSTRUMENT_SCOPE("stats::covariance");
+            std::vector<double> means;
+            const Matrix<double> Xc = centeredColumns(X, means);
+            Matrix<double> C = Xc.transpose() * Xc;
+            const double divisor = sample ? double(n - 1) : double(n);
+            double *c = C.rawData();
+            for (size_t k = 0; k < p * p; k++)
+                c[k] /= divisor;
+            return C;
+        }
+
+        template <typename T>
+        Matrix<double> correlation(const Matrix<T> &X)
+        {
+            Matrix<double> C = covariance(X);
+            covarianceToCorrelation(C);
+            return C;
+        }
+
+        // PAIRWISECOVARIANCE() / PAIRWISECORRELATION()
+        // pair counts, cross products, partial sums and partial sums of squares over pairwise-complete rows:
+        // entry (j, k) of sums and squares adds z_j and z_j^2 over the rows where variable k is present
+        struct PairwiseMoments
+        {
+            Matrix<double> counts, cross, sums, squares;
+        };
+
+        template <typename T>
+        PairwiseMoments pairwiseMoments(const Matrix<T> &X)
+        {
+            const size_t n = X.rows(), p = X.cols();
+            std::vector<double> means(p, 0.0), present(p, 0.0);
+            for (size_t i = 0; i < n; i++)
+            {
+                const T *x = X.rowData(i);
+                for (size_t j = 0; j < p; j++)
+                    if (!std::isnan(double(x[j])))
+                    {
+                        means[j] += double(x[j]);
+                        present[j] += 1.0;
+                    }
+            }
+            for (size_t j = 0; j < p; j++)
+                means[j] = (present[j] > 0.0) ? means[j] / present[j] : 0.0;
+
+            // centering by the available-case means keeps the raw-moment formulas below free of cancellation
+            Matrix<double> M(n, p), Z(n, p), Z2(n, p);
+            for (size_t i = 0; i < n; i++)
+            {
+                const T *x = X.rowData(i);
+                double *m = M.rowData(i), *z = Z.rowData(i), *z2 = Z2.rowData(i);
+                for (size_t j = 0; j < p; j++)
+                {
+                    const bool ok = !std::isnan(double(x[j]));
+                    m[j] = ok ? 1.0 : 0.0;
+                    z[j] = ok ? double(x[j]) - means[j] : 0.0;
+                    z2[j] = z[j] * z[j];
+                }
+            }
+            const Matrix<double> Zt = Z.transpose();
+            return PairwiseMoments{M.transpose() * M, Zt * Z, Zt * M, Z2.transpose() * M};
+        }
+
+        template <typename T>
+        Matrix<double> pairwiseCovariance(const Matrix<T> &X, const bool sample)
+        {
+            const size_t p = X.cols();
+            if (X.rows() == 0 || p == 0)
+            {
+                std::cerr << "ERROR: Not enough observations [pairwiseCovariance()]\n";
+                return Matrix<double>(p, p);
+            }
+            const PairwiseMoments moments = pairwiseMoments(X);
+            const Matrix<double> &counts = moments.counts, &cross = moments.cross, &Zs = moments.sums;
+            Matrix<double> C(p, p);
+            for (size_t j = 0; j < p; j++)
+                for (size_t k = 0; k < p; k++)
+                {
+                    const double m = counts(j, k);
+                    const double divisor = sample ? m - 1.0 : m;
+                    if (divisor <= 0.0)
+                        C(j, k) = std::numeric_limits<double>::quiet_NaN();
+                    else
+                        C(j, k) = (cross(j, k) - Zs(j, k) * Zs(k, j) / m) / divisor;
+                }
+            return C;
+        }
+
+        template <typename T>
+        Matrix<double> pairwiseCorrelation(const Matrix<T> &X)
+        {
+            const size_t p = X.cols();
+            if (X.rows() == 0 || p == 0)
+            {
+                std::cerr << "ERROR: Not enough observations [pairwiseCorrelation()]\n";
+                return Matrix<double>(p, p);
+            }
+            const PairwiseMoments moments = pairwiseMoments(X);
+            const Matrix<double> &counts = moments.counts, &cross = moments.cross, &Zs = moments.sums, &Zq = moments.squares;
+            Matrix<double> R(p, p);
+            for (size_t j = 0; j < p; j++)
+                for (size_t k = 0; k < p; k++)
+                {
+                    // both variances are taken over the same rows as the cross product
+                    const double m = counts(j, k);
+                    const double sjk = cross(j, k) - Zs(j, k) * Zs(k, j) / m;
+                    const double sjj = Zq(j, k) - Zs(j, k) * Zs(j, k) / m;
+                    const double skk = Zq(k, j) - Zs(k, j) * Zs(k, j) / m;
+                    if (m < 2.0 || !(sjj > 0.0) || !(skk > 0.0))
+                        R(j, k) = std::numeric_limits<double>::quiet_NaN();
+                    else
+                        R(j, k) = (j == k) ? 1.0 : std::min(std::max(sjk / std::sqrt(sjj * skk), -1.0), 1.0);
+                }
+            return R;
+        }
+
+        // COVARIANCEACCUMULATOR
+        inline CovarianceAccumulator::CovarianceAccumulator(const size_t variables)
+        {
+            this->p = variables;
+            this->deviation.assign(variables, 0.0);
+            reset();
+        }
+
+        inline void CovarianceAccumulator::reset()
+        {
+            this->n = 0;
+            this->mu.assign(p, 0.0);
+            this->comoment.assign(p * p, 0.0);
+        }
+
+        template <typename T>
+        void CovarianceAccumulator::push(const T *row)
+        {
+            // Welford: C += (n - 1) / n * d d^T with d measured from the old mean
+            n++;
+            double *d = deviation.data();
+            for (size_t j = 0; j < p; j++)
+            {
+                d[j] = double(row[j]) - mu[j];
+                mu[j] += d[j] / double(n);
+            }
+            const double w = double(n - 1) / double(n);
+            for (size_t j = 0; j < p; j++)
+            {
+                const double dj = w * d[j];
+                double *c = &comoment[j * p];
+                for (size_t k = 0; k < p; k++)
+                    c[k] += dj * d[k];
+            }
+        }
+
+        template <typename T>
+        void CovarianceAccumulator::push(const T *rows, const size_t count)
+        {
+            if (count == 0)
+                return;
+            if (count == 1)
+            {
+                push(rows);
+                return;
+            }
+            Matrix<double> block(count, p);
+            std::vector<double> blockMean(p, 0.0);
+            for (size_t i = 0; i < count; i++)
+                for (size_t j = 0; j < p; j++)
+                    blockMean[j] += double(rows[i * p + j]);
+            for (size_t j = 0; j < p; j++)
+                blockMean[j] /= double(count);
+            for (size_t i = 0; i < count; i++)
+            {
+                double *b = block.rowData(i);
+                for (size_t j = 0; j < p; j++)
+                    b[j] = double(rows[i * p + j]) - blockMean[j];
+            }
+            const Matrix<double> blockComoment = block.transpose() * block;
+            mergeMoments(count, blockMean.data(), blockComoment.rawData());
+        }
+
+        template <typename T>
+        void CovarianceAccumulator::push(const Matrix<T> &rows)
+        {
+            if (rows.cols() != p)
+            {
+                std::cerr << "ERROR: Expected " << p << " columns [push()]\n";
+                return;
+            }
+            if (rows.rows() > 0)
+                push(rows.rawData(), rows.rows());
+        }
+
+        inline void CovarianceAccumulator::mergeMoments(const size_t count, const double *blockMean, const double *blockComoment)
+        {
+            if (count == 0)
+                return;
+            const double na = double(n), nb = double(count), nn = na + nb;
+            double *delta = deviation.data();
+            for (size_t j = 0; j < p; j++)
+                delta[j] = blockMean[j] - mu[j];
+            const double w = na * nb / nn;
+            for (size_t j = 0; j < p; j++)
+            {
+                double *c = &comoment[j * p];
+                const double *cb = blockComoment + j * p;
+                for (size_t k = 0; k < p; k++)
+                    c[k] += cb[k] + w * delta[j] * delta[k];
+                mu[j] += delta[j] * nb / nn;
+            }
+            n += count;
+        }
+
+        inline void CovarianceAccumulator::merge(const CovarianceAccumulator &other)
+        {
+            if (other.p != p)
+            {
+                std::cerr << "ERROR: Accumulators track different numbers of variables [merge()]\n";
+                return;
+            }
+            mergeMoments(other.n, other.mu.data(), other.comoment.data());
+        }
+
+        inline size_t CovarianceAccumulator::variables() const
+        {
+            return p;
+        }
+
+        inline size_t CovarianceAccumulator::count() const
+        {
+            return n;
+        }
+
+        inline std::vector<double> CovarianceAccumulator::mean() const
+        {
+            return mu;
+        }
+
+        inline Matrix<double> CovarianceAccumulator::covariance() const
+        {
+            Matrix<double> C(p, p);
+            for (size_t k = 0; k < p * p; k++)
+                C.rawData()[k] = (n > 0) ? comoment[k] / double(n) : std::numeric_limits<double>::quiet_NaN();
+            return C;
+        }
+
+        inline Matrix<double> CovarianceAccumulator::sampleCovariance() const
+        {
+            Matrix<double> C(p, p);
+            for (size_t k = 0; k < p * p; k++)
+                C.rawData()[k] = (n > 1) ? comoment[k] / double(n - 1) : std::numeric_limits<double>::quiet_NaN();
+            return C;
+        }
+
+        inline Matrix<double> CovarianceAccumulator::correlation() const
+        {
+            Matrix<double> C = covariance();
+            covarianceToCorrelation(C);
+            return C;
+        }
     }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,308 @@
+/*
+Programmer: Connor Fricke (cd.fricke23@gmail.com)
+File: ThreadPool.h
+Latest Revision: 18-Oct-2026
+Synopsis: Header and implementation file for a fixed-size worker thread pool with parallel loop helpers
+*/
+
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+    #include <atomic>
+    #include <condition_variable>
+    #include <cstdlib>
+    #include <exception>
+    #include <functional>
+    #include <mutex>
+    #include <thread>
+    #include <vector>
+
+    // CLASS DEFINITION AND MEMBER FUNCTION DECLARATIONS
+    /*
+    ThreadPool:
+        A fixed set of worker threads that cooperatively execute parallel loops. The calling thread
+        takes part in every loop as worker 0, so a pool of size N starts N-1 background threads.
+        Every loop body receives the index of the worker running it (0 <= worker < size()), which
+        callers use to index per-thread scratch buffers without locking.
+        Loops issued from inside a running loop body are executed serially on the current worker,
+        so library routines built on the pool may safely call each other. A nested loop on a
+        different pool (e.g. a library call made inside a user's own pool) runs serially as that
+        pool's worker 0, so the worker index always stays below the size() of the pool it came from.
+    */
+    class ThreadPool
+    {
+        std::vector<std::thread> workers;
+        std::mutex lock;                    // guards the job state below
+        std::mutex submit;                  // serializes loops issued by different external threads
+        std::condition_variable wake, done;
+        std::function<void(size_t)> job;
+        size_t generation;
+        size_t active;
+        bool stopping;
+        std::exception_ptr error;
+
+        void workerLoop(const size_t id);
+        void run(const std::function<void(size_t)> &task);
+        static size_t &currentWorker();
+        static const ThreadPool *&currentPool();    // pool whose loop the calling thread is running, if any
+        static const ThreadPool *&backgroundPool(); // pool that started the calling thread, if any
+        static bool &insideLoop();
+        static size_t globalThreads();              // size the global pool is built with
+        static std::atomic<const ThreadPool *> &globalPool();   // the global pool once it is built
+
+    public:
+    // CONSTRUCTORS
+        explicit ThreadPool(const size_t numThreads = 0);   // 0 selects std::thread::hardware_concurrency()
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+        ~ThreadPool();
+    // ACCESSORS
+        size_t size() const;
+        static ThreadPool &global();                         // process-wide pool, CPPLIB_THREADS threads if set, else the hardware
+        static size_t globalSize();                          // global().size(), without building the pool
+        bool isGlobal() const;                               // whether this is the pool global() returns
+        size_t workerIndex() const;                          // calling thread's worker index in this pool, 0 outside its loops
+        static const ThreadPool *workerOf();                 // pool whose background thread is calling, nullptr for other threads
+    // PARALLEL LOOPS
+        // body(lo, hi, worker) is called on disjoint chunks [lo, hi) covering [begin, end),
+        // chunks are at least `grain` iterations long and are handed out dynamically
+        template <typename F>
+        void parallelRange(const size_t begin, const size_t end, F &&body, const size_t grain = 1);
+        // body(i, worker) is called once for every i in [begin, end)
+        template <typename F>
+        void parallelFor(const size_t begin, const size_t end, F &&body, const size_t grain = 1);
+    };
+
+    // MEMBER FUNCTION DEFINITIONS
+
+    // CONSTRUCTORS
+    inline ThreadPool::ThreadPool(const size_t numThreads)
+    {
+        size_t n = numThreads;
+        if (n == 0)
+            n = std::thread::hardware_concurrency();
+        if (n == 0)
+            n = 1;
+
+        this->generation = 0;
+        this->active = 0;
+        this->stopping = false;
+        for (size_t id = 1; id < n; id++)
+        {
+            workers.emplace_back(&ThreadPool::workerLoop, this, id);
+        }
+    }
+
+    inline ThreadPool::~ThreadPool()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread &worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    // ACCESSORS
+    inline size_t ThreadPool::size() const
+    {
+        return workers.size() + 1;
+    }
+
+    inline size_t ThreadPool::globalThreads()
+    {
+        // the CPPLIB_THREADS environment variable overrides the size, e.g. to test results against thread counts
+        const char *threads = std::getenv("CPPLIB_THREADS");
+        size_t n = (threads != nullptr) ? size_t(std::strtoul(threads, nullptr, 10)) : size_t(0);
+        if (n == 0)
+            n = std::thread::hardware_concurrency();
+        return (n == 0) ? 1 : n;
+    }
+
+    inline std::atomic<const ThreadPool *> &ThreadPool::globalPool()
+    {
+        static std::atomic<const ThreadPool *> pool(nullptr);
+        return pool;
+    }
+
+    inline ThreadPool &ThreadPool::global()
+    {
+        static ThreadPool pool(globalSize());
+        static const bool registered = (globalPool().store(&pool, std::memory_order_release), true);
+        (void)registered;
+        return pool;
+    }
+
+    inline size_t ThreadPool::globalSize()
+    {
+        // resolved once, so the size reported before the pool exists is the size it is built with
+        static const size_t threads = globalThreads();
+        return threads;
+    }
+
+    inline bool ThreadPool::isGlobal() const
+    {
+        return globalPool().load(std::memory_order_acquire) == this;
+    }
+
+    inline size_t &ThreadPool::currentWorker()
+    {
+        thread_local size_t id = 0;
+        return id;
+    }
+
+    inline const ThreadPool *&ThreadPool::currentPool()
+    {
+        thread_local const ThreadPool *pool = nullptr;
+        return pool;
+    }
+
+    inline const ThreadPool *&ThreadPool::backgroundPool()
+    {
+        thread_local const ThreadPool *pool = nullptr;
+        return pool;
+    }
+
+    inline size_t ThreadPool::workerIndex() const
+    {
+        return (currentPool() == this) ? currentWorker() : 0;
+    }
+
+    inline const ThreadPool *ThreadPool::workerOf()
+    {
+        return backgroundPool();
+    }
+
+    inline bool &ThreadPool::insideLoop()
+    {
+        thread_local bool inside = false;
+        return inside;
+    }
+
+    // WORKERS
+    inline void ThreadPool::workerLoop(const size_t id)
+    {
+        currentWorker() = id;
+        currentPool() = this;
+        backgroundPool() = this;
+        size_t seen = 0;
+        while (true)
+        {
+            std::function<void(size_t)> task;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                wake.wait(guard, [&] { return stopping || generation != seen; });
+                if (stopping)
+                    return;
+                seen = generation;
+                task = job;
+            }
+
+            insideLoop() = true;
+            try
+            {
+                task(id);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                if (!error)
+                    error = std::current_exception();
+            }
+            insideLoop() = false;
+
+            std::lock_guard<std::mutex> guard(lock);
+            if (--active == 0)
+                done.notify_one();
+        }
+    }
+
+    inline void ThreadPool::run(const std::function<void(size_t)> &task)
+    {
+        std::lock_guard<std::mutex> serial(submit);
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            job = task;
+            active = workers.size();
+            error = nullptr;
+            generation++;
+        }
+        wake.notify_all();
+
+        // the calling thread is worker 0
+        const size_t previous = currentWorker();
+        const ThreadPool *previousPool = currentPool();
+        currentWorker() = 0;
+        currentPool() = this;
+        insideLoop() = true;
+        std::exception_ptr callerError;
+        try
+        {
+            task(0);
+        }
+        catch (...)
+        {
+            callerError = std::current_exception();
+        }
+        insideLoop() = false;
+        currentWorker() = previous;
+        currentPool() = previousPool;
+
+        std::unique_lock<std::mutex> guard(lock);
+        done.wait(guard, [&] { return active == 0; });
+        job = nullptr;
+        if (callerError)
+            std::rethrow_exception(callerError);
+        if (error)
+            std::rethrow_exception(error);
+    }
+
+    // PARALLEL LOOPS
+    template <typename F>
+    void ThreadPool::parallelRange(const size_t begin, const size_t end, F &&body, const size_t grain)
+    {
+        if (end <= begin)
+            return;
+        const size_t n = end - begin;
+        const size_t threads = size();
+
+        // serial fallback: single thread, nested loop, or too little work to split
+        if (threads == 1 || insideLoop() || n <= grain)
+        {
+            body(begin, end, workerIndex());
+            return;
+        }
+
+        // a few chunks per thread keeps the load balanced without much scheduling traffic
+        size_t chunk = (n + 4 * threads - 1) / (4 * threads);
+        if (chunk < grain)
+            chunk = grain;
+
+        std::atomic<size_t> next(begin);
+        run([&](size_t worker) {
+            while (true)
+            {
+                size_t lo = next.fetch_add(chunk);
+                if (lo >= end)
+                    break;
+                size_t hi = (end - lo > chunk) ? lo + chunk : end;
+                body(lo, hi, worker);
+            }
+        });
+    }
+
+    template <typename F>
+    void ThreadPool::parallelFor(const size_t begin, const size_t end, F &&body, const size_t grain)
+    {
+        parallelRange(begin, end, [&](size_t lo, size_t hi, size_t worker) {
+            for (size_t i = lo; i < hi; i++)
+            {
+                body(i, worker);
+            }
+        }, grain);
+    }
+
+#endif
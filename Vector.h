@@ -1,7 +1,7 @@
 /*
 Programmer: Connor Fricke (cd.fricke23@gmail.com)
 File: Vector.h
-Latest Revision: 11-Apr-2025
+Latest Revision: 18-Oct-2026
 Synopsis: Header and implementation file for templated Vector class and member routines
 */
 
@@ -10,6 +10,8 @@ Synopsis: Header and implementation file for templated Vector class and member r
 
     #include <cstdlib>
     #include <iostream>
+    #include "Bounds.h"
+    #include "Instrument.h"
 
     // CLASS DEFINITION AND MEMBER FUNCTION DECLARATIONS
     template <typename T>
@@ -28,7 +30,7 @@ Synopsis: Header and implementation file for templated Vector class and member r
         Vector(const size_t N);                         // sized
         Vector(const size_t N, bool isRow);             // sized with row control
         Vector(const Vector<T>& V);                     // copy
-        Vector(const Vector<T>&& V);                    // move
+        Vector(Vector<T>&& V);                          // move
         Vector(const std::initializer_list<T>& init);   // initializer
         ~Vector();                                      // destructor
     // IO
@@ -36,11 +38,15 @@ Synopsis: Header and implementation file for templated Vector class and member r
         template <typename U>
         friend std::ostream &operator<<(std::ostream &out, Vector<U> &V);
     // ACCESSORS
-        T at(const size_t n) const;
+        T at(const size_t n) const;                     // checked according to BOUNDS_POLICY
+        T& operator[](const size_t n);                  // unchecked
+        const T& operator[](const size_t n) const;
         size_t size() const;
         bool row() const;
+        T* rawData();                                   // unchecked pointer to the N contiguous elements
+        const T* rawData() const;
     // MUTATORS
-        void set(const size_t n, const T &val);
+        void set(const size_t n, const T &val);         // checked according to BOUNDS_POLICY
         void resize(const size_t N);
         void clear();
     // OPERATORS
@@ -57,9 +63,10 @@ Synopsis: Header and implementation file for templated Vector class and member r
     T* Vector<T>::allocate(const size_t N) 
     {
         if (N == 0) {
-            std::cout << "WARNING: No memory allocated for empty vector.\n";
+            INSTRUMENT_COUNT("Vector empty allocation", 0);
             return nullptr;
         }
+        INSTRUMENT_COUNT("Vector allocation", N * sizeof(T));
         T* newData = new T[N];
         for (size_t i = 0; i < N; i++)
         {
@@ -106,6 +113,7 @@ Synopsis: Header and implementation file for templated Vector class and member r
     template <typename T>
     Vector<T>::Vector(const Vector<T>& V)
     {
+        INSTRUMENT_COUNT("Vector copy construct", V.N * sizeof(T));
         this->N = V.N;
         this->isRow = V.isRow;
         this->data = allocate(V.N);
@@ -116,8 +124,9 @@ Synopsis: Header and implementation file for templated Vector class and member r
     }
 
     template <typename T>
-    Vector<T>::Vector(const Vector<T>&& V)
+    Vector<T>::Vector(Vector<T>&& V)
     {
+        INSTRUMENT_COUNT("Vector move construct", 0);
         // Steal the data
         this->N = V.N;
         this->isRow = V.isRow;
@@ -125,6 +134,7 @@ Synopsis: Header and implementation file for templated Vector class and member r
 
         // Disconnect V ownership
         V.data = nullptr;
+        V.N = 0;
     }
 
     template <typename T>
@@ -187,10 +197,19 @@ Synopsis: Header and implementation file for templated Vector class and member r
     // ACCESSORS
     template <typename T>
     T Vector<T>::at(const size_t n) const {
-        if (n > this->N - 1) {
-            std::cerr << "ERROR: Out of range [at()]\n";
-            return (T)0;
-        }
+        BOUNDS_CHECK(n < this->N, "Vector index out of range [at()]");
+        return this->data[n];
+    }
+
+    template <typename T>
+    T& Vector<T>::operator[](const size_t n)
+    {
+        return this->data[n];
+    }
+
+    template <typename T>
+    const T& Vector<T>::operator[](const size_t n) const
+    {
         return this->data[n];
     }
 
@@ -200,14 +219,17 @@ Synopsis: Header and implementation file for templated Vector class and member r
     template <typename T>
     bool Vector<T>::row() const {return this->isRow;}
 
+    template <typename T>
+    T* Vector<T>::rawData() {return this->data;}
+
+    template <typename T>
+    const T* Vector<T>::rawData() const {return this->data;}
+
     // MUTATORS
     template <typename T>
     void Vector<T>::set(const size_t n, const T &val)
     {
-        if (n > this->N - 1) {
-            std::cerr << "ERROR: Out of range! [set()]\n";
-            return;
-        }
+        BOUNDS_CHECK(n < this->N, "Vector index out of range [set()]");
         this->data[n] = val;
     }
     
@@ -0,0 +1,299 @@
+/*
+Programmer: Connor Fricke (cd.fricke23@gmail.com)
+File: Benchmark.h
+Latest Revision: 18-Oct-2026
+Synopsis: Header and implementation file for the benchmark harness used by the bench/ programs
+*/
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+    #include <algorithm>
+    #include <chrono>
+    #include <cmath>
+    #include <cstdio>
+    #include <cstdlib>
+    #include <ctime>
+    #include <fstream>
+    #include <iostream>
+    #include <string>
+    #include <thread>
+    #include <vector>
+
+    // DECLARATIONS
+    namespace bench {
+        /*
+        Options (command line of every benchmark program):
+            --json <file>   also write the results as JSON, for tracking regressions between versions
+            --filter <text> only run cases whose name contains text
+            --quick         smallest sizes and few repetitions, used as a smoke test by ctest
+            --min-time <s>  minimum measured time per case (default 0.5 s)
+        */
+        struct Options
+        {
+            std::string json;
+            std::string filter;
+            bool quick = false;
+            double minTime = 0.5;
+            size_t minRepetitions = 10;
+            size_t maxRepetitions = 1000;
+        };
+
+        Options parseArguments(int argc, char **argv);
+
+        /*
+        Result:
+            One case at one size. Times are seconds per iteration. work is the amount of `unit` (FLOP,
+            bytes, samples, evaluations, ...) one iteration performs, so throughput = work / median.
+            ciLow/ciHigh bound the median with 95% confidence (distribution free, from order statistics),
+            mad is the median absolute deviation of the repetitions.
+        */
+        struct Result
+        {
+            std::string name;
+            size_t size = 0;
+            std::string unit;
+            double work = 0.0;
+            size_t repetitions = 0;
+            size_t iterations = 0;      // iterations per repetition
+            double median = 0.0, mean = 0.0, stdev = 0.0, min = 0.0, mad = 0.0;
+            double ciLow = 0.0, ciHigh = 0.0;
+            double throughput = 0.0;    // unit per second at the median time
+        };
+
+        /*
+        Runner:
+            run(name, size, work, unit, body) times body() (one iteration). It warms up once, calibrates
+            the iterations per repetition so a repetition lasts at least ~1/50 of the time budget (timer
+            resolution and call overhead become negligible), then repeats until both minRepetitions and
+            minTime are reached. Every case is printed as it completes; finish() writes the JSON file and
+            returns the program's exit status.
+        */
+        class Runner
+        {
+            std::string suite;
+            Options options;
+            std::vector<Result> results;
+
+        public:
+        // CONSTRUCTORS
+            Runner(const std::string &suite, int argc, char **argv);
+        // ACCESSORS
+            bool quick() const;
+            // quick ? small : full, for picking problem sizes
+            std::vector<size_t> sizes(const std::vector<size_t> &full, const std::vector<size_t> &small) const;
+        // MEASUREMENT
+            template <typename F>
+            void run(const std::string &name, const size_t size, const double work, const std::string &unit, F &&body);
+            int finish();
+        };
+
+        // keeps a value (and the computation producing it) from being optimized away
+        template <typename T>
+        void doNotOptimize(const T &value);
+
+        // "1.23 G" style formatting of a rate
+        std::string scaled(const double value);
+    }
+
+    // DEFINITIONS
+    namespace bench {
+
+        template <typename T>
+        void doNotOptimize(const T &value)
+        {
+        #if defined(__GNUC__) || defined(__clang__)
+            asm volatile("" : : "r,m"(value) : "memory");
+        #else
+            static volatile const void *sink;
+            sink = &value;
+        #endif
+        }
+
+        inline std::string scaled(const double value)
+        {
+            const char *prefixes[] = {"", "k", "M", "G", "T"};
+            double v = value;
+            int p = 0;
+            while (std::abs(v) >= 1000.0 && p < 4)
+            {
+                v /= 1000.0;
+                p++;
+            }
+            char text[32];
+            std::snprintf(text, sizeof(text), "%7.3f %s", v, prefixes[p]);
+            return text;
+        }
+
+        inline Options parseArguments(int argc, char **argv)
+        {
+            Options options;
+            for (int i = 1; i < argc; i++)
+            {
+                const std::string arg = argv[i];
+                if (arg == "--json" && i + 1 < argc)
+                    options.json = argv[++i];
+                else if (arg == "--filter" && i + 1 < argc)
+                    options.filter = argv[++i];
+                else if (arg == "--min-time" && i + 1 < argc)
+                    options.minTime = std::atof(argv[++i]);
+                else if (arg == "--quick")
+                    options.quick = true;
+                else
+                    std::cerr << "ERROR: Unknown argument " << arg << " [parseArguments()]\n";
+            }
+            if (options.quick)
+            {
+                options.minTime = 0.01;
+                options.minRepetitions = 3;
+            }
+            return options;
+        }
+
+        // RUNNER
+        inline Runner::Runner(const std::string &suite, int argc, char **argv)
+        {
+            this->suite = suite;
+            this->options = parseArguments(argc, argv);
+            std::printf("%-40s %10s %12s %10s %18s  %s\n", (suite + " case").c_str(), "size", "median", "+/- CI", "throughput", "reps x iters");
+        }
+
+        inline bool Runner::quick() const
+        {
+            return options.quick;
+        }
+
+        inline std::vector<size_t> Runner::sizes(const std::vector<size_t> &full, const std::vector<size_t> &small) const
+        {
+            return options.quick ? small : full;
+        }
+
+        template <typename F>
+        void Runner::run(const std::string &name, const size_t size, const double work, const std::string &unit, F &&body)
+        {
+            if (!options.filter.empty() && name.find(options.filter) == std::string::npos)
+                return;
+            typedef std::chrono::steady_clock Clock;
+            auto seconds = [](Clock::time_point a, Clock::time_point b) { return std::chrono::duration<double>(b - a).count(); };
+
+            // warm-up (caches, page faults, lazily built tables), also the first calibration point
+            Clock::time_point start = Clock::now();
+            body();
+            double once = seconds(start, Clock::now());
+
+            // very short bodies: time a longer batch, so the per-iteration estimate is not just timer noise
+            const double target = options.minTime / 50.0;
+            if (once < 1e-4)
+            {
+                const size_t batch = size_t(std::min(1e6, std::ceil(1e-4 / std::max(once, 1e-9))));
+                start = Clock::now();
+                for (size_t k = 0; k < batch; k++)
+                    body();
+                once = seconds(start, Clock::now()) / double(batch);
+            }
+            const size_t iterations = (once >= target) ? 1 : size_t(std::min(1e9, std::ceil(target / std::max(once, 1e-10))));
+
+            std::vector<double> samples;
+            double elapsed = 0.0;
+            while (samples.size() < options.minRepetitions || (elapsed < options.minTime && samples.size() < options.maxRepetitions))
+            {
+                start = Clock::now();
+                for (size_t k = 0; k < iterations; k++)
+                    body();
+                const double t = seconds(start, Clock::now());
+                samples.push_back(t / double(iterations));
+                elapsed += t;
+            }
+
+            Result r;
+            r.name = name;
+            r.size = size;
+            r.unit = unit;
+            r.work = work;
+            r.repetitions = samples.size();
+            r.iterations = iterations;
+
+            std::vector<double> sorted = samples;
+            std::sort(sorted.begin(), sorted.end());
+            const size_t n = sorted.size();
+            r.median = (n % 2) ? sorted[n / 2] : 0.5 * (sorted[n / 2 - 1] + sorted[n / 2]);
+            r.min = sorted[0];
+            double total = 0.0;
+            for (double s : samples)
+                total += s;
+            r.mean = total / double(n);
+            double ss = 0.0;
+            for (double s : samples)
+                ss += (s - r.mean) * (s - r.mean);
+            r.stdev = (n > 1) ? std::sqrt(ss / double(n - 1)) : 0.0;
+            std::vector<double> deviations(n);
+            for (size_t i = 0; i < n; i++)
+                deviations[i] = std::abs(sorted[i] - r.median);
+            std::sort(deviations.begin(), deviations.end());
+            r.mad = deviations[n / 2];
+            // ranks n/2 -+ 1.96 sqrt(n)/2 bracket the median with ~95% probability (normal approximation to the binomial)
+            const double halfWidth = 0.98 * std::sqrt(double(n));
+            const long lowRank = std::max(0L, long(std::floor(double(n) / 2.0 - halfWidth)));
+            const long highRank = std::min(long(n) - 1, long(std::ceil(double(n) / 2.0 + halfWidth)));
+            r.ciLow = sorted[size_t(lowRank)];
+            r.ciHigh = sorted[size_t(highRank)];
+            r.throughput = (r.median > 0.0) ? work / r.median : 0.0;
+            results.push_back(r);
+
+            const double ci = 0.5 * (r.ciHigh - r.ciLow) / r.median * 100.0;
+            std::printf("%-40s %10zu %10.3e s %8.2f %% %15s%s/s  %zu x %zu\n", name.c_str(), size, r.median, ci,
+                        scaled(r.throughput).c_str(), unit.c_str(), r.repetitions, r.iterations);
+            std::fflush(stdout);
+        }
+
+        inline int Runner::finish()
+        {
+            if (options.json.empty())
+                return 0;
+            std::ofstream out(options.json);
+            if (!out)
+            {
+                std::cerr << "ERROR: Cannot write " << options.json << " [finish()]\n";
+                return 1;
+            }
+            auto quote = [](const std::string &s) {
+                std::string q = "\"";
+                for (char c : s)
+                {
+                    if (c == '"' || c == '\\')
+                        q += '\\';
+                    q += c;
+                }
+                return q + "\"";
+            };
+            char number[64];
+            auto num = [&](const double x) {
+                std::snprintf(number, sizeof(number), "%.9g", x);
+                return std::string(number);
+            };
+
+            out << "{\n";
+            out << "  \"suite\": " << quote(suite) << ",\n";
+            out << "  \"timestamp\": " << long(std::time(nullptr)) << ",\n";
+        #if defined(__VERSION__)
+            out << "  \"compiler\": " << quote(__VERSION__) << ",\n";
+        #endif
+            out << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+            out << "  \"quick\": " << (options.quick ? "true" : "false") << ",\n";
+            out << "  \"results\": [\n";
+            for (size_t i = 0; i < results.size(); i++)
+            {
+                const Result &r = results[i];
+                out << "    {\"name\": " << quote(r.name) << ", \"size\": " << r.size << ", \"unit\": " << quote(r.unit)
+                    << ", \"work\": " << num(r.work) << ", \"repetitions\": " << r.repetitions << ", \"iterations\": " << r.iterations
+                    << ", \"median_s\": " << num(r.median) << ", \"mean_s\": " << num(r.mean) << ", \"stdev_s\": " << num(r.stdev)
+                    << ", \"min_s\": " << num(r.min) << ", \"mad_s\": " << num(r.mad) << ", \"ci95_low_s\": " << num(r.ciLow)
+                    << ", \"ci95_high_s\": " << num(r.ciHigh) << ", \"throughput\": " << num(r.throughput) << "}"
+                    << ((i + 1 < results.size()) ? ",\n" : "\n");
+            }
+            out << "  ]\n}\n";
+            return 0;
+        }
+    }
+
+#endif
@@ -0,0 +1,66 @@
+#include "Benchmark.h"
+#include "../DSP.h"
+#include <vector>
+
+// DSP.h: signal generation, DFT/FFT, Goertzel and the FIR/IIR filters, in samples per second.
+
+using namespace dsp;
+
+int main(int argc, char **argv)
+{
+    bench::Runner runner("dsp", argc, argv);
+    rng::seedThreadEngines(1);
+
+    for (size_t n : runner.sizes({1 << 12, 1 << 16, 1 << 20}, {1 << 10}))
+    {
+        const std::vector<double> t = generateTiming(1000.0, int(n));
+        const std::vector<SignalComponent> components = {{1.0, 50.0, 0.0}, {0.5, 120.0, 0.3}, {0.25, 310.0, 1.1}};
+        std::vector<double> x;
+        runner.run("generateSignal (3 components)", n, double(n), "samples", [&] {
+            x = generateSignal(t, components);
+            bench::doNotOptimize(x.data());
+        });
+
+        const std::vector<double> taps = designLowpass(63, 0.1);
+        runner.run("firFilter (63 taps)", n, double(n), "samples", [&] {
+            std::vector<double> y = firFilter(x, taps);
+            bench::doNotOptimize(y.data());
+        });
+        runner.run("lowpassFIR", n, double(n), "samples", [&] {
+            std::vector<double> y = lowpassFIR(x, 0.3);
+            bench::doNotOptimize(y.data());
+        });
+        runner.run("movingAvgIIR", n, double(n), "samples", [&] {
+            std::vector<double> y = movingAvgIIR(x, 0.05);
+            bench::doNotOptimize(y.data());
+        });
+        runner.run("goertzelIIR", n, double(n), "samples", [&] {
+            dcomp g = goertzelIIR(x, 100);
+            bench::doNotOptimize(g);
+        });
+        runner.run("resample (3/2)", n, double(n), "samples", [&] {
+            std::vector<double> y = resample(x, 3, 2);
+            bench::doNotOptimize(y.data());
+        });
+        runner.run("FFT", n, double(n), "samples", [&] {
+            std::vector<dcomp> X = FFT(x);
+            bench::doNotOptimize(X.data());
+        });
+    }
+
+    // the direct DFT is O(N K): 64 bins of growing frames
+    for (size_t n : runner.sizes({1 << 10, 1 << 14}, {1 << 8}))
+    {
+        std::vector<double> x(n);
+        for (size_t i = 0; i < n; i++)
+            x[i] = getRandomFloat(-1.0, 1.0);
+        std::vector<int> bins(64);
+        for (int k = 0; k < 64; k++)
+            bins[size_t(k)] = k;
+        runner.run("DFT (64 bins)", n, double(n), "samples", [&] {
+            std::vector<dcomp> X = DFT(x, bins);
+            bench::doNotOptimize(X.data());
+        });
+    }
+    return runner.finish();
+}
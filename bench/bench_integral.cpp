@@ -0,0 +1,54 @@
+#include "Benchmark.h"
+#include "../Integral.h"
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+// Integral.h: fixed-rule, adaptive and Monte Carlo integration, in integrand evaluations per second.
+
+using namespace integral;
+
+int main(int argc, char **argv)
+{
+    bench::Runner runner("integral", argc, argv);
+    auto f = [](double x) { return std::exp(-x * x) * std::cos(3.0 * x); };
+
+    for (size_t n : runner.sizes({1000, 100000, 10000000}, {1000}))
+    {
+        runner.run("trapezoidal", n, double(n + 1), "evals", [&] {
+            bench::doNotOptimize(trapezoidal(f, -2.0, 2.0, int(n)));
+        });
+        runner.run("simpsons", n, double(n + 1), "evals", [&] {
+            bench::doNotOptimize(simpsons(f, -2.0, 2.0, int(n)));
+        });
+        runner.run("simpsons (batch integrand)", n, double(n + 1), "evals", [&] {
+            bench::doNotOptimize(simpsons(batch([&](const double *x, double *y, size_t m) {
+                for (size_t i = 0; i < m; i++)
+                    y[i] = std::exp(-x[i] * x[i]) * std::cos(3.0 * x[i]);
+            }), -2.0, 2.0, int(n)));
+        });
+        runner.run("monteCarlo (pseudo-random)", n, double(n), "evals", [&] {
+            bench::doNotOptimize(monteCarlo(f, -2.0, 2.0, n, MonteCarloOptions()).value);
+        });
+    }
+
+    // adaptive routines: report the evaluations they actually needed
+    for (double tol : {1e-6, 1e-10})
+    {
+        char suffix[32];
+        std::snprintf(suffix, sizeof(suffix), ", tol %g", tol);
+        const QuadratureResult probe = gaussKronrod([](double x) { return std::sqrt(x) * std::log(x + 1e-300); }, 0.0, 1.0,
+                                                    QuadratureOptions{tol, tol});
+        runner.run(std::string("gaussKronrod sqrt(x) log x") + suffix, probe.evaluations, double(probe.evaluations), "evals", [&] {
+            bench::doNotOptimize(gaussKronrod([](double x) { return std::sqrt(x) * std::log(x + 1e-300); }, 0.0, 1.0,
+                                              QuadratureOptions{tol, tol}).value);
+        });
+        const QuadratureResult cubes = cubature([](const double *x) { return std::exp(-(x[0] * x[0] + x[1] * x[1] + x[2] * x[2])); },
+                                                {0.0, 0.0, 0.0}, {1.0, 1.0, 1.0}, CubatureOptions{tol, tol});
+        runner.run(std::string("cubature 3-D gaussian") + suffix, cubes.evaluations, double(cubes.evaluations), "evals", [&] {
+            bench::doNotOptimize(cubature([](const double *x) { return std::exp(-(x[0] * x[0] + x[1] * x[1] + x[2] * x[2])); },
+                                          {0.0, 0.0, 0.0}, {1.0, 1.0, 1.0}, CubatureOptions{tol, tol}).value);
+        });
+    }
+    return runner.finish();
+}
@@ -0,0 +1,79 @@
+#include "Benchmark.h"
+#include "../Matrix.h"
+#include <new>
+#include <string>
+#include <utility>
+
+// Matrix/Vector construction, copy and move, elementwise operators, transpose and multiply.
+// Move benchmarks hand the storage back with placement new: a moved-from object owns nothing, so
+// constructing over it leaks nothing, and it keeps the (tracing) assignment operators out of the timing.
+
+int main(int argc, char **argv)
+{
+    bench::Runner runner("linalg", argc, argv);
+
+    for (size_t n : runner.sizes({64, 256, 1024}, {32}))
+    {
+        const double bytes = double(n * n * sizeof(double));
+        Matrix<double> A(n, n), B(n, n);
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < n; j++)
+            {
+                A.set(i, j, double(i + 2 * j) / double(n));
+                B.set(i, j, double(3 * i + j) / double(n));
+            }
+
+        runner.run("Matrix construct (zeroed)", n, bytes, "B", [&] {
+            Matrix<double> C(n, n);
+            bench::doNotOptimize(C.rawData());
+        });
+        runner.run("Matrix copy construct", n, 2.0 * bytes, "B", [&] {
+            Matrix<double> C(A);
+            bench::doNotOptimize(C.rawData());
+        });
+        runner.run("Matrix move construct", n, 1.0, "op", [&] {
+            Matrix<double> C(std::move(A));
+            bench::doNotOptimize(C.rawData());
+            new (&A) Matrix<double>(std::move(C));
+        });
+        runner.run("Matrix operator+", n, 3.0 * bytes, "B", [&] {
+            Matrix<double> C = A + B;
+            bench::doNotOptimize(C.rawData());
+        });
+        runner.run("Matrix scalar operator*", n, 2.0 * bytes, "B", [&] {
+            Matrix<double> C = 2.0 * A;
+            bench::doNotOptimize(C.rawData());
+        });
+        runner.run("Matrix transpose", n, 2.0 * bytes, "B", [&] {
+            Matrix<double> C = A.transpose();
+            bench::doNotOptimize(C.rawData());
+        });
+        if (n <= 1024)
+        {
+            runner.run("Matrix operator* (GEMM)", n, 2.0 * double(n) * double(n) * double(n), "FLOP", [&] {
+                Matrix<double> C = A * B;
+                bench::doNotOptimize(C.rawData());
+            });
+        }
+    }
+
+    for (size_t n : runner.sizes({1 << 10, 1 << 16, 1 << 22}, {1 << 10}))
+    {
+        const double bytes = double(n * sizeof(double));
+        Vector<double> v(n);
+        runner.run("Vector construct (zeroed)", n, bytes, "B", [&] {
+            Vector<double> w(n);
+            bench::doNotOptimize(w.rawData());
+        });
+        runner.run("Vector copy construct", n, 2.0 * bytes, "B", [&] {
+            Vector<double> w(v);
+            bench::doNotOptimize(w.rawData());
+        });
+        runner.run("Vector move construct", n, 1.0, "op", [&] {
+            Vector<double> w(std::move(v));
+            bench::doNotOptimize(w.rawData());
+            new (&v) Vector<double>(std::move(w));
+        });
+    }
+    return runner.finish();
+}
@@ -0,0 +1,113 @@
+#include "../DSP.h"
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+// Throughput (samples/s) and accuracy (max abs error against the double kernels, in full-scale units)
+// of the sample-type-generic DSP kernels for float32, Q15 and complex<float> data.
+
+using namespace dsp;
+
+template <typename T>
+double toDouble(const T &x) { return double(x); }
+double toDouble(const q15 &x) { return x.toDouble(); }
+double toDouble(const std::complex<float> &x) { return double(x.real()); }
+
+template <typename T>
+std::vector<T> convert(const std::vector<double> &x)
+{
+    std::vector<T> out(x.size());
+    for (size_t i = 0; i < x.size(); i++)
+        out[i] = SampleTraits<T>::fromDouble(x[i]);
+    return out;
+}
+
+template <typename F>
+double samplesPerSecond(const size_t n, F &&kernel)
+{
+    // best of several repetitions
+    double best = 1e30;
+    for (int rep = 0; rep < 5; rep++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        kernel();
+        auto stop = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double>(stop - start).count());
+    }
+    return double(n) / best;
+}
+
+template <typename T, typename U>
+double maxError(const std::vector<T> &x, const std::vector<U> &reference)
+{
+    double err = 0.0;
+    for (size_t i = 0; i < x.size() && i < reference.size(); i++)
+        err = std::max(err, std::abs(toDouble(x[i]) - double(reference[i])));
+    return err;
+}
+
+template <typename T>
+void report(const char *type, const std::vector<double> &signal)
+{
+    const std::vector<T> x = convert<T>(signal);
+    const std::vector<double> taps = designLowpass(63, 0.1);
+    const size_t n = x.size();
+
+    std::vector<T> y;
+    double rate = samplesPerSecond(n, [&] { y = firFilter(x, taps); });
+    std::printf("%-16s %-14s %10.3e samples/s   max error %.3e\n", type, "firFilter(63)", rate, maxError(y, firFilter(signal, taps)));
+
+    rate = samplesPerSecond(n, [&] { y = lowpassFIR(x, 0.3); });
+    std::printf("%-16s %-14s %10.3e samples/s   max error %.3e\n", type, "lowpassFIR", rate, maxError(y, lowpassFIR(signal, 0.3)));
+
+    rate = samplesPerSecond(n, [&] { y = movingAvgIIR(x, 0.05); });
+    std::printf("%-16s %-14s %10.3e samples/s   max error %.3e\n", type, "movingAvgIIR", rate, maxError(y, movingAvgIIR(signal, 0.05)));
+
+    rate = samplesPerSecond(n, [&] { y = resample(x, 3, 2); });
+    std::printf("%-16s %-14s %10.3e samples/s   max error %.3e\n", type, "resample(3/2)", rate, maxError(y, resample(signal, 3, 2)));
+
+    const std::vector<T> frame(x.begin(), x.begin() + 4096);
+    const std::vector<double> frameRef(signal.begin(), signal.begin() + 4096);
+    typename SampleTraits<T>::complex_type g;
+    rate = samplesPerSecond(4096, [&] { g = goertzelIIR(frame, 100); });
+    const double gErr = std::abs(std::complex<double>(g.real(), g.imag()) - goertzelIIR(frameRef, 100)) / 4096.0;
+    std::printf("%-16s %-14s %10.3e samples/s   max error %.3e (per sample)\n", type, "goertzelIIR", rate, gErr);
+}
+
+int main()
+{
+    const size_t n = 1 << 20;
+    std::vector<double> signal(n);
+    for (size_t i = 0; i < n; i++)
+        signal[i] = 0.45 * sin(0.01 * double(i)) + 0.2 * sin(0.37 * double(i)) + getRandomFloat(-0.1, 0.1);
+
+    std::printf("CPU features: avx2=%d fma=%d\n\n", int(cpuFeatures().avx2), int(cpuFeatures().fma));
+    report<double>("double", signal);
+    report<float>("float", signal);
+    report<q15>("q15", signal);
+    report<std::complex<float>>("complex<float>", signal);
+
+    // FFT: float and Q15 against the double transform (Q15 output is X/N)
+    const size_t N = 4096;
+    const std::vector<double> frame(signal.begin(), signal.begin() + N);
+    const std::vector<dcomp> reference = FFT(frame);
+    const std::vector<float> frameF(frame.begin(), frame.end());
+    const std::vector<q15> frameQ = convert<q15>(frame);
+
+    std::vector<std::complex<float>> XF;
+    std::vector<cq15> XQ;
+    std::vector<dcomp> XD;
+    double rateD = samplesPerSecond(N, [&] { XD = FFT(frame); });
+    double rateF = samplesPerSecond(N, [&] { XF = FFT(frameF); });
+    double rateQ = samplesPerSecond(N, [&] { XQ = FFT(frameQ); });
+    double errF = 0.0, errQ = 0.0;
+    for (size_t k = 0; k < N; k++)
+    {
+        errF = std::max(errF, std::abs(dcomp(XF[k].real(), XF[k].imag()) - reference[k]) / double(N));
+        errQ = std::max(errQ, std::abs(dcomp(XQ[k].re.toDouble(), XQ[k].im.toDouble()) - reference[k] / double(N)));
+    }
+    std::printf("\n%-16s %-14s %10.3e samples/s\n", "double", "FFT(4096)", rateD);
+    std::printf("%-16s %-14s %10.3e samples/s   max error %.3e (of X/N)\n", "float", "FFT(4096)", rateF, errF);
+    std::printf("%-16s %-14s %10.3e samples/s   max error %.3e (of X/N)\n", "q15", "FFT(4096)", rateQ, errQ);
+    return 0;
+}
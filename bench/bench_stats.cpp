@@ -0,0 +1,62 @@
+#include "Benchmark.h"
+#include "../Stats.h"
+#include <vector>
+
+// Stats.h: reductions (GB/s), streaming accumulators and sketches (samples/s), random generation,
+// covariance (GFLOP/s) and bootstrap.
+
+int main(int argc, char **argv)
+{
+    bench::Runner runner("stats", argc, argv);
+
+    for (size_t n : runner.sizes({1 << 12, 1 << 18, 1 << 24}, {1 << 12}))
+    {
+        const double bytes = double(n * sizeof(double));
+        std::vector<double> x(n);
+        runner.run("realDistribution (gaussian, seeded)", n, double(n), "samples", [&] {
+            x = stats::realDistribution(stats::GAUSSIAN, int(n), 0.0, 1.0, 42);
+        });
+        runner.run("sum", n, bytes, "B", [&] { bench::doNotOptimize(stats::sum(x)); });
+        runner.run("mean", n, bytes, "B", [&] { bench::doNotOptimize(stats::mean(x)); });
+        runner.run("stdev", n, 2.0 * bytes, "B", [&] { bench::doNotOptimize(stats::stdev(x)); });
+        runner.run("Accumulator push", n, double(n), "samples", [&] {
+            stats::Accumulator acc;
+            acc.push(x.data(), n);
+            bench::doNotOptimize(acc.kurtosis());
+        });
+        runner.run("TDigest push + p99", n, double(n), "samples", [&] {
+            stats::TDigest digest;
+            digest.push(x.data(), n);
+            bench::doNotOptimize(digest.quantile(0.99));
+        });
+        runner.run("LogLinearHistogram push + p99", n, double(n), "samples", [&] {
+            stats::LogLinearHistogram histogram(1e-6, 1e6);
+            histogram.push(x.data(), n);
+            bench::doNotOptimize(histogram.quantile(0.99));
+        });
+    }
+
+    for (size_t p : runner.sizes({16, 64, 256}, {8}))
+    {
+        const size_t n = 4096;
+        Matrix<double> X(n, p);
+        rng::Philox4x32 engine(7);
+        rng::fillNormal(engine, X.rawData(), n * p);
+        runner.run("covariance (4096 x p)", p, 2.0 * double(n) * double(p) * double(p), "FLOP", [&] {
+            Matrix<double> C = stats::covariance(X);
+            bench::doNotOptimize(C.rawData());
+        });
+    }
+
+    for (size_t n : runner.sizes({1000, 100000}, {1000}))
+    {
+        std::vector<double> x = stats::realDistribution(stats::GAUSSIAN, int(n), 0.0, 1.0, 3);
+        stats::BootstrapOptions options;
+        options.replicates = 200;
+        options.jackknifeGroups = 100;
+        runner.run("bootstrap mean (200 replicates)", n, double(n) * 200.0, "samples", [&] {
+            bench::doNotOptimize(stats::bootstrap(x, stats::MeanStatistic(), options).bcaUpper);
+        });
+    }
+    return runner.finish();
+}
@@ -1,6 +1,19 @@
+#define INSTRUMENT_ENABLED 1
 #include "Matrix.h"
 #include <utility> // for std::move
 
+// Copy/move tracing through the instrumentation counters: prints them and fails if a step
+// took a different path (copy instead of move, or an unexpected extra copy).
+
+bool expect(const char *counter, const uint64_t calls) {
+    const uint64_t actual = instrument::snapshot(counter).calls;
+    if (actual != calls) {
+        std::cerr << "ERROR: " << counter << " counted " << actual << ", expected " << calls << '\n';
+        return false;
+    }
+    return true;
+}
+
 int main() {
     std::cout << "Creating A\n";
     Matrix<int> A(2, 2);
@@ -12,7 +25,7 @@ int main() {
     B = A; // copy assignment
 
     std::cout << "\nCreating C from a temporary (move)\n";
-    Matrix<int> C = Matrix<int>(2, 2); // move constructor
+    Matrix<int> C = Matrix<int>(2, 2); // elided in C++17: no copy, no move
 
     std::cout << "\nCreating D, then assigning it a temporary (move)\n";
     Matrix<int> D(2, 2);
@@ -21,6 +34,13 @@ int main() {
     std::cout << "\nMoving A into E\n";
     Matrix<int> E = std::move(A); // move constructor
 
-    std::cout << "\nDone!\n";
-    return 0;
-}
\ No newline at end of file
+    std::cout << "\nDone!\n\n";
+    instrument::report(std::cout);
+
+    bool ok = expect("Matrix copy construct", 1);
+    ok = expect("Matrix copy assignment", 1) && ok;
+    ok = expect("Matrix move construct", 1) && ok;
+    ok = expect("Matrix move assignment", 1) && ok;
+    ok = expect("Matrix allocation", 6) && ok;
+    return ok ? 0 : 1;
+}
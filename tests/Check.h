@@ -0,0 +1,97 @@
+/*
+Programmer: Connor Fricke (cd.fricke23@gmail.com)
+File: Check.h
+Latest Revision: 18-Oct-2026
+Synopsis: Header and implementation file for the assertion helpers used by the tests/ programs
+*/
+
+#ifndef CHECK_H
+#define CHECK_H
+
+    #include <cmath>
+    #include <complex>
+    #include <cstdio>
+    #include <iostream>
+    #include <string>
+
+    // DECLARATIONS
+    namespace check {
+        /*
+        Every test program calls the CHECK* macros below and returns check::status() from main(), so a
+        failed check prints its location and the values involved and makes CTest report the program.
+        */
+        int &failures();
+        int status();                               // prints a summary, 0 when every check passed
+        bool report(const bool ok, const char *expression, const char *file, const int line, const std::string &detail = "");
+        // |actual - expected| <= tolerance * max(1, |expected|)
+        bool near(const double actual, const double expected, const double tolerance);
+        bool near(const std::complex<double> &actual, const std::complex<double> &expected, const double tolerance);
+        std::string describe(const double actual, const double expected);
+        std::string describe(const std::complex<double> &actual, const std::complex<double> &expected);
+    }
+
+    #define CHECK(condition) check::report((condition), #condition, __FILE__, __LINE__)
+    #define CHECK_NEAR(actual, expected, tolerance) \
+        check::report(check::near((actual), (expected), (tolerance)), #actual " ~ " #expected, __FILE__, __LINE__, check::describe((actual), (expected)))
+    #define CHECK_THROWS(statement, exception) \
+        do { bool thrown = false; try { statement; } catch (const exception &) { thrown = true; } \
+             check::report(thrown, #statement " throws " #exception, __FILE__, __LINE__); } while (0)
+
+    // DEFINITIONS
+    namespace check {
+
+        inline int &failures()
+        {
+            static int count = 0;
+            return count;
+        }
+
+        inline int status()
+        {
+            if (failures() == 0)
+                std::cout << "all checks passed\n";
+            else
+                std::cout << failures() << " check(s) failed\n";
+            return (failures() == 0) ? 0 : 1;
+        }
+
+        inline bool report(const bool ok, const char *expression, const char *file, const int line, const std::string &detail)
+        {
+            if (!ok)
+            {
+                failures()++;
+                std::cerr << "ERROR: Check failed: " << expression << " (" << file << ":" << line << ")";
+                if (!detail.empty())
+                    std::cerr << " " << detail;
+                std::cerr << "\n";
+            }
+            return ok;
+        }
+
+        inline bool near(const double actual, const double expected, const double tolerance)
+        {
+            return std::abs(actual - expected) <= tolerance * std::max(1.0, std::abs(expected));
+        }
+
+        inline bool near(const std::complex<double> &actual, const std::complex<double> &expected, const double tolerance)
+        {
+            return std::abs(actual - expected) <= tolerance * std::max(1.0, std::abs(expected));
+        }
+
+        inline std::string describe(const double actual, const double expected)
+        {
+            char text[96];
+            std::snprintf(text, sizeof(text), "actual %.17g, expected %.17g", actual, expected);
+            return text;
+        }
+
+        inline std::string describe(const std::complex<double> &actual, const std::complex<double> &expected)
+        {
+            char text[160];
+            std::snprintf(text, sizeof(text), "actual (%.17g, %.17g), expected (%.17g, %.17g)",
+                          actual.real(), actual.imag(), expected.real(), expected.imag());
+            return text;
+        }
+    }
+
+#endif
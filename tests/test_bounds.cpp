@@ -0,0 +1,52 @@
+// this program checks the throwing policy whatever CPPLIB_BOUNDS_POLICY the build selected
+#undef BOUNDS_POLICY
+#define BOUNDS_POLICY BOUNDS_THROW
+#include "../Matrix.h"
+#include "../Vector.h"
+#include "Check.h"
+
+// Under BOUNDS_THROW, at()/set()/getRow()/getCol() throw std::out_of_range on a bad index and shape
+// mismatches throw std::invalid_argument; valid accesses still go through.
+
+int main() {
+    // INDICES
+    {
+        Matrix<double> A(3, 4);
+        A.set(2, 3, 5.0);
+        CHECK(A.at(2, 3) == 5.0);
+        CHECK(A.getRow(2).size() == 4);
+        CHECK(A.getCol(3).size() == 3);
+        CHECK_THROWS(A.at(3, 0), std::out_of_range);
+        CHECK_THROWS(A.at(0, 4), std::out_of_range);
+        CHECK_THROWS(A.set(3, 0, 1.0), std::out_of_range);
+        CHECK_THROWS(A.set(0, 4, 1.0), std::out_of_range);
+        CHECK_THROWS(A.getRow(3), std::out_of_range);
+        CHECK_THROWS(A.getCol(4), std::out_of_range);
+        CHECK(A.at(2, 3) == 5.0);
+
+        Matrix<double> empty;
+        CHECK_THROWS(empty.at(0, 0), std::out_of_range);
+
+        Vector<int> v(5);
+        v.set(4, 7);
+        CHECK(v.at(4) == 7);
+        CHECK_THROWS(v.at(5), std::out_of_range);
+        CHECK_THROWS(v.set(5, 1), std::out_of_range);
+        CHECK_THROWS(v.at(size_t(-1)), std::out_of_range);
+    }
+
+    // SHAPES
+    {
+        const Matrix<double> A(2, 3), B(3, 2), C(2, 3);
+        CHECK((A + C).rows() == 2);
+        CHECK((A * B).cols() == 2);
+        CHECK_THROWS(A + B, std::invalid_argument);
+        CHECK_THROWS(A * C, std::invalid_argument);
+        CHECK_THROWS(Matrix<int>({{1, 2, 3}, {4, 5}}), std::invalid_argument);
+        CHECK_THROWS(Matrix<int>({{1, 2}, {3, 4, 5}}), std::invalid_argument);
+        const Matrix<int> square = {{1, 2}, {3, 4}};
+        CHECK(square.at(1, 0) == 3);
+    }
+
+    return check::status();
+}
@@ -0,0 +1,203 @@
+#include "../Derivative.h"
+#include "../Integral.h"
+#include "Check.h"
+
+// Derivative.h against textbook stencil weights and analytic derivatives.
+
+using derivative::Dual;
+
+int main() {
+    // FORNBERG WEIGHTS: standard central, forward and backward stencils
+    {
+        typedef derivative::FiniteDifference<1, 2> D1;
+        CHECK(D1::points == 3);
+        CHECK_NEAR(D1::stencil.weights[0], -0.5, 1e-15);
+        CHECK_NEAR(D1::stencil.weights[1], 0.0, 1e-15);
+        CHECK_NEAR(D1::stencil.weights[2], 0.5, 1e-15);
+        CHECK(D1::stencil.offsets[0] == -1 && D1::stencil.offsets[2] == 1);
+
+        typedef derivative::FiniteDifference<1, 4> D14;
+        const double w14[5] = {1.0 / 12.0, -2.0 / 3.0, 0.0, 2.0 / 3.0, -1.0 / 12.0};
+        for (size_t k = 0; k < 5; k++)
+            CHECK_NEAR(D14::stencil.weights[k], w14[k], 1e-14);
+
+        typedef derivative::FiniteDifference<2, 2> D2;
+        CHECK_NEAR(D2::stencil.weights[0], 1.0, 1e-14);
+        CHECK_NEAR(D2::stencil.weights[1], -2.0, 1e-14);
+        CHECK_NEAR(D2::stencil.weights[2], 1.0, 1e-14);
+
+        typedef derivative::FiniteDifference<2, 4> D24;
+        const double w24[5] = {-1.0 / 12.0, 4.0 / 3.0, -5.0 / 2.0, 4.0 / 3.0, -1.0 / 12.0};
+        for (size_t k = 0; k < 5; k++)
+            CHECK_NEAR(D24::stencil.weights[k], w24[k], 1e-13);
+
+        typedef derivative::FiniteDifference<1, 2, derivative::FORWARD> F12;
+        CHECK(F12::points == 3 && F12::stencil.offsets[0] == 0);
+        CHECK_NEAR(F12::stencil.weights[0], -1.5, 1e-14);
+        CHECK_NEAR(F12::stencil.weights[1], 2.0, 1e-14);
+        CHECK_NEAR(F12::stencil.weights[2], -0.5, 1e-14);
+
+        typedef derivative::FiniteDifference<1, 1, derivative::BACKWARD> B11;
+        CHECK(B11::stencil.offsets[0] == -1);
+        CHECK_NEAR(B11::stencil.weights[0], -1.0, 1e-15);
+        CHECK_NEAR(B11::stencil.weights[1], 1.0, 1e-15);
+    }
+
+    // DIFFERENTIATE: a 4th order accurate first derivative is exact on quartics, ends included
+    {
+        const size_t n = 50000;
+        const double h = 0.001;
+        std::vector<double> f(n), expected(n);
+        for (size_t i = 0; i < n; i++)
+        {
+            const double x = double(i) * h - 20.0;
+            f[i] = 0.25 * x * x * x * x - x * x + 3.0;
+            expected[i] = x * x * x - 2.0 * x;
+        }
+        const std::vector<double> df = derivative::differentiate<1, 4>(f, h);
+        double error = 0.0;
+        for (size_t i = 0; i < n; i++)
+            error = std::max(error, std::abs(df[i] - expected[i]) / std::max(1.0, std::abs(expected[i])));
+        CHECK(error < 1e-6);
+
+        // non-uniform grid: second derivative of a quadratic
+        std::vector<double> x(40), g(40);
+        for (size_t i = 0; i < x.size(); i++)
+        {
+            x[i] = double(i) + 0.3 * std::sin(double(i));
+            g[i] = 3.0 * x[i] * x[i] - x[i];
+        }
+        const std::vector<double> d2 = derivative::differentiate<2, 2>(g, x);
+        double error2 = 0.0;
+        for (double v : d2)
+            error2 = std::max(error2, std::abs(v - 6.0));
+        CHECK(error2 < 1e-8);
+    }
+
+    // GRADIENT: exact derivatives of the Rosenbrock function in 10 dimensions
+    {
+        const size_t n = 10;
+        std::vector<double> x(n);
+        for (size_t i = 0; i < n; i++)
+            x[i] = 0.1 * double(i) - 0.3;
+        auto rosenbrock = [](const auto &v) {
+            typedef typename std::decay<decltype(v[0])>::type T;
+            T total = T(0.0);
+            for (size_t i = 0; i + 1 < v.size(); i++)
+                total += 100.0 * (v[i + 1] - v[i] * v[i]) * (v[i + 1] - v[i] * v[i]) + (1.0 - v[i]) * (1.0 - v[i]);
+            return total;
+        };
+        std::vector<double> expected(n, 0.0);
+        for (size_t i = 0; i + 1 < n; i++)
+        {
+            expected[i] += -400.0 * x[i] * (x[i + 1] - x[i] * x[i]) - 2.0 * (1.0 - x[i]);
+            expected[i + 1] += 200.0 * (x[i + 1] - x[i] * x[i]);
+        }
+        const std::vector<double> g4 = derivative::gradient<4>(rosenbrock, x);
+        const std::vector<double> g8 = derivative::gradient<8>(rosenbrock, x);
+        for (size_t i = 0; i < n; i++)
+        {
+            CHECK_NEAR(g4[i], expected[i], 1e-12);
+            CHECK_NEAR(g8[i], expected[i], 1e-12);
+        }
+    }
+
+    // DUAL NUMBERS: chain rule through the elementary functions, and exact parameter derivatives of integrals
+    {
+        typedef Dual<double, 2> D;
+        const D x(2.0, 0), y(0.5, 1);
+        using std::exp;
+        using std::log;
+        using std::sqrt;
+        using std::sin;
+        const D f = exp(x) * log(x) + sqrt(x) * sin(y) / y;
+        CHECK_NEAR(f.value, std::exp(2.0) * std::log(2.0) + std::sqrt(2.0) * std::sin(0.5) / 0.5, 1e-15);
+        CHECK_NEAR(f.derivative(0), std::exp(2.0) * std::log(2.0) + std::exp(2.0) / 2.0 + 0.5 / std::sqrt(2.0) * std::sin(0.5) / 0.5, 1e-14);
+        CHECK_NEAR(f.derivative(1), std::sqrt(2.0) * (std::cos(0.5) * 0.5 - std::sin(0.5)) / 0.25, 1e-14);
+        CHECK(x > y && !(x < y));
+
+        // d/dp of the integral of exp(p t) over [0, 1] at p = 1 is the integral of t exp(t), which is 1
+        const Dual<double, 1> p(1.0, 0);
+        const Dual<double, 1> I = integral::simpsons([p](double t) { return exp(p * t); }, 0.0, 1.0, 1001);
+        CHECK_NEAR(I.value, std::exp(1.0) - 1.0, 1e-12);
+        CHECK_NEAR(I.derivative(), 1.0, 1e-12);
+        const double plain = integral::simpsons([](double t) { return t * t; }, 0.0, 1.0, 11);
+        CHECK_NEAR(plain, 1.0 / 3.0, 1e-15);
+    }
+
+    // JACOBIANS: dual numbers exactly, finite differences closely, sparse equal to dense on the pattern
+    {
+        const size_t n = 30;
+        std::vector<double> x(n);
+        for (size_t i = 0; i < n; i++)
+            x[i] = 0.5 + 0.05 * double(i);
+        // tridiagonal system: f_i = x_{i-1} x_i + sin(x_i) - x_{i+1}^2
+        auto system = [n](const auto &v) {
+            typedef typename std::decay<decltype(v[0])>::type T;
+            using std::sin;
+            std::vector<T> f(n);
+            for (size_t i = 0; i < n; i++)
+            {
+                T fi = sin(v[i]);
+                if (i > 0)
+                    fi += v[i - 1] * v[i];
+                if (i + 1 < n)
+                    fi -= v[i + 1] * v[i + 1];
+                f[i] = fi;
+            }
+            return f;
+        };
+        Matrix<double> expected(n, n);
+        std::vector<std::pair<size_t, size_t>> entries;
+        for (size_t i = 0; i < n; i++)
+        {
+            expected.rowData(i)[i] = std::cos(x[i]) + ((i > 0) ? x[i - 1] : 0.0);
+            entries.push_back({i, i});
+            if (i > 0)
+            {
+                expected.rowData(i)[i - 1] = x[i];
+                entries.push_back({i, i - 1});
+            }
+            if (i + 1 < n)
+            {
+                expected.rowData(i)[i + 1] = -2.0 * x[i + 1];
+                entries.push_back({i, i + 1});
+            }
+        }
+        const derivative::SparsityPattern pattern(n, n, entries);
+
+        const Matrix<double> dual = derivative::jacobianDual<8>(system, x);
+        const Matrix<double> dense = derivative::jacobian([&](const std::vector<double> &v) { return system(v); }, x);
+        const derivative::SparseMatrix<double> sparse = derivative::jacobian([&](const std::vector<double> &v) { return system(v); }, x, pattern);
+        const derivative::SparseMatrix<double> sparseDual = derivative::jacobianDual<4>(system, x, pattern);
+        double errorDual = 0.0, errorDense = 0.0, errorSparse = 0.0, errorSparseDual = 0.0;
+        for (size_t i = 0; i < n; i++)
+            for (size_t j = 0; j < n; j++)
+            {
+                errorDual = std::max(errorDual, std::abs(dual.rowData(i)[j] - expected.rowData(i)[j]));
+                errorDense = std::max(errorDense, std::abs(dense.rowData(i)[j] - expected.rowData(i)[j]));
+            }
+        for (size_t i = 0; i < n; i++)
+            for (size_t s = pattern.rowStart[i]; s < pattern.rowStart[i + 1]; s++)
+            {
+                const size_t j = pattern.columns[s];
+                errorSparse = std::max(errorSparse, std::abs(sparse.values[s] - dense.rowData(i)[j]));
+                errorSparseDual = std::max(errorSparseDual, std::abs(sparseDual.values[s] - dual.rowData(i)[j]));
+            }
+        CHECK(errorDual < 1e-14);
+        CHECK(errorDense < 1e-8);
+        CHECK(errorSparse < 1e-8);
+        CHECK(errorSparseDual == 0.0);
+        CHECK(sparse.values.size() == 3 * n - 2);
+
+        // a function whose output does not match the pattern is reported, not read out of bounds
+        const derivative::SparsityPattern tooTall(n + 2, n, entries);
+        const derivative::SparseMatrix<double> rejected = derivative::jacobian([&](const std::vector<double> &v) { return system(v); }, x, tooTall);
+        double rejectedMax = 0.0;
+        for (double v : rejected.values)
+            rejectedMax = std::max(rejectedMax, std::abs(v));
+        CHECK(rejectedMax == 0.0);
+    }
+
+    return check::status();
+}
@@ -0,0 +1,129 @@
+#include "../Stats.h"
+#include "../Integral.h"
+#include "Check.h"
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+// Every threaded routine documents results that depend only on the input and seed, never on the pool size.
+// With --emit this program prints the bit patterns of those results; without arguments it runs itself under
+// CPPLIB_THREADS=1, 2 and 7 and requires the three outputs to be identical.
+
+namespace {
+    void emit(const char *name, const double value)
+    {
+        uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        std::printf("%s %016" PRIx64 "\n", name, bits);
+    }
+
+    void emit(const char *name, const double *values, const size_t n)
+    {
+        // fold the bit patterns so a single flipped bit anywhere changes the line
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (size_t i = 0; i < n; i++)
+        {
+            uint64_t bits;
+            std::memcpy(&bits, values + i, sizeof(bits));
+            hash = (hash ^ bits) * 0x100000001b3ull;
+        }
+        std::printf("%s %016" PRIx64 "\n", name, hash);
+    }
+
+    int emitAll()
+    {
+        std::printf("threads %zu\n", ThreadPool::global().size());
+        const size_t n = 1000003;
+        std::vector<double> data(n), other(n);
+        rng::parallelFillNormal(data.data(), n, 1.0, 3.0, 11);
+        rng::parallelFillUniform(other.data(), n, -1.0, 1.0, 12);
+        emit("parallelFillNormal", data.data(), n);
+        emit("parallelFillUniform", other.data(), n);
+        std::vector<float> single(n);
+        rng::parallelFillNormal(single.data(), n, 0.0, 1.0, 13);
+        std::vector<double> widened(single.begin(), single.end());
+        emit("parallelFillNormal<float>", widened.data(), n);
+
+        emit("sum", stats::sum(data));
+        emit("mean", stats::mean(data));
+        emit("variance", stats::variance(data));
+        emit("dot", stats::dot(data, other));
+        emit("min", stats::min(data));
+        emit("max", stats::max(data));
+
+        integral::MonteCarloOptions options;
+        options.seed = 99;
+        for (integral::SamplingMethod method : {integral::PSEUDO_RANDOM, integral::ANTITHETIC, integral::STRATIFIED, integral::SOBOL, integral::HALTON})
+        {
+            options.method = method;
+            const integral::MonteCarloResult r = integral::monteCarlo([](const double *x) { return std::exp(-x[0] * x[1]) * std::cos(x[2]); },
+                                                                      {0.0, 0.0, 0.0}, {1.0, 2.0, 3.0}, 300000, options);
+            const std::string name = "monteCarlo" + std::to_string(int(method));
+            emit(name.c_str(), r.value);
+            emit((name + ".stdError").c_str(), r.stdError);
+        }
+
+        std::vector<double> sample(data.begin(), data.begin() + 5000);
+        stats::BootstrapOptions bootOptions;
+        bootOptions.replicates = 4000;
+        const stats::BootstrapResult boot = stats::bootstrap(sample, stats::StdevStatistic(), bootOptions);
+        emit("bootstrap", boot.replicates.data(), boot.replicates.size());
+        emit("bootstrap.bca", boot.bcaLower);
+        const stats::JackknifeResult jack = stats::jackknife(sample, stats::StdevStatistic());
+        emit("jackknife", jack.replicates.data(), jack.replicates.size());
+
+        const size_t rows = 3000, p = 40;
+        Matrix<double> X(rows, p);
+        std::copy(data.begin(), data.begin() + rows * p, X.rawData());
+        for (size_t i = 0; i < rows; i += 17)
+            X.rowData(i)[i % p] = std::numeric_limits<double>::quiet_NaN();
+        const Matrix<double> C = stats::covariance(X);
+        emit("covariance", C.rawData(), p * p);
+        const Matrix<double> P = stats::pairwiseCorrelation(X);
+        emit("pairwiseCorrelation", P.rawData(), p * p);
+        stats::CovarianceAccumulator accumulator(p);
+        accumulator.push(X);
+        const Matrix<double> A = accumulator.covariance();
+        emit("CovarianceAccumulator", A.rawData(), p * p);
+        return 0;
+    }
+
+    std::string run(const std::string &self, const int threads)
+    {
+        const std::string command = "CPPLIB_THREADS=" + std::to_string(threads) + " \"" + self + "\" --emit";
+        std::string output;
+        FILE *pipe = popen(command.c_str(), "r");
+        if (pipe == nullptr)
+            return output;
+        char buffer[256];
+        while (std::fgets(buffer, sizeof(buffer), pipe) != nullptr)
+            output += buffer;
+        if (pclose(pipe) != 0)
+            output += "exit status nonzero\n";
+        return output;
+    }
+
+    // drop the first line, which names the pool size
+    std::string results(const std::string &output)
+    {
+        const size_t newline = output.find('\n');
+        return (newline == std::string::npos) ? std::string() : output.substr(newline + 1);
+    }
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && std::strcmp(argv[1], "--emit") == 0)
+        return emitAll();
+
+    const std::string one = run(argv[0], 1), two = run(argv[0], 2), seven = run(argv[0], 7);
+    CHECK(one.compare(0, 10, "threads 1\n") == 0);
+    CHECK(two.compare(0, 10, "threads 2\n") == 0);
+    CHECK(seven.compare(0, 10, "threads 7\n") == 0);
+    CHECK(!results(one).empty());
+    CHECK(results(one) == results(two));
+    CHECK(results(one) == results(seven));
+    if (results(one) != results(seven))
+        std::cerr << "1 thread:\n" << one << "7 threads:\n" << seven;
+    return check::status();
+}
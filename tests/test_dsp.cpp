@@ -0,0 +1,310 @@
+#include "../DSP.h"
+#include "Check.h"
+
+using dsp::dcomp;
+
+// DSP.h against closed forms and direct reference computations.
+
+std::vector<double> testSignal(const size_t n) {
+    std::vector<double> x(n);
+    for (size_t i = 0; i < n; i++)
+        x[i] = std::sin(0.37 * double(i)) + 0.5 * std::cos(2.1 * double(i) * double(i) / double(n)) + 0.1 * double(i % 7);
+    return x;
+}
+
+int main() {
+    // POLYPHASE RESAMPLER: a band-limited sine comes out at the new rate, delayed by delay()
+    const int ratios[3][2] = {{3, 2}, {2, 3}, {147, 160}};
+    for (const int *ratio : ratios)
+    {
+        const int L = ratio[0], M = ratio[1];
+        const size_t n = 4000;
+        const double f = 0.03;     // cycles per input sample, well inside both Nyquist rates
+        std::vector<double> x(n);
+        for (size_t i = 0; i < n; i++)
+            x[i] = std::sin(2.0 * dsp::PI * f * double(i));
+        dsp::PolyphaseResampler whole(L, M);
+        const std::vector<double> y = whole.process(x);
+        CHECK(y.size() == (n * L + M - 1) / M);
+        double error = 0.0;
+        for (size_t j = 200; j + 200 < y.size(); j++)
+        {
+            const double t = (double(j) - whole.delay()) * double(M) / double(L);
+            error = std::max(error, std::abs(y[j] - std::sin(2.0 * dsp::PI * f * t)));
+        }
+        CHECK(error < 1e-3);
+
+        // feeding the signal in uneven blocks gives exactly the one-shot output
+        dsp::PolyphaseResampler blocks(L, M);
+        std::vector<double> z;
+        for (size_t first = 0, step = 1; first < n; first += step, step = step * 3 % 509 + 1)
+            blocks.process(x.data() + first, std::min(step, n - first), z);
+        CHECK(z == y);
+        CHECK(dsp::resample(x, L, M) == y);
+    }
+
+    // MULTISTAGE DECIMATOR: small stages whose product is the factor, unit gain at DC, blockwise == one-shot
+    {
+        dsp::MultistageDecimator decimator(96);
+        int product = 1;
+        for (int f : decimator.factors())
+        {
+            CHECK(f >= 2 && f <= 8);
+            product *= f;
+        }
+        CHECK(product == 96);
+
+        const std::vector<double> dc(96 * 200, 1.5);
+        const std::vector<double> y = decimator.process(dc);
+        CHECK(y.size() == 200);
+        CHECK_NEAR(y.back(), 1.5, 1e-6);
+
+        const std::vector<double> x = testSignal(96 * 50 + 17);
+        dsp::MultistageDecimator once(96), pieces(96);
+        const std::vector<double> expected = once.process(x);
+        std::vector<double> got;
+        for (size_t first = 0; first < x.size(); first += 1000)
+            pieces.process(x.data() + first, std::min<size_t>(1000, x.size() - first), got);
+        CHECK(got == expected);
+    }
+
+    // FFT AGAINST DFT: power-of-two lengths take the radix-2 path, the others Bluestein
+    for (size_t n : {1, 2, 8, 64, 1024, 3, 5, 12, 100, 257, 1000})
+    {
+        const std::vector<double> x = testSignal(n);
+        std::vector<int> k_range(n);
+        for (size_t k = 0; k < n; k++)
+            k_range[k] = int(k);
+        const std::vector<dcomp> reference = dsp::DFT(x, k_range);
+        const std::vector<dcomp> X = dsp::FFT(x);
+        double error = 0.0, scale = 1.0;
+        for (size_t k = 0; k < n; k++)
+        {
+            error = std::max(error, std::abs(X[k] - reference[k]));
+            scale = std::max(scale, std::abs(reference[k]));
+        }
+        CHECK(error / scale < 1e-11);
+
+        // inverse transform returns the input
+        const std::vector<dcomp> back = dsp::IFFT(X);
+        double roundTrip = 0.0;
+        for (size_t i = 0; i < n; i++)
+            roundTrip = std::max(roundTrip, std::abs(back[i] - dcomp(x[i], 0.0)));
+        CHECK(roundTrip < 1e-12 * scale);
+
+        // float plans agree with the double transform to single precision
+        const std::vector<float> xf(x.begin(), x.end());
+        const std::vector<std::complex<float>> XF = dsp::FFT(xf);
+        double errorF = 0.0;
+        for (size_t k = 0; k < n; k++)
+            errorF = std::max(errorF, std::abs(dcomp(XF[k]) - reference[k]));
+        CHECK(errorF / scale < 2e-6);
+    }
+
+    // STFT: forward then inverse reconstructs the signal (Hann window, 75% overlap, centered frames)
+    for (size_t n : {5000, 4096, 777})
+    {
+        dsp::STFTConfig config;
+        config.windowLength = 256;
+        config.hop = 64;
+        const dsp::STFT stft(config);
+        const std::vector<double> x = testSignal(n);
+        const Matrix<dcomp> S = stft.forward(x);
+        CHECK(S.rows() == stft.frames(n));
+        CHECK(S.cols() == stft.bins());
+        const std::vector<double> y = stft.inverse(S, n);
+        double error = 0.0;
+        for (size_t i = 0; i < n; i++)
+            error = std::max(error, std::abs(y[i] - x[i]));
+        CHECK(error < 1e-10);
+    }
+
+    // WELCH: white noise of variance s^2 has a flat two-sided density s^2 / fs
+    {
+        const size_t n = 1 << 18;
+        std::vector<double> x(n);
+        std::mt19937_64 engine(11);
+        std::normal_distribution<double> normal(0.0, 2.0);
+        for (double &v : x)
+            v = normal(engine);
+        for (dsp::Averaging averaging : {dsp::MEAN_AVERAGE, dsp::MEDIAN_AVERAGE})
+        {
+            dsp::WelchConfig config;
+            config.segmentLength = 256;
+            config.overlap = 128;
+            config.onesided = false;
+            config.samplingRate = 10.0;
+            config.averaging = averaging;
+            const std::vector<double> P = dsp::welch(x, config);
+            double level = 0.0;
+            for (double p : P)
+                level += p;
+            level /= double(P.size());
+            CHECK_NEAR(level, 4.0 / 10.0, 0.03);
+
+            // streaming the same samples in uneven blocks gives the one-shot estimate
+            dsp::WelchEstimator stream(config);
+            for (size_t first = 0, step = 1; first < n; first += step, step = step * 7 % 3001 + 1)
+                stream.push(x.data() + first, std::min(step, n - first));
+            CHECK(stream.segments() == (n - 256) / 128 + 1);
+            const std::vector<double> Q = stream.psd();
+            double error = 0.0;
+            for (size_t k = 0; k < P.size(); k++)
+                error = std::max(error, std::abs(Q[k] - P[k]));
+            CHECK(error < 1e-12);
+
+            // merged shards count every segment of both
+            dsp::WelchEstimator first(config), second(config);
+            first.push(x.data(), n / 2);
+            second.push(x.data() + n / 2, n / 2);
+            first.merge(second);
+            CHECK(first.segments() == 2 * ((n / 2 - 256) / 128 + 1));
+
+            // merging an estimator into itself is the same as merging a copy of it
+            dsp::WelchEstimator self = second, copy = second;
+            self.merge(self);
+            copy.merge(second);
+            CHECK(self.segments() == 2 * second.segments());
+            CHECK(self.psd() == copy.psd());
+        }
+
+        // a bounded median window equals the median of just the newest segments
+        dsp::WelchConfig config;
+        config.segmentLength = 256;
+        config.overlap = 128;
+        config.averaging = dsp::MEDIAN_AVERAGE;
+        config.medianSegments = 16;
+        dsp::WelchEstimator windowed(config);
+        windowed.push(x.data(), n);
+        const size_t tail = ((n - 256) / 128 + 1 - 16) * 128;
+        const std::vector<double> expected = dsp::welch(std::vector<double>(x.begin() + tail, x.begin() + tail + 15 * 128 + 256), config);
+        const std::vector<double> got = windowed.psd();
+        double error = 0.0;
+        for (size_t k = 0; k < got.size(); k++)
+            error = std::max(error, std::abs(got[k] - expected[k]));
+        CHECK(error < 1e-12);
+    }
+
+    // MULTICHANNEL BUFFERS: both layouts hold the same samples and every kernel matches the single channel version
+    {
+        const size_t channels = 5, n = 1001;
+        std::vector<std::vector<double>> signals(channels);
+        for (size_t c = 0; c < channels; c++)
+        {
+            signals[c] = testSignal(n);
+            for (double &v : signals[c])
+                v *= double(c + 1);
+        }
+        for (dsp::ChannelLayout layout : {dsp::PLANAR, dsp::INTERLEAVED})
+        {
+            dsp::MultiChannelBuffer B(channels, n, layout);
+            for (size_t c = 0; c < channels; c++)
+                B.setChannel(c, signals[c]);
+            const dsp::MultiChannelBuffer other = B.toLayout((layout == dsp::PLANAR) ? dsp::INTERLEAVED : dsp::PLANAR);
+            bool same = true, aligned = true;
+            for (size_t c = 0; c < channels; c++)
+            {
+                same = same && (B.getChannel(c) == signals[c]) && (other.getChannel(c) == signals[c]);
+                same = same && (B.channel(c)[n - 1] == signals[c][n - 1]) && (B(c, 17) == signals[c][17]);
+                if (layout == dsp::PLANAR)
+                    aligned = aligned && (reinterpret_cast<uintptr_t>(B.channel(c).ptr) % 64 == 0) && B.channel(c).contiguous();
+            }
+            CHECK(same);
+            CHECK(aligned);
+            CHECK(B.channel(0).stride == ((layout == dsp::PLANAR) ? 1 : channels));
+
+            const dsp::MultiChannelBuffer fir = dsp::lowpassFIR(B, 0.3), iir = dsp::movingAvgIIR(B, 0.3);
+            const dsp::MultiChannelBuffer down = dsp::decimateSignal(B, 3), re = dsp::resample(B, 3, 2);
+            const std::vector<dcomp> bins = dsp::goertzelIIR(B, 17);
+            CHECK(fir.layout() == layout && re.layout() == layout);
+            for (size_t c = 0; c < channels; c++)
+            {
+                CHECK(fir.getChannel(c) == dsp::lowpassFIR(signals[c], 0.3));
+                CHECK(iir.getChannel(c) == dsp::movingAvgIIR(signals[c], 0.3));
+                CHECK(down.getChannel(c) == dsp::decimateSignal(signals[c], 3));
+                CHECK(re.getChannel(c) == dsp::resample(signals[c], 3, 2));
+                CHECK_NEAR(bins[c], dsp::goertzelIIR(signals[c], 17), 1e-12);
+            }
+        }
+    }
+
+    // LEGACY DOUBLE OVERLOADS: braced lists still resolve, and give the textbook results
+    {
+        const std::vector<double> fir = dsp::lowpassFIR({1.0, 2.0, 3.0}, 0.5);
+        const std::vector<double> iir = dsp::movingAvgIIR({1.0, 2.0, 3.0}, 0.5);
+        const dcomp bin = dsp::goertzelIIR({1.0, 0.0, -1.0, 0.0}, 1);
+        CHECK(fir.size() == 3 && fir[0] == 0.5 && fir[1] == 1.5 && fir[2] == 2.5);
+        CHECK(iir.size() == 3 && iir[0] == 0.5 && iir[1] == 1.25 && iir[2] == 2.125);
+        CHECK_NEAR(bin, dcomp(2.0, 0.0), 1e-12);
+    }
+
+    // GOERTZEL: one bin of the DFT
+    {
+        const std::vector<double> x = testSignal(300);
+        const std::vector<dcomp> reference = dsp::DFT(x, {0, 1, 17, 150, 299});
+        const int bins[] = {0, 1, 17, 150, 299};
+        for (int b = 0; b < 5; b++)
+            CHECK_NEAR(dsp::goertzelIIR(x, bins[b]), reference[b], 1e-9);
+    }
+
+    // FLOAT32 KERNELS AGAINST THE DOUBLE REFERENCE (the AVX2 paths when the CPU has them)
+    {
+        const std::vector<double> x = testSignal(1003);
+        const std::vector<float> xf(x.begin(), x.end());
+        for (double alpha : {0.1, 0.5, 0.95})
+        {
+            const std::vector<double> fir = dsp::lowpassFIR(x, alpha), iir = dsp::movingAvgIIR(x, alpha);
+            const std::vector<float> firF = dsp::lowpassFIR(xf, alpha), iirF = dsp::movingAvgIIR(xf, alpha);
+            double errorFIR = 0.0, errorIIR = 0.0;
+            for (size_t i = 0; i < x.size(); i++)
+            {
+                errorFIR = std::max(errorFIR, std::abs(double(firF[i]) - fir[i]));
+                errorIIR = std::max(errorIIR, std::abs(double(iirF[i]) - iir[i]));
+            }
+            CHECK(errorFIR < 1e-5);
+            CHECK(errorIIR < 1e-5);
+        }
+        for (int k : {0, 3, 500, 1002, -4})
+        {
+            const dcomp reference = dsp::goertzelIIR(x, k);
+            const std::complex<float> bin = dsp::goertzelIIR(xf, k);
+            CHECK(std::abs(dcomp(bin) - reference) < 1e-5 * std::max(1.0, std::abs(reference)) + 1e-4);
+        }
+        // short inputs take the scalar float path on every CPU and agree just as closely
+        const std::vector<float> shortF(xf.begin(), xf.begin() + 7);
+        const std::vector<double> shortD(shortF.begin(), shortF.end());
+        for (int k : {0, 2, 6})
+            CHECK_NEAR(dcomp(dsp::goertzelIIR(shortF, k)), dsp::goertzelIIR(shortD, k), 1e-6);
+    }
+
+    // Q15: saturating conversion, and a fixed-point FIR within quantization error of the double filter
+    {
+        CHECK(dsp::q15(0.5).value == 16384);
+        CHECK(dsp::q15(2.0).value == 32767);
+        CHECK(dsp::q15(-2.0).value == -32768);
+        const std::vector<double> taps = dsp::designLowpass(31, 0.1);
+        std::vector<double> x = testSignal(2000);
+        for (double &v : x)
+            v *= 0.4;
+        std::vector<dsp::q15> xq(x.size());
+        std::vector<float> xf(x.size());
+        for (size_t i = 0; i < x.size(); i++)
+        {
+            xq[i] = dsp::q15(x[i]);
+            xf[i] = float(x[i]);
+        }
+        const std::vector<double> y = dsp::firFilter(x, taps);
+        const std::vector<dsp::q15> yq = dsp::firFilter(xq, taps);
+        const std::vector<float> yf = dsp::firFilter(xf, taps);
+        double errorQ = 0.0, errorF = 0.0;
+        for (size_t i = 0; i < y.size(); i++)
+        {
+            errorQ = std::max(errorQ, std::abs(yq[i].toDouble() - y[i]));
+            errorF = std::max(errorF, std::abs(double(yf[i]) - y[i]));
+        }
+        CHECK(errorQ < 2e-3);
+        CHECK(errorF < 1e-5);
+    }
+
+    return check::status();
+}
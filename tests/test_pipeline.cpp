@@ -0,0 +1,180 @@
+#include "../Pipeline.h"
+#include "Check.h"
+#include <stdexcept>
+
+// Streaming pipelines produce exactly what the offline kernels produce on the whole signal, in both
+// the fused and the threaded mode, and account for every sample in their counters.
+
+// passes samples through and throws once it has seen `limit` of them
+class FailingStage : public dsp::PipelineStage
+{
+    size_t seen = 0, limit;
+
+public:
+    explicit FailingStage(const size_t limit) : limit(limit) {}
+    void process(const double *in, const size_t n, dsp::BlockWriter &out) override
+    {
+        seen += n;
+        if (seen > limit)
+            throw std::runtime_error("stage failed");
+        out.push(in, n);
+    }
+};
+
+int main() {
+    const size_t n = 100003;
+    std::vector<double> x(n);
+    for (size_t i = 0; i < n; i++)
+        x[i] = std::sin(0.01 * double(i)) + 0.25 * std::sin(0.7 * double(i)) + 0.1 * double(i % 5);
+
+    // offline reference: FIR -> 3/2 resampler -> decimate by 4 -> IIR
+    const std::vector<double> reference = dsp::movingAvgIIR(dsp::MultistageDecimator(4).process(
+        dsp::resample(dsp::lowpassFIR(x, 0.4), 3, 2)), 0.2);
+
+    for (dsp::Pipeline::Mode mode : {dsp::Pipeline::FUSED, dsp::Pipeline::THREADED})
+    {
+        dsp::BufferSource source(x.data(), n, 999);
+        dsp::FIRStage fir(0.4);
+        dsp::ResampleStage resample(3, 2);
+        dsp::DecimateStage decimate(4);
+        dsp::IIRStage iir(0.2);
+        std::vector<double> y;
+        dsp::Pipeline pipeline(256, 4);
+        pipeline.setSource(source);
+        pipeline.addStage(fir);
+        pipeline.addStage(resample);
+        pipeline.addStage(decimate);
+        pipeline.addStage(iir);
+        pipeline.setSink([&y](const double *samples, size_t count) { y.insert(y.end(), samples, samples + count); });
+        pipeline.run(mode);
+
+        CHECK(y == reference);
+        CHECK(pipeline.size() == 5);
+        CHECK(pipeline.stats(0).samplesOut == n);
+        CHECK(pipeline.stats(1).samplesIn == n);
+        CHECK(pipeline.stats(4).samplesOut == y.size());
+        for (size_t e = 1; e + 1 < pipeline.size(); e++)
+            CHECK(pipeline.stats(e).samplesOut == pipeline.stats(e + 1).samplesIn);
+    }
+
+    // GOERTZEL STAGE: one magnitude per frame, equal to goertzelIIR on that frame
+    {
+        const size_t frame = 200;
+        dsp::BufferSource source(x.data(), 10 * frame + 37, 128);
+        dsp::GoertzelStage goertzel(7, frame);
+        std::vector<double> y;
+        dsp::Pipeline pipeline(64);
+        pipeline.setSource(source);
+        pipeline.addStage(goertzel);
+        pipeline.setSink([&y](const double *samples, size_t count) { y.insert(y.end(), samples, samples + count); });
+        pipeline.run(dsp::Pipeline::THREADED);
+        CHECK(y.size() == 10);
+        for (size_t f = 0; f < y.size(); f++)
+        {
+            const std::vector<double> part(x.begin() + f * frame, x.begin() + (f + 1) * frame);
+            CHECK_NEAR(y[f], std::abs(dsp::goertzelIIR(part, 7)), 1e-9);
+        }
+    }
+
+    // stop() from the sink ends an unbounded source, and the pipeline still drains
+    {
+        dsp::SignalSource source({{1.0, 50.0, 0.0}}, 1000.0, 0, 100);
+        dsp::FIRStage fir(0.5);
+        size_t received = 0;
+        dsp::Pipeline pipeline(100);
+        pipeline.setSource(source);
+        pipeline.addStage(fir);
+        pipeline.setSink([&](const double *, size_t count) {
+            received += count;
+            if (received >= 5000)
+                pipeline.stop();
+        });
+        pipeline.run(dsp::Pipeline::THREADED);
+        CHECK(received >= 5000);
+        CHECK(pipeline.stats(1).samplesIn == pipeline.stats(0).samplesOut);
+    }
+
+    // EXCEPTIONS: a throw from a stage, the source or the sink stops the stream and reaches the caller
+    for (dsp::Pipeline::Mode mode : {dsp::Pipeline::FUSED, dsp::Pipeline::THREADED})
+    {
+        dsp::SignalSource endless({{1.0, 50.0, 0.0}}, 1000.0, 0, 100);
+        FailingStage failing(5000);
+        dsp::FIRStage before(0.5), after(0.5);
+        dsp::Pipeline pipeline(64, 2);
+        pipeline.setSource(endless);
+        pipeline.addStage(before);
+        pipeline.addStage(failing);
+        pipeline.addStage(after);
+        CHECK_THROWS(pipeline.run(mode), std::runtime_error);
+
+        // a throwing sink stops the stream the same way
+        dsp::BufferSource source(x.data(), 1000, 100);
+        dsp::Pipeline again(64, 2);
+        size_t received = 0;
+        again.setSource(source);
+        again.addStage(before);
+        again.setSink([&](const double *, size_t count) {
+            received += count;
+            if (received > 500)
+                throw std::runtime_error("sink failed");
+        });
+        CHECK_THROWS(again.run(mode), std::runtime_error);
+    }
+    {
+        class FailingSource : public dsp::SourceStage
+        {
+            int blocks = 0;
+
+        public:
+            bool generate(dsp::BlockWriter &out) override
+            {
+                if (++blocks > 20)
+                    throw std::runtime_error("source failed");
+                for (int i = 0; i < 50; i++)
+                    out.push(double(i));
+                return true;
+            }
+        } source;
+        dsp::FIRStage fir(0.5);
+        size_t received = 0;
+        dsp::Pipeline pipeline(32, 2);
+        pipeline.setSource(source);
+        pipeline.addStage(fir);
+        pipeline.setSink([&](const double *, size_t count) { received += count; });
+        CHECK_THROWS(pipeline.run(dsp::Pipeline::THREADED), std::runtime_error);
+        CHECK(received > 0);
+    }
+
+#ifdef __linux__
+    // PINNING: the calling thread gets its affinity back after a pinned run, also when the run throws
+    {
+        cpu_set_t before, after;
+        CHECK(pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &before) == 0);
+        int cpu = 0;
+        while (!CPU_ISSET(cpu, &before))
+            cpu++;
+        for (dsp::Pipeline::Mode mode : {dsp::Pipeline::FUSED, dsp::Pipeline::THREADED})
+        {
+            dsp::BufferSource source(x.data(), 5000, 100);
+            dsp::FIRStage fir(0.5);
+            dsp::Pipeline pipeline(64);
+            pipeline.setSource(source);
+            pipeline.addStage(fir);
+            pipeline.run(mode, {cpu});
+            CHECK(pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &after) == 0);
+            CHECK(CPU_EQUAL(&before, &after));
+
+            dsp::BufferSource restart(x.data(), 5000, 100);
+            FailingStage failing(1000);
+            dsp::Pipeline throwing(64);
+            throwing.setSource(restart);
+            throwing.addStage(failing);
+            CHECK_THROWS(throwing.run(mode, {cpu}), std::runtime_error);
+            CHECK(pthread_getaffinity_np(pthread_self(), sizeof(cpu_set_t), &after) == 0);
+            CHECK(CPU_EQUAL(&before, &after));
+        }
+    }
+#endif
+
+    return check::status();
+}
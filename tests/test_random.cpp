@@ -0,0 +1,169 @@
+#include "../Random.h"
+#include "Check.h"
+
+// Known-answer vectors for Philox4x32-10 (Random123 kat_vectors) and basic properties of the
+// engines, samplers and quasi-random sequences.
+
+int main() {
+    // PHILOX4X32-10 KNOWN ANSWERS
+    {
+        const uint32_t keys[3][2] = {{0x00000000u, 0x00000000u}, {0xffffffffu, 0xffffffffu}, {0xa4093822u, 0x299f31d0u}};
+        const uint32_t counters[3][4] = {{0x00000000u, 0x00000000u, 0x00000000u, 0x00000000u},
+                                         {0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu},
+                                         {0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u}};
+        const uint32_t expected[3][4] = {{0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u},
+                                         {0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu},
+                                         {0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u}};
+        for (int t = 0; t < 3; t++)
+        {
+            uint32_t out[4];
+            rng::Philox4x32::block(keys[t], counters[t], out);
+            for (int w = 0; w < 4; w++)
+                CHECK(out[w] == expected[t][w]);
+        }
+    }
+
+    // PHILOX STREAMS: seek() and discard() land on the same outputs as drawing
+    {
+        rng::Philox4x32 a(123, 7), b(123, 7), c(123, 7), other(123, 8);
+        std::vector<uint64_t> drawn(100);
+        for (uint64_t &v : drawn)
+            v = a();
+        b.seek(37);
+        CHECK(b() == drawn[37]);
+        c.discard(90);
+        CHECK(c() == drawn[90]);
+        CHECK(other() != drawn[0]);
+    }
+
+    // XOSHIRO256++: same seed, same sequence; jump() gives a different stream
+    {
+        rng::Xoshiro256pp a(99), b(99), c(99);
+        c.jump();
+        bool same = true, differs = false;
+        for (int k = 0; k < 1000; k++)
+        {
+            const uint64_t x = a(), y = b(), z = c();
+            same = same && (x == y);
+            differs = differs || (x != z);
+        }
+        CHECK(same);
+        CHECK(differs);
+    }
+
+    // ZIGGURAT NORMALS: first four moments of a large sample
+    {
+        rng::Xoshiro256pp engine(2024);
+        const size_t n = 2000000;
+        std::vector<double> x(n);
+        rng::fillNormal(engine, x.data(), n);
+        double m1 = 0.0, m2 = 0.0, m3 = 0.0, m4 = 0.0;
+        for (double v : x)
+        {
+            m1 += v;
+            m2 += v * v;
+            m3 += v * v * v;
+            m4 += v * v * v * v;
+        }
+        m1 /= double(n);
+        m2 /= double(n);
+        m3 /= double(n);
+        m4 /= double(n);
+        CHECK(std::abs(m1) < 0.005);
+        CHECK(std::abs(m2 - 1.0) < 0.005);
+        CHECK(std::abs(m3) < 0.01);
+        CHECK(std::abs(m4 - 3.0) < 0.03);
+
+        // the edge draws finished after each block land where the density puts them: P(|X| > 1.5) and the tail beyond R
+        size_t beyond = 0, tail = 0;
+        for (double v : x)
+        {
+            beyond += (std::abs(v) > 1.5);
+            tail += (std::abs(v) > 3.442619855899);
+        }
+        CHECK_NEAR(double(beyond) / double(n), 0.133614, 0.01);
+        CHECK(std::abs(double(tail) / double(n) / 5.7619e-4 - 1.0) < 0.15);
+
+        // single draws share the same distribution
+        double s1 = 0.0, s2 = 0.0;
+        for (size_t i = 0; i < 200000; i++)
+        {
+            const double v = rng::normal(engine);
+            s1 += v;
+            s2 += v * v;
+        }
+        CHECK(std::abs(s1 / 200000.0) < 0.01);
+        CHECK(std::abs(s2 / 200000.0 - 1.0) < 0.015);
+    }
+
+    // PARALLEL FILLS: block b is exactly what Philox(seed, b) produces on its own
+    {
+        const size_t n = 3 * rng::FILL_BLOCK + 123;
+        std::vector<double> u(n), z(n);
+        rng::parallelFillUniform(u.data(), n, -2.0, 5.0, 77);
+        rng::parallelFillNormal(z.data(), n, 1.0, 3.0, 77);
+        bool inRange = true;
+        for (double v : u)
+            inRange = inRange && (v >= -2.0 && v < 5.0);
+        CHECK(inRange);
+        for (size_t b = 0; b < 4; b++)
+        {
+            const size_t first = b * rng::FILL_BLOCK, count = std::min(rng::FILL_BLOCK, n - first);
+            std::vector<double> ru(count), rz(count);
+            rng::Philox4x32 eu(77, b), ez(77, b);
+            rng::fillUniform(eu, ru.data(), count, -2.0, 5.0);
+            rng::fillNormal(ez, rz.data(), count, 1.0, 3.0);
+            CHECK(std::equal(ru.begin(), ru.end(), u.begin() + first));
+            CHECK(std::equal(rz.begin(), rz.end(), z.begin() + first));
+        }
+    }
+
+    // PER-THREAD ENGINES: the seeding thread draws stream 0, explicit streams are jump()s of the seed
+    {
+        rng::seedThreadEngines(5);
+        rng::Xoshiro256pp stream0(5), stream3(5);
+        for (int k = 0; k < 3; k++)
+            stream3.jump();
+        CHECK(rng::threadEngine()() == stream0());
+        uint64_t drawn = 0;
+        std::thread t([&] {
+            rng::setThreadStream(3);
+            drawn = rng::threadEngine()();
+        });
+        t.join();
+        CHECK(drawn == stream3());
+    }
+
+    // SOBOL: the first points of the unshifted 2-d sequence are the van der Corput points
+    {
+        rng::SobolSequence sobol(2);
+        double p[2];
+        const double expected[4][2] = {{0.0, 0.0}, {0.5, 0.5}, {0.75, 0.25}, {0.25, 0.75}};
+        for (int k = 0; k < 4; k++)
+        {
+            sobol.next(p);
+            CHECK_NEAR(p[0], expected[k][0], 0.0);
+            CHECK_NEAR(p[1], expected[k][1], 0.0);
+        }
+        // seek() resumes the sequence at any index
+        rng::SobolSequence resumed(2);
+        resumed.seek(2);
+        resumed.next(p);
+        CHECK(p[0] == 0.75 && p[1] == 0.25);
+    }
+
+    // HALTON: radical inverses in bases 2 and 3
+    {
+        rng::HaltonSequence halton(2);
+        double p[2];
+        halton.seek(1);
+        halton.next(p);
+        CHECK_NEAR(p[0], 0.5, 1e-15);
+        CHECK_NEAR(p[1], 1.0 / 3.0, 1e-15);
+        halton.next(p);
+        CHECK_NEAR(p[0], 0.25, 1e-15);
+        CHECK_NEAR(p[1], 2.0 / 3.0, 1e-15);
+    }
+
+    return check::status();
+}
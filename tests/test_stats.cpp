@@ -0,0 +1,254 @@
+#include "../Random.h"
+#include "../Stats.h"
+#include "../Derivative.h"
+#include "Check.h"
+#include <complex>
+
+// Stats.h against direct reference computations, and merged partial results against a single pass.
+
+int main() {
+    const size_t n = 100003;
+    std::vector<double> data(n);
+    {
+        rng::Philox4x32 engine(2026);
+        std::normal_distribution<double> normal(3.0, 2.0);
+        for (double &x : data)
+            x = std::exp(0.5 * normal(engine));     // skewed, so the higher moments are not trivially zero
+    }
+
+    // REDUCTIONS: against a long double reference
+    {
+        long double total = 0.0L;
+        for (double x : data)
+            total += x;
+        const double mu = double(total / n);
+        long double squares = 0.0L;
+        for (double x : data)
+            squares += ((long double)x - mu) * ((long double)x - mu);
+        CHECK_NEAR(stats::sum(data), double(total), 1e-14);
+        CHECK_NEAR(stats::mean(data), mu, 1e-14);
+        CHECK_NEAR(stats::variance(data), double(squares / n), 1e-12);
+        CHECK(stats::min(data) == *std::min_element(data.begin(), data.end()));
+        CHECK(stats::max(data) == *std::max_element(data.begin(), data.end()));
+
+        std::vector<int> counts(1000);
+        for (size_t i = 0; i < counts.size(); i++)
+            counts[i] = int(i) - 300;
+        CHECK(stats::sum(counts) == 999 * 1000 / 2 - 300 * 1000);
+    }
+
+    // SUM OF NON-ARITHMETIC TYPES: complex and dual numbers accumulate in their own type
+    {
+        std::vector<std::complex<double>> z(5000);
+        std::complex<double> expected(0.0, 0.0);
+        for (size_t i = 0; i < z.size(); i++)
+        {
+            z[i] = std::complex<double>(std::cos(0.01 * double(i)), 1.0 / double(i + 1));
+            expected += z[i];
+        }
+        const std::complex<double> total = stats::sum(z);
+        CHECK_NEAR(total, expected, 1e-12);
+
+        typedef derivative::Dual<double, 2> D;
+        std::vector<D> d(3000);
+        for (size_t i = 0; i < d.size(); i++)
+        {
+            d[i] = D(double(i) * 0.5);
+            d[i].tangent[0] = 1.0;
+            d[i].tangent[1] = double(i % 7);
+        }
+        const D dualTotal = stats::sum(d);
+        CHECK_NEAR(dualTotal.value, 0.5 * 2999.0 * 3000.0 / 2.0, 1e-14);
+        CHECK_NEAR(dualTotal.tangent[0], 3000.0, 1e-14);
+        double sevens = 0.0;
+        for (size_t i = 0; i < d.size(); i++)
+            sevens += double(i % 7);
+        CHECK_NEAR(dualTotal.tangent[1], sevens, 1e-14);
+    }
+
+    // ACCUMULATOR: uneven shards merged equal one pass
+    {
+        stats::Accumulator whole;
+        whole.push(data.begin(), data.end());
+        stats::Accumulator merged;
+        const size_t cuts[] = {0, 1, 17, 5000, 5001, 64000, n};
+        for (size_t c = 0; c + 1 < sizeof(cuts) / sizeof(cuts[0]); c++)
+        {
+            stats::Accumulator shard;
+            shard.push(data.data() + cuts[c], cuts[c + 1] - cuts[c]);
+            merged.merge(shard);
+        }
+        stats::Accumulator empty;
+        merged.merge(empty);
+        CHECK(merged.count() == n);
+        CHECK_NEAR(merged.mean(), whole.mean(), 1e-13);
+        CHECK_NEAR(merged.variance(), whole.variance(), 1e-12);
+        CHECK_NEAR(merged.skewness(), whole.skewness(), 1e-10);
+        CHECK_NEAR(merged.kurtosis(), whole.kurtosis(), 1e-10);
+        CHECK(merged.min() == whole.min() && merged.max() == whole.max());
+        CHECK_NEAR(whole.mean(), stats::mean(data), 1e-13);
+        CHECK_NEAR(whole.stdev(), stats::stdev(data), 1e-12);
+        CHECK_NEAR(whole.sampleVariance(), whole.variance() * double(n) / double(n - 1), 1e-14);
+    }
+
+    // TDIGEST: merged shards keep the single digest's accuracy
+    {
+        std::vector<double> sorted = data;
+        std::sort(sorted.begin(), sorted.end());
+        stats::TDigest whole;
+        whole.push(data.begin(), data.end());
+        stats::TDigest merged;
+        for (size_t shard = 0; shard < 8; shard++)
+        {
+            stats::TDigest part;
+            const size_t first = shard * n / 8, last = (shard + 1) * n / 8;
+            part.push(data.data() + first, last - first);
+            merged.merge(part);
+        }
+        CHECK(merged.count() == double(n));
+        CHECK(merged.min() == sorted.front() && merged.max() == sorted.back());
+        const double qs[] = {0.001, 0.01, 0.1, 0.25, 0.5, 0.75, 0.9, 0.99, 0.999};
+        for (double q : qs)
+        {
+            // compare ranks rather than values: the error guarantee is on the quantile level
+            const double rankWhole = double(std::lower_bound(sorted.begin(), sorted.end(), whole.quantile(q)) - sorted.begin()) / double(n);
+            const double rankMerged = double(std::lower_bound(sorted.begin(), sorted.end(), merged.quantile(q)) - sorted.begin()) / double(n);
+            CHECK(std::abs(rankWhole - q) < 2e-3);
+            CHECK(std::abs(rankMerged - q) < 2e-3);
+        }
+        CHECK_NEAR(merged.cdf(sorted[n / 2]), 0.5, 2e-3);
+
+        // merging a digest into itself doubles every weight and keeps the quantiles
+        stats::TDigest doubled = whole;
+        doubled.merge(doubled);
+        CHECK(doubled.count() == 2.0 * double(n));
+        CHECK(std::abs(doubled.quantile(0.5) / whole.quantile(0.5) - 1.0) < 1e-2);
+    }
+
+    // LOG-LINEAR HISTOGRAM: quantiles within the bucket resolution, merge() exact
+    {
+        std::vector<double> sorted = data;
+        std::sort(sorted.begin(), sorted.end());
+        stats::LogLinearHistogram whole(1e-6, 1e6, 8), merged(1e-6, 1e6, 8);
+        whole.push(data.begin(), data.end());
+        for (size_t shard = 0; shard < 4; shard++)
+        {
+            stats::LogLinearHistogram part(1e-6, 1e6, 8);
+            const size_t first = shard * n / 4, last = (shard + 1) * n / 4;
+            part.push(data.data() + first, last - first);
+            merged.merge(part);
+        }
+        CHECK(whole.count() == n && merged.count() == n);
+        CHECK(whole.min() == sorted.front() && whole.max() == sorted.back());
+        for (double q : {0.01, 0.25, 0.5, 0.75, 0.99})
+        {
+            const double exact = sorted[size_t(q * double(n - 1))];
+            CHECK(std::abs(whole.quantile(q) / exact - 1.0) < 1.0 / 256.0);
+            CHECK(merged.quantile(q) == whole.quantile(q));
+        }
+
+        // negative values are rejected rather than counted below lowest
+        stats::LogLinearHistogram positive(1e-6, 1e6, 8);
+        const double mixed[] = {1.0, -2.0, 3.0, -0.5};
+        positive.push(mixed, 4);
+        positive.push(-1.0);
+        CHECK(positive.count() == 2 && positive.min() == 1.0);
+    }
+
+    // BOOTSTRAP AND JACKKNIFE: the standard error of the mean is sigma / sqrt(n)
+    {
+        std::vector<double> sample(data.begin(), data.begin() + 2000);
+        const double se = std::sqrt(stats::variance(sample) / double(sample.size()));
+        stats::BootstrapOptions options;
+        options.replicates = 2000;
+        const stats::BootstrapResult boot = stats::bootstrap(sample, stats::MeanStatistic(), options);
+        const stats::JackknifeResult jack = stats::jackknife(sample, stats::MeanStatistic());
+        CHECK_NEAR(boot.estimate, stats::mean(sample), 1e-14);
+        CHECK(std::abs(boot.standardError / se - 1.0) < 0.1);
+        CHECK(boot.percentileLower < boot.estimate && boot.estimate < boot.percentileUpper);
+        CHECK(boot.bcaLower < boot.estimate && boot.estimate < boot.bcaUpper);
+        CHECK(boot.replicates.size() == options.replicates);
+        // the delete-1 jackknife of the mean reproduces the textbook standard error exactly
+        CHECK_NEAR(jack.standardError, std::sqrt(stats::variance(sample) / double(sample.size() - 1)), 1e-10);
+        CHECK_NEAR(jack.bias, 0.0, 1e-10);
+        CHECK_NEAR(stats::normalQuantile(stats::normalCdf(1.2345)), 1.2345, 1e-9);
+        CHECK_NEAR(stats::normalCdf(1.959963984540054), 0.975, 1e-12);
+
+        // bounds above 2^32 take the 128-bit form: every index in range, half of them in the upper half
+        const size_t n = (size_t(1) << 40) + 3;
+        std::vector<size_t> index(100000);
+        rng::Xoshiro256pp engine(9);
+        stats::boundedIndices(engine, n, index.data(), index.size());
+        size_t upper = 0;
+        bool inRange = true;
+        for (size_t i : index)
+        {
+            inRange = inRange && (i < n);
+            upper += (i >= n / 2);
+        }
+        CHECK(inRange);
+        CHECK(std::abs(double(upper) / double(index.size()) - 0.5) < 0.01);
+    }
+
+    // COVARIANCE: blocked multiply and streaming accumulator against a naive double loop
+    {
+        const size_t rows = 2000, p = 7;
+        Matrix<double> X(rows, p);
+        rng::Philox4x32 engine(7);
+        std::normal_distribution<double> normal(0.0, 1.0);
+        for (size_t i = 0; i < rows; i++)
+        {
+            const double common = normal(engine);
+            for (size_t j = 0; j < p; j++)
+                X.rowData(i)[j] = 10.0 * double(j) + common * double(j % 3) + normal(engine);
+        }
+        std::vector<double> mu(p, 0.0);
+        for (size_t i = 0; i < rows; i++)
+            for (size_t j = 0; j < p; j++)
+                mu[j] += X.rowData(i)[j] / double(rows);
+        Matrix<double> naive(p, p);
+        for (size_t j = 0; j < p; j++)
+            for (size_t k = 0; k < p; k++)
+            {
+                double c = 0.0;
+                for (size_t i = 0; i < rows; i++)
+                    c += (X.rowData(i)[j] - mu[j]) * (X.rowData(i)[k] - mu[k]);
+                naive.rowData(j)[k] = c / double(rows);
+            }
+
+        const Matrix<double> C = stats::covariance(X);
+        const Matrix<double> S = stats::covariance(X, true);
+        const Matrix<double> R = stats::correlation(X);
+        stats::CovarianceAccumulator byRow(p), byBlock(p), merged(p);
+        for (size_t i = 0; i < rows; i++)
+            byRow.push(X.rowData(i));
+        byBlock.push(X.rawData(), 1234);
+        byBlock.push(X.rowData(1234), rows - 1234);
+        for (size_t shard = 0; shard < 5; shard++)
+        {
+            stats::CovarianceAccumulator part(p);
+            part.push(X.rowData(shard * 400), 400);
+            merged.merge(part);
+        }
+        const Matrix<double> Crow = byRow.covariance(), Cblock = byBlock.covariance(), Cmerged = merged.covariance();
+        for (size_t j = 0; j < p; j++)
+            for (size_t k = 0; k < p; k++)
+            {
+                CHECK_NEAR(C.rowData(j)[k], naive.rowData(j)[k], 1e-11);
+                CHECK_NEAR(S.rowData(j)[k], naive.rowData(j)[k] * double(rows) / double(rows - 1), 1e-11);
+                CHECK_NEAR(R.rowData(j)[k], naive.rowData(j)[k] / std::sqrt(naive.rowData(j)[j] * naive.rowData(k)[k]), 1e-11);
+                CHECK_NEAR(Crow.rowData(j)[k], naive.rowData(j)[k], 1e-11);
+                CHECK_NEAR(Cblock.rowData(j)[k], naive.rowData(j)[k], 1e-11);
+                CHECK_NEAR(Cmerged.rowData(j)[k], naive.rowData(j)[k], 1e-11);
+            }
+        CHECK(merged.count() == rows);
+
+        // pairwise with no missing entries is the plain covariance
+        const Matrix<double> P = stats::pairwiseCovariance(X);
+        for (size_t j = 0; j < p; j++)
+            for (size_t k = 0; k < p; k++)
+                CHECK_NEAR(P.rowData(j)[k], naive.rowData(j)[k], 1e-11);
+    }
+
+    return check::status();
+}
@@ -0,0 +1,121 @@
+#include "../Stats.h"
+#include "Check.h"
+#include <atomic>
+#include <stdexcept>
+
+// ThreadPool loops visit every index once, hand out worker indices below the size() of the pool running
+// the loop (also when nested inside a loop of another pool) and rethrow exceptions on the calling thread.
+
+int main() {
+    ThreadPool pool(4);
+    CHECK(pool.size() == 4);
+    CHECK(ThreadPool::global().size() >= 1);
+
+    // every index exactly once, every worker index in range
+    {
+        const size_t n = 100000;
+        std::vector<std::atomic<int>> visits(n);
+        std::atomic<size_t> badWorker(0);
+        pool.parallelFor(0, n, [&](size_t i, size_t worker) {
+            visits[i]++;
+            if (worker >= pool.size())
+                badWorker++;
+        }, 64);
+        size_t wrong = 0;
+        for (size_t i = 0; i < n; i++)
+            wrong += (visits[i] != 1);
+        CHECK(wrong == 0);
+        CHECK(badWorker == 0);
+
+        // chunks are disjoint, cover the range and respect the grain except for the last one
+        std::vector<std::atomic<int>> covered(n);
+        std::atomic<size_t> shortChunks(0);
+        pool.parallelRange(5, n, [&](size_t lo, size_t hi, size_t) {
+            for (size_t i = lo; i < hi; i++)
+                covered[i]++;
+            if (hi - lo < 1000 && hi != n)
+                shortChunks++;
+        }, 1000);
+        wrong = 0;
+        for (size_t i = 0; i < n; i++)
+            wrong += (covered[i] != ((i >= 5) ? 1 : 0));
+        CHECK(wrong == 0);
+        CHECK(shortChunks == 0);
+
+        // empty ranges never call the body
+        bool called = false;
+        pool.parallelFor(7, 7, [&](size_t, size_t) { called = true; });
+        CHECK(!called);
+    }
+
+    // an exception thrown by a loop body reaches the caller, and the pool stays usable
+    {
+        CHECK_THROWS(pool.parallelFor(0, 1000, [](size_t i, size_t) {
+            if (i == 617)
+                throw std::runtime_error("body failed");
+        }), std::runtime_error);
+        std::atomic<size_t> total(0);
+        pool.parallelFor(0, 1000, [&](size_t i, size_t) { total += i; });
+        CHECK(total == 999 * 1000 / 2);
+    }
+
+    // the global pool is recognised, and globalSize() is its size
+    {
+        const size_t size = ThreadPool::globalSize();
+        CHECK(!pool.isGlobal());
+        CHECK(ThreadPool::global().isGlobal());
+        CHECK(ThreadPool::global().size() == size);
+    }
+
+    // NESTED POOLS: indices stay below the size() of the pool running the loop, also inside a larger pool
+    {
+        const size_t hw = std::max<size_t>(1, std::thread::hardware_concurrency());
+        ThreadPool big(4 * hw);
+        ThreadPool &global = ThreadPool::global();
+
+        // every index seen by a pool's loop body lies in [0, size())
+        std::vector<size_t> ownBad(big.size(), 0), nestedBad(big.size(), 0), sameBad(big.size(), 0);
+        big.parallelFor(0, 256, [&](size_t, size_t worker) {
+            if (worker >= big.size())
+                ownBad[0]++;
+            global.parallelFor(0, 64, [&](size_t, size_t inner) {
+                if (inner >= global.size())
+                    nestedBad[worker]++;
+            });
+            // nested loops on the same pool keep running as the current worker
+            big.parallelFor(0, 8, [&](size_t, size_t inner) {
+                if (inner != worker)
+                    sameBad[worker]++;
+            });
+        });
+        size_t own = 0, nested = 0, same = 0;
+        for (size_t w = 0; w < big.size(); w++)
+        {
+            own += ownBad[w];
+            nested += nestedBad[w];
+            same += sameBad[w];
+        }
+        CHECK(own == 0);
+        CHECK(nested == 0);
+        CHECK(same == 0);
+
+        // a library call on the global pool made from inside a larger user pool (indexes per-worker scratch)
+        std::vector<double> data(500);
+        rng::Xoshiro256pp engine(7);
+        rng::fillNormal(engine, data.data(), data.size());
+        stats::BootstrapOptions options;
+        options.replicates = 200;
+        options.jackknifeGroups = 50;
+        const stats::BootstrapResult reference = stats::bootstrap(data, stats::MeanStatistic(), options);
+
+        std::vector<double> errors(big.size(), 0.0);
+        big.parallelFor(0, 2 * big.size(), [&](size_t, size_t worker) {
+            const stats::BootstrapResult nestedResult = stats::bootstrap(data, stats::MeanStatistic(), options);
+            errors[worker] = std::max(errors[worker], std::abs(nestedResult.standardError - reference.standardError));
+        });
+        for (size_t w = 0; w < big.size(); w++)
+            CHECK(errors[w] == 0.0);
+    }
+
+    return check::status();
+}